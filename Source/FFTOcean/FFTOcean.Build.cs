@@ -46,6 +46,7 @@ public class FFTOcean : ModuleRules
                 "SlateCore",
                 "UnrealEd",
                 "Projects",
+                "AssetRegistry",
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
@@ -2,19 +2,39 @@
 
 #include "FFTOcean.h"
 #include "Interfaces/IPluginManager.h"
+#include "FFTOceanRenderer.h"
+#include "OceanRenderBatch.h"
+#include "Engine/World.h"
 
 #define LOCTEXT_NAMESPACE "FFFTOceanModule"
 
+DEFINE_LOG_CATEGORY(LogFFTOcean);
+
 void FFFTOceanModule::StartupModule()
 {
 	FString PluginShaderDir = FPaths::Combine(IPluginManager::Get().FindPlugin(TEXT("FFTOcean"))->GetBaseDir(), TEXT("Shaders"));
 	AddShaderSourceDirectoryMapping(TEXT("/Plugin/FFTOcean"), PluginShaderDir);
+
+	// Every ocean has queued its packet once the actors have ticked, and the views haven't been rendered yet
+	WorldPostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddLambda([](UWorld* World, ELevelTick TickType, float DeltaSeconds)
+	{
+		FFFTOceanRenderer::FlushBatchedOceans();
+	});
 }
 
 void FFFTOceanModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+	FWorldDelegates::OnWorldPostActorTick.Remove(WorldPostActorTickHandle);
+
+	ENQUEUE_RENDER_COMMAND(ReleaseOceanRenderBatchCommand)
+	(
+		[](FRHICommandListImmediate& RHICmdList)
+		{
+			FOceanRenderBatch::Get().Release();
+		}
+	);
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -1,126 +1,450 @@
 // Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
 
 #include "FFTOceanRenderer.h"
+#include "FFTOcean.h"
+#include "OceanRenderProxy.h"
+#include "OceanRenderBatch.h"
+#include "OceanSparseWaves.h"
+#include "Engine/Texture2DArray.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+#include "Async/Async.h"
+
+struct FOceanGerstnerWaveSet
+{
+	FOceanGerstnerWaveSetKey Key;
+	TArray<FOceanSparseWave> Waves;
+};
+
+static TAutoConsoleVariable<int32> CVarFFTOceanBatching(
+	TEXT("r.FFTOcean.Batching"),
+	0,
+	TEXT("0: every ocean runs its own transforms\n")
+	TEXT("1: oceans of the same size are transformed together once the world has ticked, in texture array slices"),
+	ECVF_Default);
+
+namespace
+{
+	bool IsSameSeaState(const FOceanSeaState& A, const FOceanSeaState& B)
+	{
+		return A.WaveAmplitude == B.WaveAmplitude && A.WindSpeed == B.WindSpeed;
+	}
+
+	int32 GetGerstnerWaveCount(const FOceanRenderConfig& Config)
+	{
+		return FMath::Clamp(Config.GerstnerWaveCount, 1, OCEAN_MAX_GERSTNER_WAVE_COUNT);
+	}
+
+	FOceanGerstnerWaveSetKey GetGerstnerWaveSetKey(const FOceanSeaState& SeaState, const FOceanRenderConfig& Config)
+	{
+		FOceanGerstnerWaveSetKey Key;
+		Key.SeaState = SeaState;
+		Key.Size = Config.RenderTextureWidth;
+		Key.LoopPeriod = Config.LoopPeriod;
+		Key.WaveCount = GetGerstnerWaveCount(Config);
+
+		return Key;
+	}
+
+	bool IsSameGerstnerWaveSetKey(const FOceanGerstnerWaveSetKey& A, const FOceanGerstnerWaveSetKey& B)
+	{
+		return IsSameSeaState(A.SeaState, B.SeaState) && A.Size == B.Size && A.LoopPeriod == B.LoopPeriod && A.WaveCount == B.WaveCount;
+	}
+
+	bool IsGerstnerWaveSetOf(const FOceanGerstnerWaveSetPtr& WaveSet, const FOceanGerstnerWaveSetKey& Key)
+	{
+		return WaveSet && IsSameGerstnerWaveSetKey(WaveSet->Key, Key);
+	}
+
+	// Scores and sorts every texel of the spectrum, thread pool only
+	FOceanGerstnerWaveSetPtr MakeGerstnerWaveSet(const FOceanGerstnerWaveSetKey& Key)
+	{
+		TSharedRef<FOceanGerstnerWaveSet, ESPMode::ThreadSafe> WaveSet = MakeShared<FOceanGerstnerWaveSet, ESPMode::ThreadSafe>();
+		WaveSet->Key = Key;
+
+		// Same spectrum as the transform of this size, so switching modes keeps the dominant waves in place
+		FOceanCpuSimulationConfig SimulationConfig;
+		SimulationConfig.Size = Key.Size;
+		SimulationConfig.WaveAmplitude = Key.SeaState.WaveAmplitude;
+		SimulationConfig.WindSpeed = Key.SeaState.WindSpeed;
+		SimulationConfig.LoopPeriod = Key.LoopPeriod;
+
+		WaveSet->Waves = FOceanSparseWaveEvaluator(SimulationConfig, Key.WaveCount).GetWaves();
+
+		return WaveSet;
+	}
+
+	// Two registers per wave: wave vector and height weights, then the X and Y weights
+	void AddGerstnerWaves(TArray<FVector4>& OutWaves, const TArray<FOceanSparseWave>& Waves, float Time, float Weight)
+	{
+		for (const FOceanSparseWave& Wave : Waves)
+		{
+			FVector Cos, Sin;
+			FFTOcean::GetSparseWaveWeights(Wave, Time, Cos, Sin);
+
+			Cos *= Weight;
+			Sin *= Weight;
+
+			OutWaves.Emplace(Wave.WaveVector.X, Wave.WaveVector.Y, Cos.Z, Sin.Z);
+			OutWaves.Emplace(Cos.X, Sin.X, Cos.Y, Sin.Y);
+		}
+	}
+}
 
 FFFTOceanRenderer::FFFTOceanRenderer() :
-	PhillipsFourierPass(new FPhillipsFourierPass()),
-	FourierComponentPass(new FFourierComponentPass()),
-	TwiddleFactorsPass(new FTwiddleFactorsPass()),
-	InverseTransformPass(new FInverseTransformPass()),
-	SurfaceDisplacementPass(new FSurfaceDisplacementPass()),
-	SurfaceNormalPass(new FSurfaceNormalPass())
+	RenderProxy(new FOceanRenderProxy()),
+	SnapshotPublisher(MakeShared<FOceanSnapshotPublisher, ESPMode::ThreadSafe>()),
+	bHasSeaState(false),
+	SeaStateTransitionStartTime(0),
+	SeaStateBlend(1),
+	OldestPendingDisturbance(0),
+	bWarnedDroppedDisturbances(false)
 {
+	FMemory::Memzero(OutgoingSeaState);
+	FMemory::Memzero(IncomingSeaState);
 }
 
 FFFTOceanRenderer::~FFFTOceanRenderer()
 {
+	// Drop the last reference behind every command that may still use the proxy
+	ENQUEUE_RENDER_COMMAND(ReleaseOceanRenderProxyCommand)
+	(
+		[Proxy = MoveTemp(RenderProxy)](FRHICommandListImmediate& RHICmdList) mutable
+		{
+			Proxy.Reset();
+		}
+	);
+}
+
+void FFFTOceanRenderer::Render(float Timestamp, const FOceanRenderConfig& Config, const FOceanDebugConfig& DebugConfig, bool bFarField)
+{
+	const FVector2D KWindDefaultDirection(1, 0);
+
+	FOceanSeaState TargetSeaState;
+	TargetSeaState.WaveAmplitude = Config.WaveAmplitude;
+	TargetSeaState.WindSpeed = KWindDefaultDirection.GetRotated(Config.WindDirection) * Config.WindVelocity;
+
+	UpdateSeaStateTransition(Timestamp, TargetSeaState, Config.SeaStateTransitionTime);
+
+	FOceanRenderPacket Packet;
+	InitPacket(Packet, Timestamp, Config);
+
+	if (Config.bReadbackSurface)
+	{
+		Packet.SnapshotPublisher = SnapshotPublisher;
+	}
+
+	// Flipbooks are cheaper still, so they win over the waves
+	const bool bFlipbookPlayback = Config.DisplacementFlipbook && Config.NormalFlipbook;
+
+	if ((Config.bGerstnerWaves || bFarField) && !bFlipbookPlayback)
+	{
+		const bool bTransition = SeaStateBlend < 1 && !IsSameSeaState(OutgoingSeaState, IncomingSeaState);
+
+		UpdateGerstnerWaves(Config, bTransition);
+
+		if (bTransition)
+		{
+			AddGerstnerWaves(Packet.GerstnerWaves, OutgoingGerstnerWaves->Waves, Packet.Timestamp, 1 - SeaStateBlend);
+			AddGerstnerWaves(Packet.GerstnerWaves, IncomingGerstnerWaves->Waves, Packet.Timestamp, SeaStateBlend);
+		}
+		else
+		{
+			AddGerstnerWaves(Packet.GerstnerWaves, IncomingGerstnerWaves->Waves, Packet.Timestamp, 1);
+		}
+	}
+
+	TArray<FOceanDisturbance> Disturbances;
+	int32 OldestDisturbance;
+	{
+		FScopeLock Lock(&PendingDisturbanceLock);
+		Disturbances = MoveTemp(PendingDisturbances);
+		OldestDisturbance = OldestPendingDisturbance;
+		OldestPendingDisturbance = 0;
+	}
+
+	// Only the transform passes splat disturbances, the far field switches back on its own so it is not worth a warning
+	if (Config.bGerstnerWaves || bFlipbookPlayback)
+	{
+		if (Disturbances.Num() > 0 && !bWarnedDroppedDisturbances)
+		{
+			UE_LOG(LogFFTOcean, Warning, TEXT("Ocean disturbances are dropped, Gerstner wave and flipbook oceans don't render them"));
+			bWarnedDroppedDisturbances = true;
+		}
+	}
+	else if (!bFarField)
+	{
+		// Laid out as one array per field, so the render thread uploads each of them with a single copy
+		Packet.DisturbanceSegments.Reserve(Disturbances.Num());
+		Packet.DisturbanceShapes.Reserve(Disturbances.Num());
+
+		for (int32 Index = 0; Index < Disturbances.Num(); ++Index)
+		{
+			const FOceanDisturbance& Disturbance = Disturbances[(OldestDisturbance + Index) % Disturbances.Num()];
+
+			Packet.DisturbanceSegments.Emplace(Disturbance.Start.X, Disturbance.Start.Y, Disturbance.End.X, Disturbance.End.Y);
+			Packet.DisturbanceShapes.Emplace(Disturbance.Radius, Disturbance.Amplitude, Disturbance.StartAmplitudeScale, 0);
+		}
+	}
+
+	Packet.DisplacementMap = FFTOcean::GetTextureReferenceFromTexture(Config.DisplacementMap);
+	Packet.NormalMap = FFTOcean::GetTextureReferenceFromTexture(Config.NormalMap);
+
+	Packet.DisplacementFlipbook = FFTOcean::GetTextureReferenceFromTexture(Config.DisplacementFlipbook);
+	Packet.NormalFlipbook = FFTOcean::GetTextureReferenceFromTexture(Config.NormalFlipbook);
 
+	Packet.PhillipsFourierPassDebugTexture = FFTOcean::GetTextureReferenceFromTexture(DebugConfig.PhillipsFourierPassDebugTexture);
+	Packet.SurfaceDebugTextureX = FFTOcean::GetTextureReferenceFromTexture(DebugConfig.SurfaceDebugTextureX);
+	Packet.SurfaceDebugTextureY = FFTOcean::GetTextureReferenceFromTexture(DebugConfig.SurfaceDebugTextureY);
+	Packet.SurfaceDebugTextureZ = FFTOcean::GetTextureReferenceFromTexture(DebugConfig.SurfaceDebugTextureZ);
+	Packet.TwiddleFactorsDebugTexture = FFTOcean::GetTextureReferenceFromTexture(DebugConfig.TwiddleFactorsDebugTexture);
+	Packet.TransformDebugTextureX = FFTOcean::GetTextureReferenceFromTexture(DebugConfig.TransformDebugTextureX);
+	Packet.TransformDebugTextureY = FFTOcean::GetTextureReferenceFromTexture(DebugConfig.TransformDebugTextureY);
+	Packet.TransformDebugTextureZ = FFTOcean::GetTextureReferenceFromTexture(DebugConfig.TransformDebugTextureZ);
+
+	if (CVarFFTOceanBatching.GetValueOnAnyThread() != 0)
+	{
+		ENQUEUE_RENDER_COMMAND(OceanBatchCommand)
+		(
+			[Proxy = RenderProxy, Packet](FRHICommandListImmediate& RHICmdList)
+			{
+				FOceanRenderBatch::Get().Add(RHICmdList, Proxy, Packet);
+			}
+		);
+	}
+	else
+	{
+		ENQUEUE_RENDER_COMMAND(OceanRenderCommand)
+		(
+			[Proxy = RenderProxy, Packet](FRHICommandListImmediate& RHICmdList)
+			{
+				Proxy->Render(RHICmdList, Packet);
+			}
+		);
+	}
 }
 
-void FFFTOceanRenderer::Render(float Timestamp, const FOceanRenderConfig& Config, const FOceanDebugConfig& DebugConfig)
+void FFFTOceanRenderer::WarmUp(const FOceanRenderConfig& Config, bool bFarField)
 {
-	auto RenderPhillipsFourierPass = [&Config, &DebugConfig, this]()
+	const bool bFlipbookPlayback = Config.DisplacementFlipbook && Config.NormalFlipbook;
+
+	if (bFlipbookPlayback)
 	{
-		FPhillipsFourierPassConfig PassConfig;
-		PassConfig.TextureWidth = Config.RenderTextureWidth;
-		PassConfig.TextureHeight = Config.RenderTextureHeight;
+		return;
+	}
 
+	// The first Render takes over this sea state as is, there is nothing to blend from yet
+	if (!bHasSeaState)
+	{
 		const FVector2D KWindDefaultDirection(1, 0);
 
-		FPhillipsFourierPassParam Param;
-		Param.WaveAmplitude = Config.WaveAmplitude;
-		Param.WindSpeed = KWindDefaultDirection.GetRotated(Config.WindDirection) * Config.WindVelocity;
+		FOceanSeaState TargetSeaState;
+		TargetSeaState.WaveAmplitude = Config.WaveAmplitude;
+		TargetSeaState.WindSpeed = KWindDefaultDirection.GetRotated(Config.WindDirection) * Config.WindVelocity;
+
+		UpdateSeaStateTransition(0, TargetSeaState, Config.SeaStateTransitionTime);
+	}
 
-		FRHITexture* DebugTextureRef = FFTOcean::GetRHITextureFromRenderTarget(DebugConfig.PhillipsFourierPassDebugTexture);
+	// The Gerstner waves are picked from the spectrum on the CPU, the GPU has nothing to build for them. The build
+	// only starts here, the first Render picks it up.
+	if (Config.bGerstnerWaves || bFarField)
+	{
+		const FOceanGerstnerWaveSetKey Key = GetGerstnerWaveSetKey(IncomingSeaState, Config);
 
-		PhillipsFourierPass->Render(PassConfig, Param, DebugTextureRef);
-	};
+		if (!IsGerstnerWaveSetOf(IncomingGerstnerWaves, Key))
+		{
+			if (FOceanGerstnerWaveSetPtr WaveSet = RequestGerstnerWaveSet(Key, false))
+			{
+				IncomingGerstnerWaves = WaveSet;
+			}
+		}
+
+		return;
+	}
+
+	FOceanRenderPacket Packet;
+	InitPacket(Packet, 0, Config);
+
+	ENQUEUE_RENDER_COMMAND(OceanWarmUpCommand)
+	(
+		[Proxy = RenderProxy, Packet](FRHICommandListImmediate& RHICmdList)
+		{
+			Proxy->WarmUp(RHICmdList, Packet);
+		}
+	);
+}
 
-	auto RenderFourierComponentPass = [Timestamp, &Config, &DebugConfig, this]()
+void FFFTOceanRenderer::FlushBatchedOceans()
+{
+	ENQUEUE_RENDER_COMMAND(FlushOceanBatchCommand)
+	(
+		[](FRHICommandListImmediate& RHICmdList)
+		{
+			FOceanRenderBatch::Get().Flush(RHICmdList);
+
+			FOceanRenderProxy::ReleaseAllRetiredChains();
+		}
+	);
+}
+
+void FFFTOceanRenderer::AddDisturbance(const FOceanDisturbance& Disturbance)
+{
+	// Zero sized or flat disturbances would only cost binning
+	if (Disturbance.Radius > 0 && Disturbance.Amplitude != 0)
 	{
-		FFourierComponentPassConfig PassConfig;
-		PassConfig.TextureWidth = Config.RenderTextureWidth;
-		PassConfig.TextureHeight = Config.RenderTextureHeight;
+		FScopeLock Lock(&PendingDisturbanceLock);
+
+		// Once full, the newest disturbance takes the place of the oldest
+		if (PendingDisturbances.Num() < OCEAN_MAX_DISTURBANCE_COUNT)
+		{
+			PendingDisturbances.Add(Disturbance);
+		}
+		else
+		{
+			PendingDisturbances[OldestPendingDisturbance] = Disturbance;
+			OldestPendingDisturbance = (OldestPendingDisturbance + 1) % OCEAN_MAX_DISTURBANCE_COUNT;
+		}
+	}
+}
+
+FOceanSnapshotRef FFFTOceanRenderer::GetSurfaceSnapshot() const
+{
+	return SnapshotPublisher->Acquire();
+}
+
+void FFFTOceanRenderer::InitPacket(FOceanRenderPacket& Packet, float Timestamp, const FOceanRenderConfig& Config) const
+{
+	// Looping surfaces are periodic, wrapping keeps the phase precise however long the ocean runs
+	Packet.Timestamp = Config.LoopPeriod > 0 ? FMath::Fmod(Timestamp, Config.LoopPeriod) : Timestamp;
+	Packet.TextureWidth = Config.RenderTextureWidth;
+	Packet.TextureHeight = Config.RenderTextureHeight;
+	Packet.OutgoingSeaState = OutgoingSeaState;
+	Packet.IncomingSeaState = IncomingSeaState;
+	Packet.SeaStateBlend = SeaStateBlend;
+	Packet.NormalStrength = Config.NormalStrength;
+	Packet.bAnalyticNormals = Config.bAnalyticNormals;
+	Packet.LoopPeriod = Config.LoopPeriod;
+}
 
-		FFourierComponentPassParam Param;
-		Param.Time = Timestamp;
-		Param.PhillipsFourierTextureSRV = PhillipsFourierPass->GetPhillipsFourierTextureSRV();
+void FFFTOceanRenderer::UpdateSeaStateTransition(float Timestamp, const FOceanSeaState& TargetSeaState, float TransitionTime)
+{
+	if (!bHasSeaState)
+	{
+		bHasSeaState = true;
+		OutgoingSeaState = TargetSeaState;
+		IncomingSeaState = TargetSeaState;
+		SeaStateTransitionStartTime = Timestamp;
+		SeaStateBlend = 1;
+		return;
+	}
 
-		FRHITexture* DebugTextureXRef = FFTOcean::GetRHITextureFromRenderTarget(DebugConfig.SurfaceDebugTextureX);
-		FRHITexture* DebugTextureYRef = FFTOcean::GetRHITextureFromRenderTarget(DebugConfig.SurfaceDebugTextureY);
-		FRHITexture* DebugTextureZRef = FFTOcean::GetRHITextureFromRenderTarget(DebugConfig.SurfaceDebugTextureZ);
+	// Timestamps run backwards when the simulation restarts, the transition restarts with them
+	SeaStateTransitionStartTime = FMath::Min(SeaStateTransitionStartTime, Timestamp);
 
-		FourierComponentPass->Render(PassConfig, Param, DebugTextureXRef, DebugTextureYRef, DebugTextureZRef);
-	};
+	float Alpha = TransitionTime > 0 ? (Timestamp - SeaStateTransitionStartTime) / TransitionTime : 1;
 
-	auto RenderTwiddleFactorsPass = [&Config, &DebugConfig, this]()
+	if (Alpha >= 1)
 	{
-		FTwiddleFactorsPassConfig PassConfig;
-		PassConfig.TextureWidth = Config.RenderTextureWidth;
-		PassConfig.TextureHeight = Config.RenderTextureHeight;
+		OutgoingSeaState = IncomingSeaState;
+		Alpha = 1;
 
-		FTwiddleFactorsPassParam Param;
+		// A change during a transition waits for it to finish, restarting from a half blended surface would pop
+		if (!IsSameSeaState(IncomingSeaState, TargetSeaState))
+		{
+			IncomingSeaState = TargetSeaState;
+			SeaStateTransitionStartTime = Timestamp;
+			Alpha = TransitionTime > 0 ? 0 : 1;
+		}
+	}
 
-		FRHITexture* DebugTextureRef = FFTOcean::GetRHITextureFromRenderTarget(DebugConfig.TwiddleFactorsDebugTexture);
+	SeaStateBlend = FMath::SmoothStep(0.0f, 1.0f, Alpha);
+}
 
-		TwiddleFactorsPass->Render(PassConfig, Param, DebugTextureRef);
-	};
+void FFFTOceanRenderer::UpdateGerstnerWaves(const FOceanRenderConfig& Config, bool bTransition)
+{
+	const FOceanGerstnerWaveSetKey IncomingKey = GetGerstnerWaveSetKey(IncomingSeaState, Config);
+	const FOceanGerstnerWaveSetKey OutgoingKey = GetGerstnerWaveSetKey(OutgoingSeaState, Config);
 
-	auto RenderInverseTransformPass = [&Config, &DebugConfig, this](UTextureRenderTarget2D* XDebugTexture, UTextureRenderTarget2D* YDebugTexture, UTextureRenderTarget2D* ZDebugTexture)
+	// Builds for sea states that were left before they finished aren't needed anymore
+	GerstnerWaveBuilds.RemoveAll([&IncomingKey, &OutgoingKey](const FGerstnerWaveBuild& Build)
 	{
-		FInverseTransformPassConfig PassConfig;
-		PassConfig.TextureWidth = Config.RenderTextureWidth;
-		PassConfig.TextureHeight = Config.RenderTextureHeight;
+		return !IsSameGerstnerWaveSetKey(Build.Key, IncomingKey) && !IsSameGerstnerWaveSetKey(Build.Key, OutgoingKey);
+	});
 
-		FInverseTransformPassParam Param;
-		for (int32 Index = 0; Index < 3; ++Index)
+	if (!IsGerstnerWaveSetOf(IncomingGerstnerWaves, IncomingKey))
+	{
+		// The incoming waves of a finished transition are the outgoing waves of the next one
+		if (IsGerstnerWaveSetOf(IncomingGerstnerWaves, OutgoingKey))
 		{
-			Param.FourierComponentTextures[Index] = FourierComponentPass->GetSurfaceTexture(Index);
-			Param.FourierComponentTextureSRVs[Index] = FourierComponentPass->GetSurfaceTextureSRV(Index);
-			Param.FourierComponentTextureUAVs[Index] = FourierComponentPass->GetSurfaceTextureUAV(Index);
+			OutgoingGerstnerWaves = IncomingGerstnerWaves;
 		}
-		Param.TwiddleFactorsTextureSRV = TwiddleFactorsPass->GetTwiddleFactorsTextureSRV();
 
-		FRHITexture* XDebugTextureRef = FFTOcean::GetRHITextureFromRenderTarget(XDebugTexture);
-		FRHITexture* YDebugTextureRef = FFTOcean::GetRHITextureFromRenderTarget(YDebugTexture);
-		FRHITexture* ZDebugTextureRef = FFTOcean::GetRHITextureFromRenderTarget(ZDebugTexture);
+		if (FOceanGerstnerWaveSetPtr WaveSet = RequestGerstnerWaveSet(IncomingKey, !IncomingGerstnerWaves))
+		{
+			IncomingGerstnerWaves = WaveSet;
+		}
+	}
 
-		InverseTransformPass->Render(PassConfig, Param, XDebugTextureRef, YDebugTextureRef, ZDebugTextureRef);
-	};
+	if (bTransition && !IsGerstnerWaveSetOf(OutgoingGerstnerWaves, OutgoingKey))
+	{
+		if (FOceanGerstnerWaveSetPtr WaveSet = RequestGerstnerWaveSet(OutgoingKey, !OutgoingGerstnerWaves))
+		{
+			OutgoingGerstnerWaves = WaveSet;
+		}
+	}
+}
 
-	auto RenderSurfaceDisplacementPass = [&Config, &DebugConfig, this](UTextureRenderTarget2D* DebugTexture)
+FOceanGerstnerWaveSetPtr FFFTOceanRenderer::RequestGerstnerWaveSet(const FOceanGerstnerWaveSetKey& Key, bool bWait)
+{
+	int32 BuildIndex = GerstnerWaveBuilds.IndexOfByPredicate([&Key](const FGerstnerWaveBuild& Build)
 	{
-		FSurfaceDisplacementPassConfig PassConfig;
-		PassConfig.TextureWidth = Config.RenderTextureWidth;
-		PassConfig.TextureHeight = Config.RenderTextureHeight;
+		return IsSameGerstnerWaveSetKey(Build.Key, Key);
+	});
 
-		FSurfaceDisplacementPassParam Param;
-		InverseTransformPass->GetInverseTransformTextureSRVs(Param.InverseTransformTextureSRVs);
+	if (BuildIndex == INDEX_NONE)
+	{
+		FGerstnerWaveBuild Build;
+		Build.Key = Key;
+		Build.Result = Async(EAsyncExecution::ThreadPool, [Key]()
+		{
+			return MakeGerstnerWaveSet(Key);
+		});
 
-		FRHITexture* DebugTextureRef = FFTOcean::GetRHITextureFromRenderTarget(DebugTexture);
+		BuildIndex = GerstnerWaveBuilds.Add(MoveTemp(Build));
+	}
 
-		SurfaceDisplacementPass->Render(PassConfig, Param, DebugTextureRef);
-	};
+	TFuture<FOceanGerstnerWaveSetPtr>& Result = GerstnerWaveBuilds[BuildIndex].Result;
 
-	auto RenderSurfaceNormalPass = [&Config, &DebugConfig, this](UTextureRenderTarget2D* DebugTexture)
+	if (!bWait && !Result.IsReady())
 	{
-		FSurfaceNormalPassConfig PassConfig;
-		PassConfig.TextureWidth = Config.RenderTextureWidth;
-		PassConfig.TextureHeight = Config.RenderTextureHeight;
+		return nullptr;
+	}
 
-		FSurfaceNormalPassParam Param;
-		Param.DisplacementTextureSRV = SurfaceDisplacementPass->GetSurfaceDisplacementTextureSRV();
-		Param.NormalStrength = Config.NormalStrength;
+	const FOceanGerstnerWaveSetPtr WaveSet = Result.Get();
+	GerstnerWaveBuilds.RemoveAt(BuildIndex);
 
-		FRHITexture* DebugTextureRef = FFTOcean::GetRHITextureFromRenderTarget(DebugTexture);
+	return WaveSet;
+}
 
-		SurfaceNormalPass->Render(PassConfig, Param, DebugTextureRef);
-	};
+float FFFTOceanRenderer::GetGpuTime() const
+{
+	return RenderProxy->GetGpuTime();
+}
 
-	RenderPhillipsFourierPass();
-	RenderFourierComponentPass();
-	RenderTwiddleFactorsPass();
-	RenderInverseTransformPass(DebugConfig.TransformDebugTextureX, DebugConfig.TransformDebugTextureY, DebugConfig.TransformDebugTextureZ);
-	RenderSurfaceDisplacementPass(Config.DisplacementMap);
-	RenderSurfaceNormalPass(Config.NormalMap);
+FIntPoint FFFTOceanRenderer::GetActiveTextureSize() const
+{
+	return RenderProxy->GetActiveTextureSize();
 }
+
+FOceanWaveStatistics FFFTOceanRenderer::GetWaveStatistics() const
+{
+	const FWaveStatisticsPassResult Result = RenderProxy->GetWaveStatistics();
+
+	FOceanWaveStatistics Statistics;
+	Statistics.bValid = Result.bValid;
+	Statistics.MaxDisplacement = Result.MaxDisplacement;
+	Statistics.MeanHeight = Result.MeanHeight;
+	Statistics.SignificantWaveHeight = Result.SignificantWaveHeight;
+
+	return Statistics;
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "OceanBakeCommandlet.h"
+#include "FFTOcean.h"
+#include "OceanBakeFormat.h"
+#include "OceanCpuSimulation.h"
+#include "Misc/Paths.h"
+
+UOceanBakeCommandlet::UOceanBakeCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UOceanBakeCommandlet::Main(const FString& Params)
+{
+	FString Output;
+	if (!FParse::Value(*Params, TEXT("Output="), Output))
+	{
+		UE_LOG(LogFFTOcean, Error, TEXT("OceanBake needs -Output=<File>"));
+		return 1;
+	}
+
+	FOceanRenderConfig RenderConfig;
+	RenderConfig.RenderTextureWidth = 256;
+	RenderConfig.NormalStrength = 1;
+
+	if (!FParse::Value(*Params, TEXT("WaveAmplitude="), RenderConfig.WaveAmplitude) || !FParse::Value(*Params, TEXT("WindVelocity="), RenderConfig.WindVelocity))
+	{
+		UE_LOG(LogFFTOcean, Error, TEXT("OceanBake needs -WaveAmplitude=<Amplitude> and -WindVelocity=<Velocity>"));
+		return 1;
+	}
+
+	FParse::Value(*Params, TEXT("Size="), RenderConfig.RenderTextureWidth);
+	FParse::Value(*Params, TEXT("WindDirection="), RenderConfig.WindDirection);
+	FParse::Value(*Params, TEXT("NormalStrength="), RenderConfig.NormalStrength);
+	FParse::Value(*Params, TEXT("LoopPeriod="), RenderConfig.LoopPeriod);
+	RenderConfig.bAnalyticNormals = FParse::Param(*Params, TEXT("AnalyticNormals"));
+
+	if (!FMath::IsPowerOfTwo(RenderConfig.RenderTextureWidth) || RenderConfig.RenderTextureWidth < 64 || RenderConfig.RenderTextureWidth > 1024)
+	{
+		UE_LOG(LogFFTOcean, Error, TEXT("OceanBake -Size must be a power of two between 64 and 1024"));
+		return 1;
+	}
+
+	int32 FrameCount = 300;
+	float FrameRate = 30;
+	float StartTime = 0;
+	FParse::Value(*Params, TEXT("Frames="), FrameCount);
+	FParse::Value(*Params, TEXT("FrameRate="), FrameRate);
+	FParse::Value(*Params, TEXT("StartTime="), StartTime);
+
+	if (FrameCount <= 0 || FrameRate <= 0)
+	{
+		UE_LOG(LogFFTOcean, Error, TEXT("OceanBake -Frames and -FrameRate must be positive"));
+		return 1;
+	}
+
+	FOceanBakeHeader Header;
+	Header.Width = RenderConfig.RenderTextureWidth;
+	Header.Height = RenderConfig.RenderTextureWidth;
+	Header.FrameCount = FrameCount;
+	Header.StartTime = StartTime;
+	Header.TimeStep = 1 / FrameRate;
+	Header.LoopPeriod = RenderConfig.LoopPeriod;
+	Header.Encoding = StaticCast<uint8>(FParse::Param(*Params, TEXT("Quantize")) ? EOceanBakeEncoding::Quantized : EOceanBakeEncoding::Half);
+	Header.bCompressed = FParse::Param(*Params, TEXT("Compress")) ? 1 : 0;
+
+	FOceanBakeWriter Writer;
+	if (!Writer.Open(FPaths::ConvertRelativePathToFull(Output), Header))
+	{
+		return 1;
+	}
+
+	FOceanCpuSimulation Simulation(FOceanCpuSimulationConfig::FromRenderConfig(RenderConfig));
+
+	for (int32 Frame = 0; Frame < FrameCount; ++Frame)
+	{
+		// Every frame is sampled from the start time, so the timestep doesn't accumulate rounding errors
+		Simulation.Simulate(StartTime + Frame * Header.TimeStep);
+
+		if (!Writer.WriteFrame(Simulation.GetDisplacementMap(), Simulation.GetNormalMap()))
+		{
+			UE_LOG(LogFFTOcean, Error, TEXT("Failed to write ocean frame %d to %s"), Frame, *Output);
+			return 1;
+		}
+
+		UE_LOG(LogFFTOcean, Display, TEXT("Baked ocean frame %d/%d"), Frame + 1, FrameCount);
+	}
+
+	if (!Writer.Close())
+	{
+		return 1;
+	}
+
+	UE_LOG(LogFFTOcean, Display, TEXT("Baked %d ocean frames to %s"), FrameCount, *Output);
+	return 0;
+}
\ No newline at end of file
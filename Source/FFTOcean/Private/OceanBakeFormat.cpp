@@ -0,0 +1,384 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "OceanBakeFormat.h"
+#include "FFTOcean.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/Compression.h"
+#include "Serialization/MemoryReader.h"
+
+namespace
+{
+	// Serialized sizes, the structs themselves are padded
+	constexpr int64 HeaderSize = 5 * sizeof(uint32) + 3 * sizeof(float) + 2 * sizeof(uint8);
+	constexpr int64 ChunkEntrySize = sizeof(uint64) + 2 * sizeof(uint32);
+
+	// Quantized chunks start with the per channel minimum and range
+	constexpr int32 QuantizedRangeSize = 8 * sizeof(float);
+
+	int32 GetRawChunkSize(const FOceanBakeHeader& Header)
+	{
+		if (Header.GetEncoding() == EOceanBakeEncoding::Quantized)
+		{
+			return QuantizedRangeSize + Header.GetTexelCount() * 4 * sizeof(uint16);
+		}
+
+		return Header.GetTexelCount() * sizeof(FFloat16Color);
+	}
+
+	void EncodeHalf(const TArray<FVector4>& Texels, uint8* RawData)
+	{
+		FFloat16Color* Output = reinterpret_cast<FFloat16Color*>(RawData);
+
+		for (int32 Index = 0; Index < Texels.Num(); ++Index)
+		{
+			const FVector4& Texel = Texels[Index];
+			Output[Index] = FFloat16Color(FLinearColor(Texel.X, Texel.Y, Texel.Z, Texel.W));
+		}
+	}
+
+	void EncodeQuantized(const TArray<FVector4>& Texels, uint8* RawData)
+	{
+		float Min[4] = { MAX_flt, MAX_flt, MAX_flt, MAX_flt };
+		float Max[4] = { -MAX_flt, -MAX_flt, -MAX_flt, -MAX_flt };
+
+		for (const FVector4& Texel : Texels)
+		{
+			for (int32 Channel = 0; Channel < 4; ++Channel)
+			{
+				Min[Channel] = FMath::Min(Min[Channel], Texel[Channel]);
+				Max[Channel] = FMath::Max(Max[Channel], Texel[Channel]);
+			}
+		}
+
+		float Range[4];
+		for (int32 Channel = 0; Channel < 4; ++Channel)
+		{
+			Range[Channel] = Max[Channel] - Min[Channel];
+		}
+
+		FMemory::Memcpy(RawData, Min, sizeof(Min));
+		FMemory::Memcpy(RawData + sizeof(Min), Range, sizeof(Range));
+
+		uint16* Output = reinterpret_cast<uint16*>(RawData + QuantizedRangeSize);
+
+		for (int32 Index = 0; Index < Texels.Num(); ++Index)
+		{
+			for (int32 Channel = 0; Channel < 4; ++Channel)
+			{
+				const float Alpha = Range[Channel] > 0 ? (Texels[Index][Channel] - Min[Channel]) / Range[Channel] : 0;
+				Output[Index * 4 + Channel] = StaticCast<uint16>(FMath::RoundToInt(FMath::Clamp(Alpha, 0.0f, 1.0f) * MAX_uint16));
+			}
+		}
+	}
+
+	void DecodeHalf(const uint8* RawData, TArray<FFloat16Color>& OutTexels)
+	{
+		FMemory::Memcpy(OutTexels.GetData(), RawData, OutTexels.Num() * sizeof(FFloat16Color));
+	}
+
+	void DecodeQuantized(const uint8* RawData, TArray<FFloat16Color>& OutTexels)
+	{
+		float Min[4];
+		float Range[4];
+		FMemory::Memcpy(Min, RawData, sizeof(Min));
+		FMemory::Memcpy(Range, RawData + sizeof(Min), sizeof(Range));
+
+		const uint16* Input = reinterpret_cast<const uint16*>(RawData + QuantizedRangeSize);
+		const float Scale = 1.0f / MAX_uint16;
+
+		for (int32 Index = 0; Index < OutTexels.Num(); ++Index)
+		{
+			const uint16* Texel = Input + Index * 4;
+			OutTexels[Index] = FFloat16Color(FLinearColor(
+				Min[0] + Texel[0] * Scale * Range[0],
+				Min[1] + Texel[1] * Scale * Range[1],
+				Min[2] + Texel[2] * Scale * Range[2],
+				Min[3] + Texel[3] * Scale * Range[3]));
+		}
+	}
+}
+
+bool FOceanBakeHeader::IsValid() const
+{
+	return Magic == OCEAN_BAKE_MAGIC
+		&& Version == OCEAN_BAKE_VERSION
+		&& Width > 0
+		&& Height > 0
+		&& FrameCount > 0
+		&& Encoding <= StaticCast<uint8>(EOceanBakeEncoding::Quantized);
+}
+
+FArchive& operator<<(FArchive& Ar, FOceanBakeHeader& Header)
+{
+	Ar << Header.Magic;
+	Ar << Header.Version;
+	Ar << Header.Width;
+	Ar << Header.Height;
+	Ar << Header.FrameCount;
+	Ar << Header.StartTime;
+	Ar << Header.TimeStep;
+	Ar << Header.LoopPeriod;
+	Ar << Header.Encoding;
+	Ar << Header.bCompressed;
+
+	return Ar;
+}
+
+FArchive& operator<<(FArchive& Ar, FOceanBakeChunkEntry& Entry)
+{
+	Ar << Entry.Offset;
+	Ar << Entry.StoredSize;
+	Ar << Entry.RawSize;
+
+	return Ar;
+}
+
+int64 FFTOcean::GetOceanBakeIndexTableOffset()
+{
+	return HeaderSize;
+}
+
+int64 FFTOcean::GetOceanBakeIndexTableSize(const FOceanBakeHeader& Header)
+{
+	return StaticCast<int64>(Header.FrameCount) * OCEAN_BAKE_CHUNKS_PER_FRAME * ChunkEntrySize;
+}
+
+void FFTOcean::EncodeOceanBakeChunk(const FOceanBakeHeader& Header, const TArray<FVector4>& Texels, TArray<uint8>& OutChunk, uint32& OutRawSize)
+{
+	check(Texels.Num() == Header.GetTexelCount());
+
+	const int32 RawSize = GetRawChunkSize(Header);
+
+	TArray<uint8> RawData;
+	RawData.SetNumUninitialized(RawSize);
+
+	if (Header.GetEncoding() == EOceanBakeEncoding::Quantized)
+	{
+		EncodeQuantized(Texels, RawData.GetData());
+	}
+	else
+	{
+		EncodeHalf(Texels, RawData.GetData());
+	}
+
+	OutRawSize = RawSize;
+
+	if (Header.bCompressed)
+	{
+		int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, RawSize);
+		OutChunk.SetNumUninitialized(CompressedSize);
+
+		// Chunks that don't shrink are stored as they are, the reader tells them apart by their size
+		if (FCompression::CompressMemory(NAME_Zlib, OutChunk.GetData(), CompressedSize, RawData.GetData(), RawSize) && CompressedSize < RawSize)
+		{
+			OutChunk.SetNum(CompressedSize, false);
+			return;
+		}
+	}
+
+	OutChunk = MoveTemp(RawData);
+}
+
+bool FFTOcean::DecodeOceanBakeChunk(const FOceanBakeHeader& Header, const FOceanBakeChunkEntry& Entry, const uint8* StoredData, TArray<uint8>& DecompressedData, TArray<FFloat16Color>& OutTexels)
+{
+	if (Entry.RawSize != GetRawChunkSize(Header))
+	{
+		return false;
+	}
+
+	const uint8* RawData = StoredData;
+
+	if (Entry.StoredSize < Entry.RawSize)
+	{
+		DecompressedData.SetNumUninitialized(Entry.RawSize, false);
+		if (!FCompression::UncompressMemory(NAME_Zlib, DecompressedData.GetData(), Entry.RawSize, StoredData, Entry.StoredSize))
+		{
+			return false;
+		}
+
+		RawData = DecompressedData.GetData();
+	}
+
+	OutTexels.SetNumUninitialized(Header.GetTexelCount(), false);
+
+	if (Header.GetEncoding() == EOceanBakeEncoding::Quantized)
+	{
+		DecodeQuantized(RawData, OutTexels);
+	}
+	else
+	{
+		DecodeHalf(RawData, OutTexels);
+	}
+
+	return true;
+}
+
+FOceanBakeWriter::FOceanBakeWriter()
+{
+}
+
+FOceanBakeWriter::~FOceanBakeWriter()
+{
+	if (Archive)
+	{
+		Close();
+	}
+}
+
+bool FOceanBakeWriter::Open(const FString& Filename, const FOceanBakeHeader& InHeader)
+{
+	check(!Archive);
+	check(InHeader.IsValid());
+
+	Archive.Reset(IFileManager::Get().CreateFileWriter(*Filename));
+	if (!Archive)
+	{
+		UE_LOG(LogFFTOcean, Error, TEXT("Can't open %s for writing"), *Filename);
+		return false;
+	}
+
+	Header = InHeader;
+	ChunkEntries.Reset(Header.FrameCount * OCEAN_BAKE_CHUNKS_PER_FRAME);
+
+	*Archive << Header;
+
+	// Reserve the index table, it is only known once every chunk has been written
+	TArray<uint8> EmptyIndexTable;
+	EmptyIndexTable.SetNumZeroed(StaticCast<int32>(FFTOcean::GetOceanBakeIndexTableSize(Header)));
+	Archive->Serialize(EmptyIndexTable.GetData(), EmptyIndexTable.Num());
+
+	return !Archive->IsError();
+}
+
+bool FOceanBakeWriter::WriteFrame(const TArray<FVector4>& Displacement, const TArray<FVector4>& Normal)
+{
+	check(Archive);
+
+	if (ChunkEntries.Num() >= StaticCast<int32>(Header.FrameCount) * OCEAN_BAKE_CHUNKS_PER_FRAME)
+	{
+		UE_LOG(LogFFTOcean, Error, TEXT("Ocean bake already holds its %u frames"), Header.FrameCount);
+		return false;
+	}
+
+	return WriteChunk(Displacement) && WriteChunk(Normal);
+}
+
+bool FOceanBakeWriter::WriteChunk(const TArray<FVector4>& Texels)
+{
+	FOceanBakeChunkEntry Entry;
+	Entry.Offset = Archive->Tell();
+
+	TArray<uint8> Chunk;
+	FFTOcean::EncodeOceanBakeChunk(Header, Texels, Chunk, Entry.RawSize);
+	Entry.StoredSize = Chunk.Num();
+
+	Archive->Serialize(Chunk.GetData(), Chunk.Num());
+	ChunkEntries.Add(Entry);
+
+	return !Archive->IsError();
+}
+
+bool FOceanBakeWriter::Close()
+{
+	check(Archive);
+
+	const bool bComplete = ChunkEntries.Num() == StaticCast<int32>(Header.FrameCount) * OCEAN_BAKE_CHUNKS_PER_FRAME;
+	if (bComplete)
+	{
+		Archive->Seek(FFTOcean::GetOceanBakeIndexTableOffset());
+		for (FOceanBakeChunkEntry& Entry : ChunkEntries)
+		{
+			*Archive << Entry;
+		}
+	}
+	else
+	{
+		UE_LOG(LogFFTOcean, Error, TEXT("Ocean bake closed after %d of %u frames"), ChunkEntries.Num() / OCEAN_BAKE_CHUNKS_PER_FRAME, Header.FrameCount);
+	}
+
+	const bool bSucceeded = Archive->Close() && bComplete;
+	Archive.Reset();
+
+	return bSucceeded;
+}
+
+bool FOceanBakeReader::Open(const FString& Filename)
+{
+	FileHandle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*Filename));
+	if (!FileHandle)
+	{
+		UE_LOG(LogFFTOcean, Error, TEXT("Can't open %s for reading"), *Filename);
+		return false;
+	}
+
+	TArray<uint8> HeaderData;
+	HeaderData.SetNumUninitialized(StaticCast<int32>(FFTOcean::GetOceanBakeIndexTableOffset()));
+	if (!FileHandle->Read(HeaderData.GetData(), HeaderData.Num()))
+	{
+		return false;
+	}
+
+	FMemoryReader HeaderReader(HeaderData);
+	HeaderReader << Header;
+
+	if (!Header.IsValid())
+	{
+		UE_LOG(LogFFTOcean, Error, TEXT("%s is not an ocean bake of version %d"), *Filename, OCEAN_BAKE_VERSION);
+		return false;
+	}
+
+	TArray<uint8> IndexTableData;
+	IndexTableData.SetNumUninitialized(StaticCast<int32>(FFTOcean::GetOceanBakeIndexTableSize(Header)));
+	if (!FileHandle->Read(IndexTableData.GetData(), IndexTableData.Num()))
+	{
+		return false;
+	}
+
+	FMemoryReader IndexTableReader(IndexTableData);
+	ChunkEntries.SetNum(Header.FrameCount * OCEAN_BAKE_CHUNKS_PER_FRAME);
+
+	const int64 FileSize = FileHandle->Size();
+	for (FOceanBakeChunkEntry& Entry : ChunkEntries)
+	{
+		IndexTableReader << Entry;
+
+		if (Entry.Offset + Entry.StoredSize > StaticCast<uint64>(FileSize) || Entry.StoredSize > Entry.RawSize)
+		{
+			UE_LOG(LogFFTOcean, Error, TEXT("%s has an incomplete frame index table"), *Filename);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void FOceanBakeReader::Close()
+{
+	FileHandle.Reset();
+}
+
+bool FOceanBakeReader::ReadFrame(int32 Frame, TArray<FFloat16Color>& OutDisplacement, TArray<FFloat16Color>& OutNormal)
+{
+	check(FileHandle);
+
+	if (Frame < 0 || Frame >= StaticCast<int32>(Header.FrameCount))
+	{
+		return false;
+	}
+
+	return ReadChunk(Frame, EOceanBakeChunk::Displacement, OutDisplacement) && ReadChunk(Frame, EOceanBakeChunk::Normal, OutNormal);
+}
+
+bool FOceanBakeReader::ReadChunk(int32 Frame, EOceanBakeChunk Chunk, TArray<FFloat16Color>& OutTexels)
+{
+	const FOceanBakeChunkEntry& Entry = GetChunkEntry(Frame, Chunk);
+
+	StoredData.SetNumUninitialized(Entry.StoredSize, false);
+	if (!FileHandle->Seek(Entry.Offset) || !FileHandle->Read(StoredData.GetData(), Entry.StoredSize))
+	{
+		return false;
+	}
+
+	return FFTOcean::DecodeOceanBakeChunk(Header, Entry, StoredData.GetData(), DecompressedData, OutTexels);
+}
\ No newline at end of file
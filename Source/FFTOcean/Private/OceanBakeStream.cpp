@@ -0,0 +1,203 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "OceanBakeStream.h"
+#include "FFTOcean.h"
+#include "Async/AsyncFileHandle.h"
+#include "HAL/PlatformFilemanager.h"
+
+FOceanBakeStream::FSlot::FSlot() :
+	Frame(INDEX_NONE),
+	bTaken(false)
+{
+	for (IAsyncReadRequest*& Request : Requests)
+	{
+		Request = nullptr;
+	}
+}
+
+FOceanBakeStream::FOceanBakeStream()
+{
+}
+
+FOceanBakeStream::~FOceanBakeStream()
+{
+	// Requests write into the slots, so every read in flight has to land before they go away
+	for (FSlot& Slot : Slots)
+	{
+		FinishSlotRequests(Slot);
+	}
+}
+
+bool FOceanBakeStream::Open(const FString& Filename)
+{
+	check(!FileHandle);
+
+	if (!Reader.Open(Filename))
+	{
+		return false;
+	}
+
+	Reader.Close();
+
+	FileHandle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenAsyncRead(*Filename));
+	if (!FileHandle)
+	{
+		UE_LOG(LogFFTOcean, Error, TEXT("Can't open %s for streaming"), *Filename);
+		return false;
+	}
+
+	uint32 MaxStoredSize = 0;
+	for (uint32 Frame = 0; Frame < GetHeader().FrameCount; ++Frame)
+	{
+		MaxStoredSize = FMath::Max(MaxStoredSize, Reader.GetChunkEntry(Frame, EOceanBakeChunk::Displacement).StoredSize);
+		MaxStoredSize = FMath::Max(MaxStoredSize, Reader.GetChunkEntry(Frame, EOceanBakeChunk::Normal).StoredSize);
+	}
+
+	for (FSlot& Slot : Slots)
+	{
+		for (TArray<uint8>& StoredData : Slot.StoredData)
+		{
+			StoredData.SetNumUninitialized(MaxStoredSize);
+		}
+	}
+
+	return true;
+}
+
+void FOceanBakeStream::Prefetch(int32 FirstFrame, bool bLoop)
+{
+	check(FileHandle);
+
+	const int32 FrameCount = GetHeader().FrameCount;
+
+	for (int32 Offset = 0; Offset < OCEAN_BAKE_STREAM_RING_SIZE; ++Offset)
+	{
+		int32 Frame = FirstFrame + Offset;
+
+		if (bLoop)
+		{
+			Frame %= GetLoopFrameCount();
+		}
+		else if (Frame >= FrameCount)
+		{
+			break;
+		}
+
+		FSlot& Slot = Slots[Frame % OCEAN_BAKE_STREAM_RING_SIZE];
+
+		// A slot still being read is picked up again by a later prefetch
+		if (Slot.Frame != Frame && !IsSlotLoading(Slot))
+		{
+			LoadSlot(Slot, Frame, Frame % FrameCount);
+		}
+	}
+}
+
+bool FOceanBakeStream::TakeDecodedFrame(int32& OutFrame, TSharedPtr<const FOceanBakeFrameTexels, ESPMode::ThreadSafe>& OutTexels)
+{
+	for (FSlot& Slot : Slots)
+	{
+		if (Slot.Frame == INDEX_NONE || Slot.bTaken || Slot.DecodedChunkCount.GetValue() < OCEAN_BAKE_CHUNKS_PER_FRAME)
+		{
+			continue;
+		}
+
+		Slot.bTaken = true;
+
+		if (Slot.bFailed)
+		{
+			UE_LOG(LogFFTOcean, Warning, TEXT("Failed to stream ocean frame %d"), Slot.Frame);
+			continue;
+		}
+
+		const TArray<FFloat16Color>& Displacement = Slot.Texels[StaticCast<int32>(EOceanBakeChunk::Displacement)];
+		const TArray<FFloat16Color>& Normal = Slot.Texels[StaticCast<int32>(EOceanBakeChunk::Normal)];
+
+		// The slot keeps its texels for the next load, the render thread gets a copy
+		FOceanBakeFrameTexelsRef Texels = GetFreeStagingTexels();
+		Texels->Displacement.SetNumUninitialized(Displacement.Num(), false);
+		Texels->Normal.SetNumUninitialized(Normal.Num(), false);
+		FMemory::Memcpy(Texels->Displacement.GetData(), Displacement.GetData(), Displacement.Num() * sizeof(FFloat16Color));
+		FMemory::Memcpy(Texels->Normal.GetData(), Normal.GetData(), Normal.Num() * sizeof(FFloat16Color));
+
+		OutFrame = Slot.Frame;
+		OutTexels = Texels;
+
+		return true;
+	}
+
+	return false;
+}
+
+bool FOceanBakeStream::IsSlotLoading(FSlot& Slot) const
+{
+	for (IAsyncReadRequest* Request : Slot.Requests)
+	{
+		if (Request && !Request->PollCompletion())
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void FOceanBakeStream::LoadSlot(FSlot& Slot, int32 Frame, int32 StoredFrame)
+{
+	FinishSlotRequests(Slot);
+
+	Slot.Frame = Frame;
+	Slot.DecodedChunkCount.Reset();
+	Slot.bFailed = false;
+	Slot.bTaken = false;
+
+	const FOceanBakeHeader& Header = GetHeader();
+
+	for (int32 ChunkIndex = 0; ChunkIndex < OCEAN_BAKE_CHUNKS_PER_FRAME; ++ChunkIndex)
+	{
+		const FOceanBakeChunkEntry& Entry = Reader.GetChunkEntry(StoredFrame, StaticCast<EOceanBakeChunk>(ChunkIndex));
+		FSlot* SlotPtr = &Slot;
+
+		FAsyncFileCallBack Callback = [SlotPtr, ChunkIndex, Entry, &Header](bool bWasCancelled, IAsyncReadRequest* Request)
+		{
+			const bool bDecoded = !bWasCancelled && FFTOcean::DecodeOceanBakeChunk(Header, Entry, SlotPtr->StoredData[ChunkIndex].GetData(), SlotPtr->DecompressedData[ChunkIndex], SlotPtr->Texels[ChunkIndex]);
+			if (!bDecoded)
+			{
+				SlotPtr->bFailed = true;
+			}
+
+			SlotPtr->DecodedChunkCount.Increment();
+		};
+
+		Slot.Requests[ChunkIndex] = FileHandle->ReadRequest(Entry.Offset, Entry.StoredSize, AIOP_Normal, &Callback, Slot.StoredData[ChunkIndex].GetData());
+	}
+}
+
+void FOceanBakeStream::FinishSlotRequests(FSlot& Slot)
+{
+	for (IAsyncReadRequest*& Request : Slot.Requests)
+	{
+		if (Request)
+		{
+			Request->WaitCompletion();
+			delete Request;
+			Request = nullptr;
+		}
+	}
+}
+
+FOceanBakeFrameTexelsRef FOceanBakeStream::GetFreeStagingTexels()
+{
+	// Buffers only referenced by the stream aren't waiting for an upload anymore
+	for (const FOceanBakeFrameTexelsRef& Texels : StagingTexels)
+	{
+		if (Texels.IsUnique())
+		{
+			return Texels;
+		}
+	}
+
+	const int32 Index = StagingTexels.Add(MakeShared<FOceanBakeFrameTexels, ESPMode::ThreadSafe>());
+
+	return StagingTexels[Index];
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OceanBakeFormat.h"
+
+// Frames kept in flight, the two blended frames plus reads ahead of playback
+#define OCEAN_BAKE_STREAM_RING_SIZE 4
+
+class IAsyncReadFileHandle;
+class IAsyncReadRequest;
+
+// Texels of one decoded frame, shared with the render thread until it has uploaded them
+struct FOceanBakeFrameTexels
+{
+	TArray<FFloat16Color> Displacement;
+	TArray<FFloat16Color> Normal;
+};
+
+typedef TSharedRef<FOceanBakeFrameTexels, ESPMode::ThreadSafe> FOceanBakeFrameTexelsRef;
+
+// Streams the frames of a baked ocean through a fixed ring of slots with async reads, so memory use doesn't
+// depend on the sequence length. Chunks are decoded on the IO thread as soon as their read completes.
+class FOceanBakeStream final
+{
+public:
+
+	FOceanBakeStream();
+	~FOceanBakeStream();
+
+	FOceanBakeStream(const FOceanBakeStream&) = delete;
+	FOceanBakeStream& operator=(const FOceanBakeStream&) = delete;
+
+	bool Open(const FString& Filename);
+
+	FORCEINLINE bool IsOpen() const
+	{
+		return FileHandle.IsValid();
+	}
+
+	FORCEINLINE const FOceanBakeHeader& GetHeader() const
+	{
+		return Reader.GetHeader();
+	}
+
+	// Frames of a looping stream keep counting past its end up to this many, and wrap around only when read.
+	// It is a multiple of the ring size, so consecutive frames never share a slot, even across the wrap.
+	FORCEINLINE int32 GetLoopFrameCount() const
+	{
+		return GetHeader().FrameCount * OCEAN_BAKE_STREAM_RING_SIZE;
+	}
+
+	// Starts reading the frames from FirstFrame on that aren't in the ring yet
+	void Prefetch(int32 FirstFrame, bool bLoop);
+
+	// Hands out one frame whose chunks have been decoded since the last call, every load is handed out once. The
+	// texels are copied into a staging buffer of the stream, which is reused once every other reference to it is gone.
+	bool TakeDecodedFrame(int32& OutFrame, TSharedPtr<const FOceanBakeFrameTexels, ESPMode::ThreadSafe>& OutTexels);
+
+private:
+
+	struct FSlot
+	{
+		int32              Frame;
+		IAsyncReadRequest* Requests[OCEAN_BAKE_CHUNKS_PER_FRAME];
+
+		// Chunks are read straight into these, sized for the largest chunk of the stream. Every array keeps its
+		// allocation from one load of the slot to the next.
+		TArray<uint8>         StoredData[OCEAN_BAKE_CHUNKS_PER_FRAME];
+		TArray<uint8>         DecompressedData[OCEAN_BAKE_CHUNKS_PER_FRAME];
+		TArray<FFloat16Color> Texels[OCEAN_BAKE_CHUNKS_PER_FRAME];
+
+		FThreadSafeCounter DecodedChunkCount;
+		FThreadSafeBool    bFailed;
+		bool               bTaken;
+
+		FSlot();
+	};
+
+	// Header and frame index table only, chunks are read through the async handle
+	FOceanBakeReader                 Reader;
+	TUniquePtr<IAsyncReadFileHandle> FileHandle;
+	FSlot                            Slots[OCEAN_BAKE_STREAM_RING_SIZE];
+
+	// Grows to the number of frames the render thread holds at once
+	TArray<FOceanBakeFrameTexelsRef> StagingTexels;
+
+	bool IsSlotLoading(FSlot& Slot) const;
+	void LoadSlot(FSlot& Slot, int32 Frame, int32 StoredFrame);
+	void FinishSlotRequests(FSlot& Slot);
+
+	FOceanBakeFrameTexelsRef GetFreeStagingTexels();
+};
\ No newline at end of file
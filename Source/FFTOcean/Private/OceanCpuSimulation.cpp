@@ -0,0 +1,388 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "OceanCpuSimulation.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+	// Same hash as the Phillips Fourier shader, from https://www.shadertoy.com/view/4t2SDh
+	float NormalizedRand(const FVector2D& UV)
+	{
+		return FMath::Frac(FMath::Sin(UV.X * 12.9898f + UV.Y * 78.233f) * 43758.5453f);
+	}
+
+	float GaussianRand(const FVector2D& UV, float Offset)
+	{
+		const float NormalizedRand1 = NormalizedRand(UV + FVector2D(1, 1) * 0.07f * FMath::Frac(Offset * 2.42385f));
+		const float NormalizedRand2 = NormalizedRand(UV + FVector2D(1, 1) * 0.11f * FMath::Frac(Offset * 0.84381f + 0.573953f));
+		return 0.23f * FMath::Sqrt(-FMath::Loge(NormalizedRand1 + 0.00001f)) * FMath::Cos(2 * PI * NormalizedRand2) + 0.5f;
+	}
+
+	FORCEINLINE FVector2D ComplexMultiply(const FVector2D& A, const FVector2D& B)
+	{
+		return FVector2D(A.X * B.X - A.Y * B.Y, A.X * B.Y + A.Y * B.X);
+	}
+
+	FORCEINLINE FVector2D ComplexConjugate(const FVector2D& A)
+	{
+		return FVector2D(A.X, -A.Y);
+	}
+
+	// i * A
+	FORCEINLINE FVector2D ComplexTimesI(const FVector2D& A)
+	{
+		return FVector2D(-A.Y, A.X);
+	}
+}
+
+FOceanCpuSimulationConfig FOceanCpuSimulationConfig::FromRenderConfig(const FOceanRenderConfig& Config)
+{
+	const FVector2D KWindDefaultDirection(1, 0);
+
+	FOceanCpuSimulationConfig SimulationConfig;
+	SimulationConfig.Size = Config.RenderTextureWidth;
+	SimulationConfig.WaveAmplitude = Config.WaveAmplitude;
+	SimulationConfig.WindSpeed = KWindDefaultDirection.GetRotated(Config.WindDirection) * Config.WindVelocity;
+	SimulationConfig.NormalStrength = Config.NormalStrength;
+	SimulationConfig.bAnalyticNormals = Config.bAnalyticNormals;
+	SimulationConfig.LoopPeriod = Config.LoopPeriod;
+
+	return SimulationConfig;
+}
+
+FVector2D FFTOcean::GetPhillipsAmplitudes(const FOceanCpuSimulationConfig& Config, int32 X, int32 Y)
+{
+	const float L = FFTOcean::PatchLength;
+	const float MinH = -4000.0f;
+	const float MaxH = 4000.0f;
+
+	const FVector2D WindDirection = Config.WindSpeed.GetSafeNormal();
+	const float L_ = Config.WindSpeed.SizeSquared() / FFTOcean::Gravity;
+
+	const FVector2D K = FFTOcean::GetWaveVector(X, Y);
+
+	// The shader normalizes a zero vector here, the constant term is left out instead
+	const FVector2D Kn = K.GetSafeNormal();
+
+	const float K2 = FMath::Max(K.SizeSquared(), 0.0001f);
+	const float K4 = FMath::Square(K2);
+	const float K2L2 = K2 * FMath::Square(L_);
+
+	// (-Kn . W)^2 == (Kn . W)^2, so h0(k) and h0(-k) share their amplitude
+	const float KnDotW = Kn | WindDirection;
+	const float Spectrum = (Config.WaveAmplitude / K4) * FMath::Square(KnDotW) * (K2L2 > 0 ? FMath::Exp(-1 / K2L2) : 0) * FMath::Exp(-K2 * FMath::Square(L / 2000));
+	const float H0K = FMath::Clamp(FMath::Sqrt(Spectrum) * HALF_SQRT_2, MinH, MaxH);
+
+	const FVector2D UV(StaticCast<float>(X) / Config.Size, StaticCast<float>(Y) / Config.Size);
+	return FVector2D(H0K * GaussianRand(UV, 0), H0K * GaussianRand(UV, 2));
+}
+
+float FFTOcean::GetWaveOmega(const FVector2D& K, float LoopPeriod)
+{
+	const float KNorm = FMath::Max(K.Size(), 0.0001f);
+
+	float Omega = FMath::Sqrt(FFTOcean::Gravity * KNorm);
+	if (LoopPeriod > 0)
+	{
+		const float LoopOmega = 2 * PI / LoopPeriod;
+		Omega = FMath::FloorToFloat(Omega / LoopOmega) * LoopOmega;
+	}
+
+	return Omega;
+}
+
+FVector FFTOcean::EstimateMaxDisplacement(const FOceanRenderConfig& Config)
+{
+	const FOceanCpuSimulationConfig SimulationConfig = FOceanCpuSimulationConfig::FromRenderConfig(Config);
+	const int32 Size = SimulationConfig.Size;
+
+	if (Size <= 0)
+	{
+		return FVector::ZeroVector;
+	}
+
+	// The Phillips spectrum falls off with k^4, texels past the first few dozen add nothing to the variance
+	const int32 SampleCount = FMath::Min(Size, 64);
+	const float Scale = 10.0f / (Size * Size);
+
+	FVector Variance = FVector::ZeroVector;
+
+	for (int32 Y = 0; Y < SampleCount; ++Y)
+	{
+		for (int32 X = 0; X < SampleCount; ++X)
+		{
+			const FVector2D H0 = FFTOcean::GetPhillipsAmplitudes(SimulationConfig, X, Y);
+			const FVector2D Kn = FFTOcean::GetWaveVector(X, Y).GetSafeNormal();
+
+			// Every texel transforms into one cosine, whose squared amplitude averages to |h0(k)|^2 + |h0(-k)|^2 over
+			// time. The horizontal spectra scale it by (K.x, -K.x) / |K| and (K.y, -K.y) / |K|.
+			const float Energy = (FMath::Square(H0.X) + FMath::Square(H0.Y)) * 0.5f;
+			Variance += Energy * FVector(2 * FMath::Square(Kn.X), 2 * FMath::Square(Kn.Y), 1);
+		}
+	}
+
+	// Four standard deviations, the statistics pass measures the real maximum later on
+	const float Deviations = 4.0f;
+	return FVector(FMath::Sqrt(Variance.X), FMath::Sqrt(Variance.Y), FMath::Sqrt(Variance.Z)) * Scale * Deviations;
+}
+
+FOceanCpuSimulation::FOceanCpuSimulation(const FOceanCpuSimulationConfig& InConfig) :
+	Config(InConfig)
+{
+	check(FMath::IsPowerOfTwo(Config.Size));
+
+	const int32 Size = Config.Size;
+	const int32 TexelCount = Size * Size;
+
+	StageCount = FMath::FloorLog2(Size);
+
+	BitReversedIndices.SetNumUninitialized(Size);
+	for (int32 Index = 0; Index < Size; ++Index)
+	{
+		BitReversedIndices[Index] = StaticCast<int32>(FMath::ReverseBits(StaticCast<uint32>(Index)) >> (32 - StageCount));
+	}
+
+	// Positive exponent, the GPU transform is an unnormalized inverse DFT
+	TwiddleFactors.SetNumUninitialized(Size / 2);
+	for (int32 Index = 0; Index < Size / 2; ++Index)
+	{
+		float SinV, CosV;
+		FMath::SinCos(&SinV, &CosV, 2 * PI * Index / Size);
+		TwiddleFactors[Index] = FVector2D(CosV, SinV);
+	}
+
+	SpectrumXY.SetNumUninitialized(TexelCount);
+	SpectrumZ.SetNumUninitialized(TexelCount);
+	SpectrumJacobian.SetNumUninitialized(TexelCount);
+
+	if (Config.bAnalyticNormals)
+	{
+		SpectrumSlope.SetNumUninitialized(TexelCount);
+	}
+
+	DisplacementMap.SetNumZeroed(TexelCount);
+	NormalMap.SetNumZeroed(TexelCount);
+
+	ComputePhillipsFourier();
+}
+
+void FOceanCpuSimulation::Simulate(float Time)
+{
+	// Looping surfaces are periodic, same wrap as the renderer
+	if (Config.LoopPeriod > 0)
+	{
+		Time = FMath::Fmod(Time, Config.LoopPeriod);
+	}
+
+	ComputeFourierComponents(Time);
+
+	InverseTransform(SpectrumXY);
+	InverseTransform(SpectrumZ);
+	InverseTransform(SpectrumJacobian);
+
+	if (Config.bAnalyticNormals)
+	{
+		InverseTransform(SpectrumSlope);
+	}
+
+	ComputeSurfaceDisplacement();
+
+	if (!Config.bAnalyticNormals)
+	{
+		ComputeSurfaceNormal();
+	}
+}
+
+void FOceanCpuSimulation::ComputePhillipsFourier()
+{
+	const int32 Size = Config.Size;
+
+	PhillipsFourier.SetNumUninitialized(Size * Size);
+
+	for (int32 Y = 0; Y < Size; ++Y)
+	{
+		for (int32 X = 0; X < Size; ++X)
+		{
+			PhillipsFourier[Y * Size + X] = FFTOcean::GetPhillipsAmplitudes(Config, X, Y);
+		}
+	}
+}
+
+void FOceanCpuSimulation::ComputeFourierComponents(float Time)
+{
+	const int32 Size = Config.Size;
+	const bool bComputeSlopes = Config.bAnalyticNormals;
+
+	ParallelFor(Size, [this, Size, bComputeSlopes, Time](int32 Y)
+	{
+		for (int32 X = 0; X < Size; ++X)
+		{
+			const int32 Index = Y * Size + X;
+
+			FVector2D HKt_dx, HKt_dy, HKt_dz;
+			ComputeSurfaceSpectrum(X, Y, Time, HKt_dx, HKt_dy, HKt_dz);
+
+			FVector2D MirrorHKt_dx, MirrorHKt_dy, MirrorHKt_dz;
+			ComputeSurfaceSpectrum((Size - X) % Size, (Size - Y) % Size, Time, MirrorHKt_dx, MirrorHKt_dy, MirrorHKt_dz);
+
+			// Hermitian parts, whose transforms are the real parts of the per texel spectra, see the Fourier component shader
+			const FVector2D HX = (HKt_dx + ComplexConjugate(MirrorHKt_dx)) * 0.5f;
+			const FVector2D HY = (HKt_dy + ComplexConjugate(MirrorHKt_dy)) * 0.5f;
+			const FVector2D HZ = (HKt_dz + ComplexConjugate(MirrorHKt_dz)) * 0.5f;
+
+			// Same as the packed derivatives of FourierComponent.ush: the Hermitian spectra times centered wave vectors,
+			// so the mirror texel has exactly -k and the transforms are real derivatives. The Nyquist frequency is dropped.
+			const int32 CenteredX = X < Size / 2 ? X : (X > Size / 2 ? X - Size : 0);
+			const int32 CenteredY = Y < Size / 2 ? Y : (Y > Size / 2 ? Y - Size : 0);
+			const FVector2D K = FFTOcean::GetWaveVector(CenteredX, CenteredY);
+
+			SpectrumXY[Index] = HX + ComplexTimesI(HY);
+			SpectrumZ[Index] = HZ - (K.Y * HX + K.X * HY) * 0.5f;
+			SpectrumJacobian[Index] = K.X * ComplexTimesI(HX) - K.Y * HY;
+
+			if (bComputeSlopes)
+			{
+				SpectrumSlope[Index] = K.X * ComplexTimesI(HZ) - K.Y * HZ;
+			}
+		}
+	});
+}
+
+void FOceanCpuSimulation::ComputeSurfaceSpectrum(int32 X, int32 Y, float Time, FVector2D& OutX, FVector2D& OutY, FVector2D& OutZ) const
+{
+	const FVector2D K = FFTOcean::GetWaveVector(X, Y);
+	const float KNorm = FMath::Max(K.Size(), 0.0001f);
+	const float Omega = FFTOcean::GetWaveOmega(K, Config.LoopPeriod);
+
+	float SinV, CosV;
+	FMath::SinCos(&SinV, &CosV, Omega * Time);
+
+	const FVector2D& H0 = PhillipsFourier[Y * Config.Size + X];
+
+	OutZ = H0.X * FVector2D(CosV, SinV) + H0.Y * FVector2D(CosV, -SinV);
+	OutX = OutZ * FVector2D(K.X, -K.X) / KNorm;
+	OutY = OutZ * FVector2D(K.Y, -K.Y) / KNorm;
+}
+
+void FOceanCpuSimulation::InverseTransform(TArray<FVector2D>& Spectrum) const
+{
+	const int32 Size = Config.Size;
+	FVector2D* Data = Spectrum.GetData();
+
+	// Horizontal stages first, then vertical, like the ping pong passes
+	ParallelFor(Size, [this, Data, Size](int32 Row)
+	{
+		InverseTransformLine(Data + Row * Size, 1);
+	});
+
+	ParallelFor(Size, [this, Data, Size](int32 Column)
+	{
+		InverseTransformLine(Data + Column, Size);
+	});
+}
+
+void FOceanCpuSimulation::InverseTransformLine(FVector2D* Line, int32 Stride) const
+{
+	const int32 Size = Config.Size;
+
+	for (int32 Index = 0; Index < Size; ++Index)
+	{
+		const int32 ReversedIndex = BitReversedIndices[Index];
+		if (Index < ReversedIndex)
+		{
+			Swap(Line[Index * Stride], Line[ReversedIndex * Stride]);
+		}
+	}
+
+	for (int32 HalfSpan = 1; HalfSpan < Size; HalfSpan *= 2)
+	{
+		const int32 TwiddleStride = Size / (2 * HalfSpan);
+
+		for (int32 Start = 0; Start < Size; Start += 2 * HalfSpan)
+		{
+			for (int32 Offset = 0; Offset < HalfSpan; ++Offset)
+			{
+				FVector2D& Top = Line[(Start + Offset) * Stride];
+				FVector2D& Bottom = Line[(Start + Offset + HalfSpan) * Stride];
+
+				const FVector2D Twiddled = ComplexMultiply(TwiddleFactors[Offset * TwiddleStride], Bottom);
+
+				Bottom = Top - Twiddled;
+				Top = Top + Twiddled;
+			}
+		}
+	}
+}
+
+void FOceanCpuSimulation::ComputeSurfaceDisplacement()
+{
+	const int32 Size = Config.Size;
+	const float Scale = 10.0f / (Size * Size);
+	const float TexelLength = FFTOcean::PatchLength / Size;
+
+	ParallelFor(Size, [this, Size, Scale, TexelLength](int32 Y)
+	{
+		for (int32 X = 0; X < Size; ++X)
+		{
+			const int32 Index = Y * Size + X;
+
+			// Exact derivatives of the horizontal displacement, carried along by the transforms
+			const FVector2D Derivatives = SpectrumJacobian[Index] * Scale;
+
+			const float DxDx = Derivatives.X;
+			const float DyDy = Derivatives.Y;
+			const float DxDy = SpectrumZ[Index].Y * Scale;
+			const float DyDx = DxDy;
+
+			const float Jacobian = (1 + DxDx) * (1 + DyDy) - DxDy * DyDx;
+
+			DisplacementMap[Index] = FVector4(SpectrumXY[Index].X * Scale, SpectrumXY[Index].Y * Scale, SpectrumZ[Index].X * Scale, Jacobian);
+
+			if (Config.bAnalyticNormals)
+			{
+				const FVector2D Slope = SpectrumSlope[Index] * Scale * Config.NormalStrength * 8 * TexelLength;
+
+				FVector Normal;
+				Normal.X = Slope.X * (1 + DyDy) - DyDx * Slope.Y;
+				Normal.Y = Slope.Y * (1 + DxDx) - DxDy * Slope.X;
+				Normal.Z = Jacobian;
+
+				NormalMap[Index] = FVector4(Normal.GetSafeNormal(), 1);
+			}
+		}
+	});
+}
+
+void FOceanCpuSimulation::ComputeSurfaceNormal()
+{
+	const int32 Size = Config.Size;
+	const float DZ = 1.0f / Config.NormalStrength;
+
+	auto GetHeight = [this, Size](int32 X, int32 Y)
+	{
+		// Clamped to the size rather than the last texel, a GPU load past the edge reads zero
+		X = FMath::Clamp(X, 0, Size);
+		Y = FMath::Clamp(Y, 0, Size);
+		return X < Size && Y < Size ? DisplacementMap[Y * Size + X].Z : 0.0f;
+	};
+
+	ParallelFor(Size, [this, Size, DZ, &GetHeight](int32 Y)
+	{
+		for (int32 X = 0; X < Size; ++X)
+		{
+			const float TopLeft = GetHeight(X - 1, Y - 1);
+			const float Left = GetHeight(X - 1, Y);
+			const float BottomLeft = GetHeight(X - 1, Y + 1);
+			const float Top = GetHeight(X, Y - 1);
+			const float Bottom = GetHeight(X, Y + 1);
+			const float TopRight = GetHeight(X + 1, Y - 1);
+			const float Right = GetHeight(X + 1, Y);
+			const float BottomRight = GetHeight(X + 1, Y + 1);
+
+			const float DX = (TopRight + 2 * Right + BottomRight) - (TopLeft + 2 * Left + BottomLeft);
+			const float DY = (BottomLeft + 2 * Bottom + BottomRight) - (TopLeft + 2 * Top + TopRight);
+
+			NormalMap[Y * Size + X] = FVector4(FVector(DX, DY, DZ).GetSafeNormal(), 1);
+		}
+	});
+}
\ No newline at end of file
@@ -0,0 +1,123 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "OceanFlipbook.h"
+#include "FFTOcean.h"
+#include "Engine/Texture2DArray.h"
+#include "Engine/TextureRenderTarget2D.h"
+
+#if WITH_EDITOR
+#include "AssetRegistryModule.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+#endif
+
+#if WITH_EDITOR
+namespace
+{
+	bool ReadFrame(UTextureRenderTarget2D* RenderTarget, TArray<FFloat16Color>& OutFrames)
+	{
+		FTextureRenderTargetResource* Resource = RenderTarget->GameThread_GetRenderTargetResource();
+
+		TArray<FFloat16Color> FramePixels;
+		if (!Resource || !Resource->ReadFloat16Pixels(FramePixels))
+		{
+			return false;
+		}
+
+		OutFrames.Append(FramePixels);
+		return true;
+	}
+
+	UTexture2DArray* CreateFlipbookAsset(const FString& PackageName, int32 Width, int32 Height, int32 FrameCount, const TArray<FFloat16Color>& Frames)
+	{
+		UPackage* Package = CreatePackage(nullptr, *PackageName);
+		Package->FullyLoad();
+
+		const FString AssetName = FPackageName::GetLongPackageAssetName(PackageName);
+
+		// Rebaking overwrites the previous flipbook so materials and components keep referencing it
+		UTexture2DArray* Flipbook = FindObject<UTexture2DArray>(Package, *AssetName);
+		if (!Flipbook)
+		{
+			Flipbook = NewObject<UTexture2DArray>(Package, *AssetName, RF_Public | RF_Standalone);
+			FAssetRegistryModule::AssetCreated(Flipbook);
+		}
+
+		Flipbook->Modify();
+		Flipbook->Source.Init(Width, Height, FrameCount, 1, TSF_RGBA16F, reinterpret_cast<const uint8*>(Frames.GetData()));
+
+		// Displacement and normals are signed, so frames are kept as uncompressed linear half floats
+		Flipbook->SRGB = false;
+		Flipbook->CompressionSettings = TC_HDR;
+		Flipbook->MipGenSettings = TMGS_NoMipmaps;
+		Flipbook->AddressX = TA_Wrap;
+		Flipbook->AddressY = TA_Wrap;
+		Flipbook->PostEditChange();
+
+		Package->MarkPackageDirty();
+
+		return Flipbook;
+	}
+}
+#endif
+
+bool FFTOcean::BakeOceanFlipbook(
+	const FOceanRenderConfig& Config,
+	const FOceanFlipbookBakeSettings& Settings,
+	UTexture2DArray*& OutDisplacementFlipbook,
+	UTexture2DArray*& OutNormalFlipbook)
+{
+#if WITH_EDITOR
+	check(IsInGameThread());
+
+	if (Config.LoopPeriod <= 0)
+	{
+		UE_LOG(LogFFTOcean, Warning, TEXT("Can't bake an ocean flipbook without a LoopPeriod, the surface would not loop"));
+		return false;
+	}
+
+	if (!Config.DisplacementMap || !Config.NormalMap)
+	{
+		UE_LOG(LogFFTOcean, Warning, TEXT("Can't bake an ocean flipbook without both a DisplacementMap and a NormalMap"));
+		return false;
+	}
+
+	// Bake the simulation itself, not whatever flipbook is currently played back
+	FOceanRenderConfig BakeConfig = Config;
+	BakeConfig.DisplacementFlipbook = nullptr;
+	BakeConfig.NormalFlipbook = nullptr;
+
+	const FOceanDebugConfig DebugConfig = FOceanDebugConfig();
+	const int32 FrameCount = FMath::Max(Settings.FrameCount, 2);
+
+	TArray<FFloat16Color> DisplacementFrames;
+	TArray<FFloat16Color> NormalFrames;
+
+	{
+		FFFTOceanRenderer Renderer;
+
+		for (int32 Frame = 0; Frame < FrameCount; ++Frame)
+		{
+			Renderer.Render(Config.LoopPeriod * Frame / FrameCount, BakeConfig, DebugConfig);
+			FFFTOceanRenderer::FlushBatchedOceans();
+
+			// Reading a render target back flushes rendering commands, so each frame is complete here
+			if (!ReadFrame(Config.DisplacementMap, DisplacementFrames) || !ReadFrame(Config.NormalMap, NormalFrames))
+			{
+				UE_LOG(LogFFTOcean, Warning, TEXT("Failed to read back ocean flipbook frame %d"), Frame);
+				return false;
+			}
+		}
+	}
+
+	const FString PackageName = Settings.PackagePath / Settings.AssetName;
+
+	OutDisplacementFlipbook = CreateFlipbookAsset(PackageName + TEXT("_Displacement"), Config.DisplacementMap->SizeX, Config.DisplacementMap->SizeY, FrameCount, DisplacementFrames);
+	OutNormalFlipbook = CreateFlipbookAsset(PackageName + TEXT("_Normal"), Config.NormalMap->SizeX, Config.NormalMap->SizeY, FrameCount, NormalFrames);
+
+	return true;
+#else
+	UE_LOG(LogFFTOcean, Warning, TEXT("Ocean flipbooks can only be baked in the editor"));
+	return false;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "OceanGpuTimer.h"
+
+FOceanGpuTimer::FOceanGpuTimer() :
+	QueryWriteIndex(0),
+	bMeasuring(false),
+	Time(0)
+{
+	FMemory::Memzero(bQueryPending);
+}
+
+void FOceanGpuTimer::Begin(FRHICommandListImmediate& RHICmdList)
+{
+	check(IsInRenderingThread());
+
+	ResolveQueries();
+
+	bMeasuring = !bQueryPending[QueryWriteIndex];
+
+	if (bMeasuring)
+	{
+		if (!BeginQueries[QueryWriteIndex])
+		{
+			BeginQueries[QueryWriteIndex] = RHICreateRenderQuery(RQT_AbsoluteTime);
+			EndQueries[QueryWriteIndex] = RHICreateRenderQuery(RQT_AbsoluteTime);
+		}
+
+		// Timestamp queries are only ever ended
+		RHICmdList.EndRenderQuery(BeginQueries[QueryWriteIndex]);
+	}
+}
+
+void FOceanGpuTimer::End(FRHICommandListImmediate& RHICmdList)
+{
+	check(IsInRenderingThread());
+
+	if (bMeasuring)
+	{
+		RHICmdList.EndRenderQuery(EndQueries[QueryWriteIndex]);
+
+		bQueryPending[QueryWriteIndex] = true;
+		QueryWriteIndex = (QueryWriteIndex + 1) % QueryCount;
+		bMeasuring = false;
+	}
+}
+
+void FOceanGpuTimer::ResolveQueries()
+{
+	// Oldest first, so the time only ever moves forward
+	for (int32 Offset = 0; Offset < QueryCount; ++Offset)
+	{
+		const int32 Index = (QueryWriteIndex + Offset) % QueryCount;
+
+		if (!bQueryPending[Index])
+		{
+			continue;
+		}
+
+		uint64 BeginTime = 0;
+		uint64 EndTime = 0;
+
+		if (!RHIGetRenderQueryResult(BeginQueries[Index], BeginTime, false) || !RHIGetRenderQueryResult(EndQueries[Index], EndTime, false))
+		{
+			break;
+		}
+
+		// Timestamps are read back in microseconds
+		Time = EndTime > BeginTime ? (EndTime - BeginTime) / 1000.0f : 0;
+		bQueryPending[Index] = false;
+	}
+}
\ No newline at end of file
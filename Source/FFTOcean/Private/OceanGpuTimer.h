@@ -0,0 +1,40 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "RHI/Public/RHIResources.h"
+#include "RHI/Public/RHICommandList.h"
+
+// GPU time of the commands between Begin and End, from timestamp queries read back a few frames later.
+// Render thread only, it never waits for the GPU.
+class FOceanGpuTimer final
+{
+public:
+
+	FOceanGpuTimer();
+
+	void Begin(FRHICommandListImmediate& RHICmdList);
+	void End(FRHICommandListImmediate& RHICmdList);
+
+	// Latest time read back, in milliseconds, zero until the first one
+	FORCEINLINE float GetTime() const
+	{
+		return Time;
+	}
+
+private:
+
+	static constexpr int32 QueryCount = 4;
+
+	FRenderQueryRHIRef BeginQueries[QueryCount];
+	FRenderQueryRHIRef EndQueries[QueryCount];
+	bool               bQueryPending[QueryCount];
+	int32              QueryWriteIndex;
+
+	// False while every query is still in flight, that frame is simply not measured
+	bool  bMeasuring;
+	float Time;
+
+	void ResolveQueries();
+};
\ No newline at end of file
@@ -3,22 +3,119 @@
 
 #include "OceanMeshComponent.h"
 #include "Kismet/GameplayStatics.h"
+#include "OceanBounds.h"
+#include "OceanCpuSimulation.h"
 
 UOceanMeshComponent::UOceanMeshComponent(const FObjectInitializer& ObjectInitializer) :
 	Super(ObjectInitializer),
-	OceanRenderer(new FFFTOceanRenderer)
 {
+	PrimaryComponentTick.bRunOnAnyThread = true;
+
 	bTickInEditor = true;
 	bAutoActivate = true;
 
+	// Estimated from the spectrum on register, until the GPU wave statistics take over
+	MaxDisplacement = FVector::ZeroVector;
+	DisplacementPadding = FFTOcean::GetDisplacementPadding(MaxDisplacement);
+
 	RenderConfig.RenderTextureWidth = 512;
 	RenderConfig.RenderTextureHeight = 512;
+	RenderConfig.GerstnerWaveCount = 16;
+}
+
+void UOceanMeshComponent::SetMaxDisplacement(const FVector& InMaxDisplacement)
+{
+	MaxDisplacement = InMaxDisplacement.GetAbs();
+
+	if (FFTOcean::IsDisplacementPaddingOutdated(DisplacementPadding, MaxDisplacement))
+	{
+		DisplacementPadding = FFTOcean::GetDisplacementPadding(MaxDisplacement);
+		UpdateBounds();
+		MarkRenderTransformDirty();
+	}
+}
+
+void UOceanMeshComponent::BakeFlipbook()
+{
+	FOceanSimulationDriver::BakeFlipbook(this, RenderConfig, FlipbookBakeSettings);
+}
+
+void UOceanMeshComponent::TransitionSeaState(float WaveAmplitude, float WindVelocity, float WindDirection, float TransitionTime)
+{
+	FOceanSimulationDriver::TransitionSeaState(RenderConfig, WaveAmplitude, WindVelocity, WindDirection, TransitionTime);
+}
+
+void UOceanMeshComponent::AddRadialImpulse(FVector2D Center, float Radius, float Amplitude)
+{
+	SimulationDriver.AddRadialImpulse(Center, Radius, Amplitude);
+}
+
+void UOceanMeshComponent::AddWake(FVector2D Start, FVector2D End, float Width, float Amplitude)
+{
+	SimulationDriver.AddWake(Start, End, Width, Amplitude);
+}
+
+FOceanWaveStatistics UOceanMeshComponent::GetWaveStatistics() const
+{
+	return SimulationDriver.GetWaveStatistics();
+}
+
+FOceanSnapshotRef UOceanMeshComponent::GetSurfaceSnapshot() const
+{
+	return SimulationDriver.GetSurfaceSnapshot();
+}
+
+FBoxSphereBounds UOceanMeshComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+	// MaxDisplacement may have been edited directly, so never pad less than it asks for
+	const FVector Padding = DisplacementPadding.ComponentMax(MaxDisplacement.GetAbs());
+	return FFTOcean::ExpandBoundsByDisplacement(Super::CalcBounds(LocalToWorld), Padding, LocalToWorld);
+}
+
+void UOceanMeshComponent::OnRegister()
+{
+	Super::OnRegister();
+
+	SimulationDriver.Register(this, RenderConfig, DebugConfig, SimulationPolicy, [this](const FVector& InMaxDisplacement)
+	{
+		SetMaxDisplacement(InMaxDisplacement);
+	});
+
+	if (MaxDisplacement.IsZero())
+	{
+		SetMaxDisplacement(FFTOcean::EstimateMaxDisplacement(RenderConfig));
+	}
+}
+
+void UOceanMeshComponent::RegisterComponentTickFunctions(bool bRegister)
+{
+	Super::RegisterComponentTickFunctions(bRegister);
+
+	SimulationDriver.RegisterTickFunction(bRegister);
+}
+
+void UOceanMeshComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	SimulationDriver.BeginPlay();
+}
+
+void UOceanMeshComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	SimulationDriver.EndPlay();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UOceanMeshComponent::WarmUp()
+{
+	SimulationDriver.WarmUp();
 }
 
 void UOceanMeshComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
-	float Timestamp = UGameplayStatics::GetRealTimeSeconds(GetWorld()) * RenderConfig.TimeMultiply;
-	OceanRenderer->Render(Timestamp, RenderConfig, DebugConfig);
+	SimulationDriver.Tick(DeltaTime);
 }
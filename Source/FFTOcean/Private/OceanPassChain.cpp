@@ -0,0 +1,309 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "OceanPassChain.h"
+#include "OceanRenderProxy.h"
+
+bool operator==(const FOceanPassChainConfig& A, const FOceanPassChainConfig& B)
+{
+	return FMemory::Memcmp(&A, &B, sizeof(FOceanPassChainConfig)) == 0;
+}
+
+bool operator!=(const FOceanPassChainConfig& A, const FOceanPassChainConfig& B)
+{
+	return !(A == B);
+}
+
+FOceanPassChain::FOceanPassChain(const FOceanPassChainConfig& InConfig) :
+	Config(InConfig),
+	PreparedPassCount(0),
+	PhillipsFourierPass(new FPhillipsFourierPass()),
+	FourierComponentPass(new FFourierComponentPass()),
+	TwiddleFactorsPass(new FTwiddleFactorsPass()),
+	InverseTransformPass(new FInverseTransformPass()),
+	SurfaceDisplacementPass(new FSurfaceDisplacementPass()),
+	SurfaceNormalPass(new FSurfaceNormalPass()),
+	DisturbancePass(new FDisturbancePass()),
+	WaveStatisticsPass(new FWaveStatisticsPass()),
+	MipChainPass(new FMipChainPass())
+{
+	PhillipsFourierPassConfig.TextureWidth = Config.TextureWidth;
+	PhillipsFourierPassConfig.TextureHeight = Config.TextureHeight;
+
+	FourierComponentPassConfig.TextureWidth = Config.TextureWidth;
+	FourierComponentPassConfig.TextureHeight = Config.TextureHeight;
+	FourierComponentPassConfig.ComponentCount = Config.ComponentCount;
+
+	TwiddleFactorsPassConfig.TextureWidth = Config.TextureWidth;
+	TwiddleFactorsPassConfig.TextureHeight = Config.TextureHeight;
+
+	InverseTransformPassConfig.TextureWidth = Config.TextureWidth;
+	InverseTransformPassConfig.TextureHeight = Config.TextureHeight;
+	InverseTransformPassConfig.ComponentCount = Config.ComponentCount;
+
+	SurfaceDisplacementPassConfig.TextureWidth = Config.TextureWidth;
+	SurfaceDisplacementPassConfig.TextureHeight = Config.TextureHeight;
+
+	SurfaceNormalPassConfig.TextureWidth = Config.TextureWidth;
+	SurfaceNormalPassConfig.TextureHeight = Config.TextureHeight;
+
+	DisturbancePassConfig.TextureWidth = Config.TextureWidth;
+	DisturbancePassConfig.TextureHeight = Config.TextureHeight;
+
+	WaveStatisticsPassConfig.TextureWidth = Config.TextureWidth;
+	WaveStatisticsPassConfig.TextureHeight = Config.TextureHeight;
+
+	MipChainPassConfig.TextureWidth = Config.TextureWidth;
+	MipChainPassConfig.TextureHeight = Config.TextureHeight;
+
+	SurfaceReadbackPassConfig.TextureWidth = Config.TextureWidth;
+	SurfaceReadbackPassConfig.TextureHeight = Config.TextureHeight;
+}
+
+FOceanPassChain::~FOceanPassChain()
+{
+	check(IsInRenderingThread());
+}
+
+bool FOceanPassChain::PrepareNextPass(FRHICommandListImmediate& RHICmdList)
+{
+	check(IsInRenderingThread());
+
+	// One pass per call spreads resource creation and the twiddle table build over several frames
+	switch (PreparedPassCount)
+	{
+	case 0: PhillipsFourierPass->Prepare(PhillipsFourierPassConfig); break;
+	case 1: FourierComponentPass->Prepare(FourierComponentPassConfig); break;
+	case 2: TwiddleFactorsPass->Prepare(RHICmdList, TwiddleFactorsPassConfig); break;
+	case 3: InverseTransformPass->Prepare(InverseTransformPassConfig); break;
+	case 4: SurfaceDisplacementPass->Prepare(SurfaceDisplacementPassConfig); break;
+	case 5: SurfaceNormalPass->Prepare(SurfaceNormalPassConfig); break;
+	case 6: DisturbancePass->Prepare(DisturbancePassConfig); break;
+	case 7: WaveStatisticsPass->Prepare(WaveStatisticsPassConfig); break;
+	case 8: MipChainPass->Prepare(MipChainPassConfig); break;
+	default: break;
+	}
+
+	PreparedPassCount = FMath::Min(PreparedPassCount + 1, PassCount);
+
+	return IsReady();
+}
+
+void FOceanPassChain::WarmUp(FRHICommandListImmediate& RHICmdList, const FOceanRenderPacket& Packet)
+{
+	check(IsInRenderingThread());
+
+	while (!PrepareNextPass(RHICmdList))
+	{
+	}
+
+	// The spectrum pass keeps the spectra of the last sea states and the twiddle table never changes for a size
+	RenderSpectra(RHICmdList, Packet);
+}
+
+void FOceanPassChain::Render(FRHICommandListImmediate& RHICmdList, const FOceanRenderPacket& Packet)
+{
+	check(IsInRenderingThread());
+
+	RenderSpectra(RHICmdList, Packet);
+	RenderTransforms(RHICmdList, Packet);
+	RenderSurface(RHICmdList, Packet);
+}
+
+void FOceanPassChain::RenderSpectra(FRHICommandListImmediate& RHICmdList, const FOceanRenderPacket& Packet)
+{
+	check(IsInRenderingThread());
+
+	auto RenderPhillipsFourierPass = [&RHICmdList, &Packet, this]()
+	{
+		FPhillipsFourierPassParam OutgoingParam;
+		OutgoingParam.WaveAmplitude = Packet.OutgoingSeaState.WaveAmplitude;
+		OutgoingParam.WindSpeed = Packet.OutgoingSeaState.WindSpeed;
+
+		FPhillipsFourierPassParam IncomingParam;
+		IncomingParam.WaveAmplitude = Packet.IncomingSeaState.WaveAmplitude;
+		IncomingParam.WindSpeed = Packet.IncomingSeaState.WindSpeed;
+
+		FRHITexture* DebugTextureRef = FFTOcean::GetRHITextureFromTextureReference(Packet.PhillipsFourierPassDebugTexture);
+
+		PhillipsFourierPass->Render(RHICmdList, PhillipsFourierPassConfig, OutgoingParam, IncomingParam, DebugTextureRef);
+	};
+
+	auto RenderTwiddleFactorsPass = [&RHICmdList, &Packet, this]()
+	{
+		FTwiddleFactorsPassParam Param;
+
+		FRHITexture* DebugTextureRef = FFTOcean::GetRHITextureFromTextureReference(Packet.TwiddleFactorsDebugTexture);
+
+		TwiddleFactorsPass->Render(RHICmdList, TwiddleFactorsPassConfig, Param, DebugTextureRef);
+	};
+
+	RenderPhillipsFourierPass();
+	RenderTwiddleFactorsPass();
+}
+
+void FOceanPassChain::RenderTransforms(FRHICommandListImmediate& RHICmdList, const FOceanRenderPacket& Packet)
+{
+	check(IsInRenderingThread());
+
+	auto RenderFourierComponentPass = [&RHICmdList, &Packet, this]()
+	{
+		FFourierComponentPassParam Param;
+		Param.Time = Packet.Timestamp;
+		Param.LoopPeriod = Packet.LoopPeriod;
+		Param.PhillipsFourierTextureSRV = PhillipsFourierPass->GetOutgoingPhillipsFourierTextureSRV();
+		Param.IncomingPhillipsFourierTextureSRV = PhillipsFourierPass->GetIncomingPhillipsFourierTextureSRV();
+		Param.SeaStateBlend = Packet.SeaStateBlend;
+
+		FRHITexture* DebugTextureXRef = FFTOcean::GetRHITextureFromTextureReference(Packet.SurfaceDebugTextureX);
+		FRHITexture* DebugTextureYRef = FFTOcean::GetRHITextureFromTextureReference(Packet.SurfaceDebugTextureY);
+		FRHITexture* DebugTextureZRef = FFTOcean::GetRHITextureFromTextureReference(Packet.SurfaceDebugTextureZ);
+
+		FourierComponentPass->Render(RHICmdList, FourierComponentPassConfig, Param, DebugTextureXRef, DebugTextureYRef, DebugTextureZRef);
+	};
+
+	auto RenderInverseTransformPass = [&RHICmdList, &Packet, this]()
+	{
+		FInverseTransformPassParam Param;
+		for (uint32 Index = 0; Index < Config.ComponentCount; ++Index)
+		{
+			Param.FourierComponentTextures[Index] = FourierComponentPass->GetSurfaceTexture(Index);
+			Param.FourierComponentTextureSRVs[Index] = FourierComponentPass->GetSurfaceTextureSRV(Index);
+			Param.FourierComponentTextureUAVs[Index] = FourierComponentPass->GetSurfaceTextureUAV(Index);
+		}
+		Param.TwiddleFactorsTextureSRV = TwiddleFactorsPass->GetTwiddleFactorsTextureSRV();
+
+		FRHITexture* XDebugTextureRef = FFTOcean::GetRHITextureFromTextureReference(Packet.TransformDebugTextureX);
+		FRHITexture* YDebugTextureRef = FFTOcean::GetRHITextureFromTextureReference(Packet.TransformDebugTextureY);
+		FRHITexture* ZDebugTextureRef = FFTOcean::GetRHITextureFromTextureReference(Packet.TransformDebugTextureZ);
+
+		InverseTransformPass->Render(RHICmdList, InverseTransformPassConfig, Param, XDebugTextureRef, YDebugTextureRef, ZDebugTextureRef);
+	};
+
+	RenderFourierComponentPass();
+	RenderInverseTransformPass();
+}
+
+void FOceanPassChain::RenderSurface(FRHICommandListImmediate& RHICmdList, const FOceanRenderPacket& Packet)
+{
+	check(IsInRenderingThread());
+
+	// Analytic normals add the packed slope spectrum to the batch of inverse transforms
+	const bool bAnalyticNormals = Config.ComponentCount > OCEAN_SLOPE_COMPONENT_INDEX;
+
+	auto RenderSurfaceDisplacementPass = [bAnalyticNormals, &RHICmdList, &Packet, this]()
+	{
+		FSurfaceDisplacementPassParam Param;
+		InverseTransformPass->GetInverseTransformTextureSRVs(Param.InverseTransformTextureSRVs);
+		Param.bAnalyticNormals = bAnalyticNormals;
+		Param.NormalStrength = Packet.NormalStrength;
+
+		if (bAnalyticNormals)
+		{
+			SurfaceNormalPass->Prepare(SurfaceNormalPassConfig);
+			Param.NormalTextureUAV = SurfaceNormalPass->GetSurfaceNormalTextureUAV();
+		}
+
+		// Output maps are resolved with their whole mip chain once it has been generated
+		SurfaceDisplacementPass->Render(RHICmdList, SurfaceDisplacementPassConfig, Param, nullptr);
+	};
+
+	auto RenderSurfaceNormalPass = [&RHICmdList, &Packet, this]()
+	{
+		FSurfaceNormalPassParam Param;
+		Param.DisplacementTextureSRV = SurfaceDisplacementPass->GetSurfaceDisplacementTextureSRV();
+		Param.NormalStrength = Packet.NormalStrength;
+
+		SurfaceNormalPass->Render(RHICmdList, SurfaceNormalPassConfig, Param, nullptr);
+	};
+
+	auto RenderDisturbancePass = [&RHICmdList, &Packet, this]()
+	{
+		FDisturbancePassParam Param;
+		Param.DisturbanceSegments = Packet.DisturbanceSegments;
+		Param.DisturbanceShapes = Packet.DisturbanceShapes;
+		Param.NormalStrength = Packet.NormalStrength;
+		Param.DisplacementTexture = SurfaceDisplacementPass->GetSurfaceDisplacementTexture();
+		Param.DisplacementTextureSRV = SurfaceDisplacementPass->GetSurfaceDisplacementTextureSRV();
+		Param.NormalTexture = SurfaceNormalPass->GetSurfaceNormalTexture();
+		Param.NormalTextureSRV = SurfaceNormalPass->GetSurfaceNormalTextureSRV();
+
+		DisturbancePass->Render(RHICmdList, DisturbancePassConfig, Param);
+	};
+
+	auto RenderWaveStatisticsPass = [&RHICmdList, this]()
+	{
+		FWaveStatisticsPassParam Param;
+		Param.DisplacementTextureSRV = SurfaceDisplacementPass->GetSurfaceDisplacementTextureSRV();
+
+		WaveStatisticsPass->Render(RHICmdList, WaveStatisticsPassConfig, Param);
+	};
+
+	auto RenderSurfaceReadbackPass = [&RHICmdList, &Packet, this]()
+	{
+		if (!SurfaceReadbackPass)
+		{
+			SurfaceReadbackPass = MakeUnique<FSurfaceReadbackPass>();
+		}
+
+		FSurfaceReadbackPassParam Param;
+		Param.DisplacementTextureSRV = SurfaceDisplacementPass->GetSurfaceDisplacementTextureSRV();
+		Param.Timestamp = Packet.Timestamp;
+		Param.SnapshotPublisher = Packet.SnapshotPublisher.Get();
+
+		SurfaceReadbackPass->Render(RHICmdList, SurfaceReadbackPassConfig, Param);
+	};
+
+	auto RenderMipChainPass = [&RHICmdList, &Packet, this]()
+	{
+		FMipChainPassParam Param;
+		Param.DisplacementTexture = SurfaceDisplacementPass->GetSurfaceDisplacementTexture();
+		Param.NormalTexture = SurfaceNormalPass->GetSurfaceNormalTexture();
+
+		FRHITexture* DisplacementTargetRef = FFTOcean::GetRHITextureFromTextureReference(Packet.DisplacementMap);
+		FRHITexture* NormalTargetRef = FFTOcean::GetRHITextureFromTextureReference(Packet.NormalMap);
+
+		MipChainPass->Render(RHICmdList, MipChainPassConfig, Param, DisplacementTargetRef, NormalTargetRef);
+	};
+
+	RenderSurfaceDisplacementPass();
+
+	// Analytic normals are written by the displacement pass, so the Sobel pass and its dependency on the displacement map go away
+	if (!bAnalyticNormals)
+	{
+		RenderSurfaceNormalPass();
+	}
+
+	// Disturbances add onto finished normals, and the statistics include them so the bounds cover splashes too
+	RenderDisturbancePass();
+	RenderWaveStatisticsPass();
+
+	if (Packet.SnapshotPublisher)
+	{
+		RenderSurfaceReadbackPass();
+	}
+
+	RenderMipChainPass();
+}
+
+FBatchedTransformInstance FOceanPassChain::GetBatchedTransformInstance(const FOceanRenderPacket& Packet) const
+{
+	FBatchedTransformInstance Instance;
+	Instance.Time = Packet.Timestamp;
+	Instance.LoopPeriod = Packet.LoopPeriod;
+	Instance.SeaStateBlend = Packet.SeaStateBlend;
+
+	Instance.PhillipsFourierTextures[0] = PhillipsFourierPass->GetOutgoingPhillipsFourierTexture();
+	Instance.PhillipsFourierParams[0].WaveAmplitude = Packet.OutgoingSeaState.WaveAmplitude;
+	Instance.PhillipsFourierParams[0].WindSpeed = Packet.OutgoingSeaState.WindSpeed;
+
+	Instance.PhillipsFourierTextures[1] = PhillipsFourierPass->GetIncomingPhillipsFourierTexture();
+	Instance.PhillipsFourierParams[1].WaveAmplitude = Packet.IncomingSeaState.WaveAmplitude;
+	Instance.PhillipsFourierParams[1].WindSpeed = Packet.IncomingSeaState.WindSpeed;
+
+	for (uint32 Index = 0; Index < Config.ComponentCount; ++Index)
+	{
+		Instance.InverseTransformTextures[Index] = InverseTransformPass->GetInverseTransformTexture(Index);
+	}
+
+	return Instance;
+}
\ No newline at end of file
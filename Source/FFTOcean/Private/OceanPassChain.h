@@ -0,0 +1,111 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Pass/PhillipsFourierPass.h"
+#include "Pass/FourierComponentPass.h"
+#include "Pass/TwiddleFactorsPass.h"
+#include "Pass/InverseTransformPass.h"
+#include "Pass/SurfaceDisplacementPass.h"
+#include "Pass/SurfaceNormalPass.h"
+#include "Pass/DisturbancePass.h"
+#include "Pass/WaveStatisticsPass.h"
+#include "Pass/MipChainPass.h"
+#include "Pass/SurfaceReadbackPass.h"
+#include "Pass/BatchedTransformPass.h"
+
+struct FOceanRenderPacket;
+
+struct FOceanPassChainConfig
+{
+	uint32 TextureWidth;
+	uint32 TextureHeight;
+	uint32 ComponentCount;
+};
+
+bool operator==(const FOceanPassChainConfig& A, const FOceanPassChainConfig& B);
+bool operator!=(const FOceanPassChainConfig& A, const FOceanPassChainConfig& B);
+
+// Every pass of the simulation for one fixed configuration. A chain is never reconfigured; a new one is built
+// alongside it instead, so changing the resolution never stalls the chain that is rendering.
+class FOceanPassChain final
+{
+public:
+
+	explicit FOceanPassChain(const FOceanPassChainConfig& InConfig);
+	~FOceanPassChain();
+
+	FOceanPassChain(const FOceanPassChain&) = delete;
+	FOceanPassChain& operator=(const FOceanPassChain&) = delete;
+
+	// Creates the resources of the next pass, returns true once every pass is ready to render
+	bool PrepareNextPass(FRHICommandListImmediate& RHICmdList);
+
+	// Prepares every remaining pass at once and generates the spectra of the packet, so its first frame only runs
+	// the time dependent passes
+	void WarmUp(FRHICommandListImmediate& RHICmdList, const FOceanRenderPacket& Packet);
+
+	void Render(FRHICommandListImmediate& RHICmdList, const FOceanRenderPacket& Packet);
+
+	// Render without the transforms, for the batched backend to run them for several chains at once in between.
+	// The spectra are rendered first, the surface once the inverse transforms are back in this chain.
+	void RenderSpectra(FRHICommandListImmediate& RHICmdList, const FOceanRenderPacket& Packet);
+	void RenderSurface(FRHICommandListImmediate& RHICmdList, const FOceanRenderPacket& Packet);
+
+	// Only valid once RenderSpectra has run for the packet
+	FBatchedTransformInstance GetBatchedTransformInstance(const FOceanRenderPacket& Packet) const;
+
+	FORCEINLINE const FOceanPassChainConfig& GetConfig() const
+	{
+		return Config;
+	}
+
+	FORCEINLINE bool IsReady() const
+	{
+		return PreparedPassCount == PassCount;
+	}
+
+	FORCEINLINE FWaveStatisticsPassResult GetWaveStatistics() const
+	{
+		return WaveStatisticsPass->GetResult();
+	}
+
+	FORCEINLINE FShaderResourceViewRHIRef GetTwiddleFactorsTextureSRV() const
+	{
+		return TwiddleFactorsPass->GetTwiddleFactorsTextureSRV();
+	}
+
+private:
+
+	static constexpr uint32 PassCount = 9;
+
+	FOceanPassChainConfig Config;
+	uint32                PreparedPassCount;
+
+	FPhillipsFourierPassConfig     PhillipsFourierPassConfig;
+	FFourierComponentPassConfig    FourierComponentPassConfig;
+	FTwiddleFactorsPassConfig      TwiddleFactorsPassConfig;
+	FInverseTransformPassConfig    InverseTransformPassConfig;
+	FSurfaceDisplacementPassConfig SurfaceDisplacementPassConfig;
+	FSurfaceNormalPassConfig       SurfaceNormalPassConfig;
+	FDisturbancePassConfig         DisturbancePassConfig;
+	FWaveStatisticsPassConfig      WaveStatisticsPassConfig;
+	FMipChainPassConfig            MipChainPassConfig;
+	FSurfaceReadbackPassConfig     SurfaceReadbackPassConfig;
+
+	TUniquePtr<FPhillipsFourierPass>     PhillipsFourierPass;
+	TUniquePtr<FFourierComponentPass>    FourierComponentPass;
+	TUniquePtr<FTwiddleFactorsPass>      TwiddleFactorsPass;
+	TUniquePtr<FInverseTransformPass>    InverseTransformPass;
+	TUniquePtr<FSurfaceDisplacementPass> SurfaceDisplacementPass;
+	TUniquePtr<FSurfaceNormalPass>       SurfaceNormalPass;
+	TUniquePtr<FDisturbancePass>         DisturbancePass;
+	TUniquePtr<FWaveStatisticsPass>      WaveStatisticsPass;
+	TUniquePtr<FMipChainPass>            MipChainPass;
+
+	// Only created once the surface is read back
+	TUniquePtr<FSurfaceReadbackPass>     SurfaceReadbackPass;
+
+	void RenderTransforms(FRHICommandListImmediate& RHICmdList, const FOceanRenderPacket& Packet);
+};
\ No newline at end of file
@@ -0,0 +1,172 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "OceanPlaybackComponent.h"
+#include "FFTOcean.h"
+#include "OceanBounds.h"
+#include "OceanBakeStream.h"
+#include "OceanPlaybackProxy.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "Misc/Paths.h"
+
+UOceanPlaybackComponent::UOceanPlaybackComponent(const FObjectInitializer& ObjectInitializer) :
+	Super(ObjectInitializer)
+{
+	PrimaryComponentTick.bCanEverTick = true;
+
+	bTickInEditor = true;
+	bAutoActivate = true;
+
+	MaxDisplacement = FVector(200, 200, 300);
+
+	PlaybackRate = 1;
+	bLoop = true;
+	PlaybackTime = 0;
+}
+
+void UOceanPlaybackComponent::SetPlaybackTime(float InPlaybackTime)
+{
+	PlaybackTime = FMath::Max(InPlaybackTime, 0.0f);
+}
+
+float UOceanPlaybackComponent::GetPlaybackTime() const
+{
+	return PlaybackTime;
+}
+
+FBoxSphereBounds UOceanPlaybackComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+	return FFTOcean::ExpandBoundsByDisplacement(Super::CalcBounds(LocalToWorld), MaxDisplacement, LocalToWorld);
+}
+
+void UOceanPlaybackComponent::OnRegister()
+{
+	Super::OnRegister();
+
+	// Property edits re-register the component, which picks up a new bake file
+	CloseBakeStream();
+	OpenBakeStream();
+}
+
+void UOceanPlaybackComponent::OnUnregister()
+{
+	CloseBakeStream();
+
+	Super::OnUnregister();
+}
+
+void UOceanPlaybackComponent::OpenBakeStream()
+{
+	if (BakeFile.FilePath.IsEmpty())
+	{
+		return;
+	}
+
+	const FString Filename = FPaths::IsRelative(BakeFile.FilePath) ? FPaths::Combine(FPaths::ProjectDir(), BakeFile.FilePath) : BakeFile.FilePath;
+
+	TUniquePtr<FOceanBakeStream> Stream = MakeUnique<FOceanBakeStream>();
+	if (!Stream->Open(Filename))
+	{
+		return;
+	}
+
+	const FOceanBakeHeader& Header = Stream->GetHeader();
+
+	if (Header.TimeStep <= 0)
+	{
+		UE_LOG(LogFFTOcean, Warning, TEXT("%s has no timestep and can't be played back"), *Filename);
+		return;
+	}
+
+	BakeStream = MoveTemp(Stream);
+	PlaybackProxy = MakeShareable(new FOceanPlaybackProxy(Header.Width, Header.Height));
+}
+
+void UOceanPlaybackComponent::CloseBakeStream()
+{
+	BakeStream.Reset();
+
+	if (PlaybackProxy)
+	{
+		// Drop the last reference behind every command that may still use the proxy
+		ENQUEUE_RENDER_COMMAND(ReleaseOceanPlaybackProxyCommand)
+		(
+			[Proxy = MoveTemp(PlaybackProxy)](FRHICommandListImmediate& RHICmdList) mutable
+			{
+				Proxy.Reset();
+			}
+		);
+	}
+}
+
+void UOceanPlaybackComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (!BakeStream || !DisplacementMap || !NormalMap)
+	{
+		return;
+	}
+
+	const FOceanBakeHeader& Header = BakeStream->GetHeader();
+	const int32 FrameCount = Header.FrameCount;
+
+	PlaybackTime += DeltaTime * PlaybackRate;
+
+	int32 FrameA;
+	int32 FrameB;
+	float FrameBlend;
+
+	if (bLoop)
+	{
+		// Wrapping keeps the time precise however long the ocean plays
+		const int32 LoopFrameCount = BakeStream->GetLoopFrameCount();
+		PlaybackTime = FMath::Fmod(PlaybackTime, LoopFrameCount * Header.TimeStep);
+
+		const float FramePosition = PlaybackTime / Header.TimeStep;
+		FrameA = FMath::FloorToInt(FramePosition) % LoopFrameCount;
+		FrameB = (FrameA + 1) % LoopFrameCount;
+		FrameBlend = FMath::Frac(FramePosition);
+	}
+	else
+	{
+		PlaybackTime = FMath::Min(PlaybackTime, (FrameCount - 1) * Header.TimeStep);
+
+		const float FramePosition = PlaybackTime / Header.TimeStep;
+		FrameA = FMath::Min(FMath::FloorToInt(FramePosition), FrameCount - 1);
+		FrameB = FMath::Min(FrameA + 1, FrameCount - 1);
+		FrameBlend = FMath::Frac(FramePosition);
+	}
+
+	BakeStream->Prefetch(FrameA, bLoop);
+
+	// Frames are uploaded as soon as they are decoded, so reads ahead of playback are on the GPU before they are needed
+	int32 DecodedFrame;
+	TSharedPtr<const FOceanBakeFrameTexels, ESPMode::ThreadSafe> Texels;
+
+	while (BakeStream->TakeDecodedFrame(DecodedFrame, Texels))
+	{
+		ENQUEUE_RENDER_COMMAND(OceanPlaybackUploadCommand)
+		(
+			[Proxy = PlaybackProxy, DecodedFrame, Texels](FRHICommandListImmediate& RHICmdList)
+			{
+				Proxy->UploadFrame(DecodedFrame, Texels->Displacement, Texels->Normal);
+			}
+		);
+	}
+
+	FOceanPlaybackPacket Packet;
+	Packet.FrameA = FrameA;
+	Packet.FrameB = FrameB;
+	Packet.FrameBlend = FrameBlend;
+	Packet.DisplacementMap = FFTOcean::GetTextureReferenceFromTexture(DisplacementMap);
+	Packet.NormalMap = FFTOcean::GetTextureReferenceFromTexture(NormalMap);
+
+	ENQUEUE_RENDER_COMMAND(OceanPlaybackRenderCommand)
+	(
+		[Proxy = PlaybackProxy, Packet](FRHICommandListImmediate& RHICmdList)
+		{
+			Proxy->Render(RHICmdList, Packet);
+		}
+	);
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "OceanPlaybackProxy.h"
+
+FOceanPlaybackProxy::FOceanPlaybackProxy(uint32 InTextureWidth, uint32 InTextureHeight) :
+	TextureWidth(InTextureWidth),
+	TextureHeight(InTextureHeight)
+{
+	for (FStagingFrame& StagingFrame : StagingFrames)
+	{
+		StagingFrame.Frame = INDEX_NONE;
+	}
+}
+
+FOceanPlaybackProxy::~FOceanPlaybackProxy()
+{
+	check(IsInRenderingThread());
+}
+
+void FOceanPlaybackProxy::UploadFrame(int32 Frame, const TArray<FFloat16Color>& Displacement, const TArray<FFloat16Color>& Normal)
+{
+	check(IsInRenderingThread());
+	const int32 TexelCount = StaticCast<int32>(TextureWidth * TextureHeight);
+	check(Displacement.Num() == TexelCount && Normal.Num() == TexelCount);
+
+	// Same slot as the frame has in the stream ring, so a slot is only overwritten once its frame has left playback
+	FStagingFrame& StagingFrame = StagingFrames[Frame % OCEAN_BAKE_STREAM_RING_SIZE];
+
+	if (!StagingFrame.DisplacementTexture)
+	{
+		FRHIResourceCreateInfo CreateInfo;
+		StagingFrame.DisplacementTexture = RHICreateTexture2D(TextureWidth, TextureHeight, PF_FloatRGBA, 1, 1, TexCreate_ShaderResource, CreateInfo);
+		StagingFrame.NormalTexture = RHICreateTexture2D(TextureWidth, TextureHeight, PF_FloatRGBA, 1, 1, TexCreate_ShaderResource, CreateInfo);
+	}
+
+	const FUpdateTextureRegion2D Region(0, 0, 0, 0, TextureWidth, TextureHeight);
+	const uint32 SourcePitch = TextureWidth * sizeof(FFloat16Color);
+
+	RHIUpdateTexture2D(StagingFrame.DisplacementTexture, 0, Region, SourcePitch, reinterpret_cast<const uint8*>(Displacement.GetData()));
+	RHIUpdateTexture2D(StagingFrame.NormalTexture, 0, Region, SourcePitch, reinterpret_cast<const uint8*>(Normal.GetData()));
+
+	StagingFrame.Frame = Frame;
+}
+
+void FOceanPlaybackProxy::Render(FRHICommandListImmediate& RHICmdList, const FOceanPlaybackPacket& Packet)
+{
+	check(IsInRenderingThread());
+
+	const FStagingFrame* StagingFrameA = FindStagingFrame(Packet.FrameA);
+	const FStagingFrame* StagingFrameB = FindStagingFrame(Packet.FrameB);
+
+	if (!StagingFrameA || !StagingFrameB)
+	{
+		return;
+	}
+
+	FStreamPlaybackPassConfig PassConfig;
+	PassConfig.TextureWidth = TextureWidth;
+	PassConfig.TextureHeight = TextureHeight;
+
+	FStreamPlaybackPassParam Param;
+	Param.DisplacementFrameA = StagingFrameA->DisplacementTexture;
+	Param.DisplacementFrameB = StagingFrameB->DisplacementTexture;
+	Param.NormalFrameA = StagingFrameA->NormalTexture;
+	Param.NormalFrameB = StagingFrameB->NormalTexture;
+	Param.FrameBlend = Packet.FrameBlend;
+
+	StreamPlaybackPass.Render(RHICmdList, PassConfig, Param);
+
+	FMipChainPassConfig MipChainPassConfig;
+	MipChainPassConfig.TextureWidth = TextureWidth;
+	MipChainPassConfig.TextureHeight = TextureHeight;
+
+	FMipChainPassParam MipChainParam;
+	MipChainParam.DisplacementTexture = StreamPlaybackPass.GetDisplacementTexture();
+	MipChainParam.NormalTexture = StreamPlaybackPass.GetNormalTexture();
+
+	FRHITexture* DisplacementTargetRef = FFTOcean::GetRHITextureFromTextureReference(Packet.DisplacementMap);
+	FRHITexture* NormalTargetRef = FFTOcean::GetRHITextureFromTextureReference(Packet.NormalMap);
+
+	MipChainPass.Render(RHICmdList, MipChainPassConfig, MipChainParam, DisplacementTargetRef, NormalTargetRef);
+}
+
+const FOceanPlaybackProxy::FStagingFrame* FOceanPlaybackProxy::FindStagingFrame(int32 Frame) const
+{
+	const FStagingFrame& StagingFrame = StagingFrames[Frame % OCEAN_BAKE_STREAM_RING_SIZE];
+	return StagingFrame.Frame == Frame ? &StagingFrame : nullptr;
+}
\ No newline at end of file
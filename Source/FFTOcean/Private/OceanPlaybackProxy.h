@@ -0,0 +1,55 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OceanBakeStream.h"
+#include "Pass/StreamPlaybackPass.h"
+#include "Pass/MipChainPass.h"
+
+struct FOceanPlaybackPacket
+{
+	int32 FrameA;
+	int32 FrameB;
+	float FrameBlend;
+
+	FTextureReferenceRHIRef DisplacementMap;
+	FTextureReferenceRHIRef NormalMap;
+};
+
+// Render thread side of a streamed ocean. Decoded frames are uploaded into a ring of staging textures that mirrors
+// the stream ring, the two frames around the playback time are then blended into the output maps.
+class FOceanPlaybackProxy final
+{
+public:
+
+	FOceanPlaybackProxy(uint32 InTextureWidth, uint32 InTextureHeight);
+	~FOceanPlaybackProxy();
+
+	FOceanPlaybackProxy(const FOceanPlaybackProxy&) = delete;
+	FOceanPlaybackProxy& operator=(const FOceanPlaybackProxy&) = delete;
+
+	void UploadFrame(int32 Frame, const TArray<FFloat16Color>& Displacement, const TArray<FFloat16Color>& Normal);
+
+	// Keeps the previous output while either frame hasn't been uploaded yet
+	void Render(FRHICommandListImmediate& RHICmdList, const FOceanPlaybackPacket& Packet);
+
+private:
+
+	struct FStagingFrame
+	{
+		int32            Frame;
+		FTexture2DRHIRef DisplacementTexture;
+		FTexture2DRHIRef NormalTexture;
+	};
+
+	uint32 TextureWidth;
+	uint32 TextureHeight;
+
+	FStagingFrame StagingFrames[OCEAN_BAKE_STREAM_RING_SIZE];
+
+	FStreamPlaybackPass StreamPlaybackPass;
+	FMipChainPass       MipChainPass;
+
+	const FStagingFrame* FindStagingFrame(int32 Frame) const;
+};
\ No newline at end of file
@@ -0,0 +1,319 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "OceanRaycast.h"
+#include "OceanSurfaceSnapshot.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+	// Rays traced by one parallel task of the batched ray cast
+	constexpr int32 RaycastBatchSize = 64;
+
+	// Cells a single ray may visit before it is given up on, only grazing rays over many patches get close
+	constexpr int32 MaxRaycastStepCount = 1 << 16;
+
+	// Pushes the ray past a cell border, as a fraction of a texel
+	constexpr float CellExitBias = 1e-3f;
+
+	// Smallest root of A + B * S + C * S^2 in [0, MaxS], if any
+	bool SolveQuadratic(float A, float B, float C, float MaxS, float& OutS)
+	{
+		if (FMath::Abs(C) < KINDA_SMALL_NUMBER)
+		{
+			if (FMath::Abs(B) < KINDA_SMALL_NUMBER)
+			{
+				return false;
+			}
+
+			const float S = -A / B;
+			OutS = S;
+			return S >= 0 && S <= MaxS;
+		}
+
+		const float Discriminant = B * B - 4 * A * C;
+		if (Discriminant < 0)
+		{
+			return false;
+		}
+
+		const float SqrtDiscriminant = FMath::Sqrt(Discriminant);
+		float S0 = (-B - SqrtDiscriminant) / (2 * C);
+		float S1 = (-B + SqrtDiscriminant) / (2 * C);
+
+		if (S0 > S1)
+		{
+			Swap(S0, S1);
+		}
+
+		if (S0 >= 0 && S0 <= MaxS)
+		{
+			OutS = S0;
+			return true;
+		}
+
+		if (S1 >= 0 && S1 <= MaxS)
+		{
+			OutS = S1;
+			return true;
+		}
+
+		return false;
+	}
+}
+
+FOceanHeightPyramid::FOceanHeightPyramid(const FOceanSurfaceSnapshot& Snapshot) :
+	Time(Snapshot.GetTime()),
+	Width(Snapshot.GetWidth()),
+	Height(Snapshot.GetHeight()),
+	TexelLength(Snapshot.GetTexelLength())
+{
+	Heights.SetNumUninitialized(Width * Height);
+
+	// Resample once so traversal and refinement work on a plain height field
+	ParallelFor(Height, [this, &Snapshot](int32 Y)
+	{
+		for (int32 X = 0; X < Width; ++X)
+		{
+			Heights[Y * Width + X] = Snapshot.SampleHeight(FVector2D(X * TexelLength.X, Y * TexelLength.Y));
+		}
+	});
+
+	BuildLevels();
+}
+
+void FOceanHeightPyramid::BuildLevels()
+{
+	FLevel BaseLevel;
+	BaseLevel.Width = Width;
+	BaseLevel.Height = Height;
+	BaseLevel.CellLength = TexelLength;
+	BaseLevel.Ranges.SetNumUninitialized(Width * Height);
+
+	// A bilinear patch never leaves the range of its four corners
+	for (int32 Y = 0; Y < Height; ++Y)
+	{
+		for (int32 X = 0; X < Width; ++X)
+		{
+			const float H00 = GetTexelHeight(X, Y);
+			const float H10 = GetTexelHeight(X + 1, Y);
+			const float H01 = GetTexelHeight(X, Y + 1);
+			const float H11 = GetTexelHeight(X + 1, Y + 1);
+
+			FHeightRange& Range = BaseLevel.Ranges[Y * Width + X];
+			Range.Min = FMath::Min(FMath::Min(H00, H10), FMath::Min(H01, H11));
+			Range.Max = FMath::Max(FMath::Max(H00, H10), FMath::Max(H01, H11));
+		}
+	}
+
+	Levels.Add(MoveTemp(BaseLevel));
+
+	// Halve each axis until a single cell covers the whole patch, a non square patch keeps one cell along its short side
+	while (Levels.Last().Width > 1 || Levels.Last().Height > 1)
+	{
+		const FLevel& Child = Levels.Last();
+
+		FLevel Level;
+		Level.Width = FMath::Max(Child.Width / 2, 1);
+		Level.Height = FMath::Max(Child.Height / 2, 1);
+		Level.CellLength = FVector2D(TexelLength.X * Width / Level.Width, TexelLength.Y * Height / Level.Height);
+		Level.Ranges.SetNumUninitialized(Level.Width * Level.Height);
+
+		const int32 ChildCountX = Child.Width / Level.Width;
+		const int32 ChildCountY = Child.Height / Level.Height;
+
+		for (int32 Y = 0; Y < Level.Height; ++Y)
+		{
+			for (int32 X = 0; X < Level.Width; ++X)
+			{
+				FHeightRange Range = GetRange(Child, X * ChildCountX, Y * ChildCountY);
+
+				for (int32 ChildY = 0; ChildY < ChildCountY; ++ChildY)
+				{
+					for (int32 ChildX = 0; ChildX < ChildCountX; ++ChildX)
+					{
+						const FHeightRange& ChildRange = GetRange(Child, X * ChildCountX + ChildX, Y * ChildCountY + ChildY);
+						Range.Min = FMath::Min(Range.Min, ChildRange.Min);
+						Range.Max = FMath::Max(Range.Max, ChildRange.Max);
+					}
+				}
+
+				Level.Ranges[Y * Level.Width + X] = Range;
+			}
+		}
+
+		Levels.Add(MoveTemp(Level));
+	}
+}
+
+float FOceanHeightPyramid::SampleHeight(const FVector2D& Location) const
+{
+	const float U = Location.X / TexelLength.X;
+	const float V = Location.Y / TexelLength.Y;
+
+	const int32 X = FMath::FloorToInt(U);
+	const int32 Y = FMath::FloorToInt(V);
+
+	const float FracU = U - X;
+	const float FracV = V - Y;
+
+	const float Top = FMath::Lerp(GetTexelHeight(X, Y), GetTexelHeight(X + 1, Y), FracU);
+	const float Bottom = FMath::Lerp(GetTexelHeight(X, Y + 1), GetTexelHeight(X + 1, Y + 1), FracU);
+
+	return FMath::Lerp(Top, Bottom, FracV);
+}
+
+bool FOceanHeightPyramid::IntersectCell(int32 CellX, int32 CellY, const FVector& Origin, const FVector& Direction, float EnterDistance, float ExitDistance, float& OutDistance) const
+{
+	const float H00 = GetTexelHeight(CellX, CellY);
+	const float H10 = GetTexelHeight(CellX + 1, CellY);
+	const float H01 = GetTexelHeight(CellX, CellY + 1);
+	const float H11 = GetTexelHeight(CellX + 1, CellY + 1);
+
+	// Bilinear height H00 + A * U + B * V + C * U * V over the cell
+	const float A = H10 - H00;
+	const float B = H01 - H00;
+	const float C = H00 - H10 - H01 + H11;
+
+	// Parameterized from the cell entry, so far away rays keep their precision
+	const FVector Enter = Origin + Direction * EnterDistance;
+	const float U0 = Enter.X / TexelLength.X - CellX;
+	const float V0 = Enter.Y / TexelLength.Y - CellY;
+	const float DU = Direction.X / TexelLength.X;
+	const float DV = Direction.Y / TexelLength.Y;
+
+	// Ray height minus surface height, as a quadratic of the distance S past the entry
+	const float F0 = Enter.Z - (H00 + A * U0 + B * V0 + C * U0 * V0);
+	const float F1 = Direction.Z - (A * DU + B * DV + C * (U0 * DV + V0 * DU));
+	const float F2 = -C * DU * DV;
+
+	if (F0 <= 0)
+	{
+		OutDistance = EnterDistance;
+		return true;
+	}
+
+	float S;
+	if (SolveQuadratic(F0, F1, F2, ExitDistance - EnterDistance, S))
+	{
+		OutDistance = EnterDistance + S;
+		return true;
+	}
+
+	return false;
+}
+
+bool FOceanHeightPyramid::RaycastOcean(const FVector& Origin, const FVector& Direction, float MaxDistance, FOceanRaycastHit& OutHit) const
+{
+	OutHit = FOceanRaycastHit();
+
+	const FVector RayDirection = Direction.GetSafeNormal();
+	if (RayDirection.IsZero() || MaxDistance < 0)
+	{
+		return false;
+	}
+
+	auto ReportHit = [&OutHit, &Origin, &RayDirection](float Distance)
+	{
+		OutHit.bHit = true;
+		OutHit.Distance = Distance;
+		OutHit.Location = Origin + RayDirection * Distance;
+		return true;
+	};
+
+	if (Origin.Z <= SampleHeight(FVector2D(Origin)))
+	{
+		return ReportHit(0);
+	}
+
+	// Clip the ray to the height range of the whole surface
+	const FHeightRange& RootRange = Levels.Last().Ranges[0];
+
+	float Distance = 0;
+	float EndDistance = MaxDistance;
+
+	if (FMath::Abs(RayDirection.Z) > KINDA_SMALL_NUMBER)
+	{
+		const float MaxPlaneDistance = (RootRange.Max - Origin.Z) / RayDirection.Z;
+		const float MinPlaneDistance = (RootRange.Min - Origin.Z) / RayDirection.Z;
+
+		Distance = FMath::Max(Distance, FMath::Min(MaxPlaneDistance, MinPlaneDistance));
+		EndDistance = FMath::Min(EndDistance, FMath::Max(MaxPlaneDistance, MinPlaneDistance));
+	}
+	else if (Origin.Z > RootRange.Max)
+	{
+		return false;
+	}
+
+	const float ExitBias = CellExitBias * FMath::Min(TexelLength.X, TexelLength.Y);
+	const int32 TopLevel = Levels.Num() - 1;
+	int32 LevelIndex = TopLevel;
+
+	for (int32 Step = 0; Step < MaxRaycastStepCount && Distance <= EndDistance; ++Step)
+	{
+		const FLevel& Level = Levels[LevelIndex];
+		const FVector Location = Origin + RayDirection * Distance;
+
+		const int32 CellX = FMath::FloorToInt(Location.X / Level.CellLength.X);
+		const int32 CellY = FMath::FloorToInt(Location.Y / Level.CellLength.Y);
+
+		// Distance at which the ray leaves the cell
+		float ExitDistance = EndDistance;
+
+		if (RayDirection.X != 0)
+		{
+			const float BorderX = (RayDirection.X > 0 ? CellX + 1 : CellX) * Level.CellLength.X;
+			ExitDistance = FMath::Min(ExitDistance, (BorderX - Origin.X) / RayDirection.X);
+		}
+
+		if (RayDirection.Y != 0)
+		{
+			const float BorderY = (RayDirection.Y > 0 ? CellY + 1 : CellY) * Level.CellLength.Y;
+			ExitDistance = FMath::Min(ExitDistance, (BorderY - Origin.Y) / RayDirection.Y);
+		}
+
+		ExitDistance = FMath::Max(ExitDistance, Distance);
+
+		// The ray starts above the surface, so it can only hit a cell whose top it dips under
+		const float LowestRayZ = Origin.Z + RayDirection.Z * (RayDirection.Z < 0 ? ExitDistance : Distance);
+
+		if (LowestRayZ <= GetRange(Level, CellX, CellY).Max)
+		{
+			if (LevelIndex > 0)
+			{
+				--LevelIndex;
+				continue;
+			}
+
+			float HitDistance;
+			if (IntersectCell(CellX, CellY, Origin, RayDirection, Distance, ExitDistance, HitDistance))
+			{
+				return ReportHit(HitDistance);
+			}
+		}
+
+		// Skip the cell, then try a coarser level for the next one
+		Distance = ExitDistance + ExitBias;
+		LevelIndex = FMath::Min(LevelIndex + 1, TopLevel);
+	}
+
+	return false;
+}
+
+void FOceanHeightPyramid::RaycastOcean(TArrayView<const FOceanRay> Rays, TArrayView<FOceanRaycastHit> OutHits) const
+{
+	check(Rays.Num() == OutHits.Num());
+
+	const int32 BatchCount = FMath::DivideAndRoundUp(Rays.Num(), RaycastBatchSize);
+
+	ParallelFor(BatchCount, [this, &Rays, &OutHits](int32 Batch)
+	{
+		const int32 First = Batch * RaycastBatchSize;
+		const int32 Last = FMath::Min(First + RaycastBatchSize, Rays.Num());
+
+		for (int32 Index = First; Index < Last; ++Index)
+		{
+			const FOceanRay& Ray = Rays[Index];
+			RaycastOcean(Ray.Origin, Ray.Direction, Ray.MaxDistance, OutHits[Index]);
+		}
+	});
+}
\ No newline at end of file
@@ -0,0 +1,220 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "OceanRenderBatch.h"
+#include "FFTOcean.h"
+
+DECLARE_CYCLE_STAT(TEXT("Render Ocean Batch"), STAT_FFTOcean_RenderBatch, STATGROUP_FFTOcean);
+
+namespace
+{
+	// Flushes a batched transform pass is kept for without oceans of its size, so throttled oceans don't thrash it
+	constexpr uint32 UnusedTransformPassReleaseDelay = 120;
+
+	bool HasTransformDebugTextures(const FOceanRenderPacket& Packet)
+	{
+		return Packet.PhillipsFourierPassDebugTexture
+			|| Packet.SurfaceDebugTextureX
+			|| Packet.SurfaceDebugTextureY
+			|| Packet.SurfaceDebugTextureZ
+			|| Packet.TwiddleFactorsDebugTexture
+			|| Packet.TransformDebugTextureX
+			|| Packet.TransformDebugTextureY
+			|| Packet.TransformDebugTextureZ;
+	}
+
+	bool IsSameChainConfig(const FOceanPassChainConfig& A, const FOceanPassChainConfig& B)
+	{
+		return A.TextureWidth == B.TextureWidth && A.TextureHeight == B.TextureHeight && A.ComponentCount == B.ComponentCount;
+	}
+}
+
+FOceanRenderBatch::FOceanRenderBatch() :
+	FlushIndex(0)
+{
+}
+
+FOceanRenderBatch& FOceanRenderBatch::Get()
+{
+	check(IsInRenderingThread());
+
+	static FOceanRenderBatch Batch;
+	return Batch;
+}
+
+void FOceanRenderBatch::Add(FRHICommandListImmediate& RHICmdList, const TSharedPtr<FOceanRenderProxy, ESPMode::ThreadSafe>& Proxy, const FOceanRenderPacket& Packet)
+{
+	check(IsInRenderingThread());
+
+	const bool bQueued = QueuedOceans.ContainsByPredicate([&Proxy](const FQueuedOcean& QueuedOcean)
+	{
+		return QueuedOcean.Proxy == Proxy;
+	});
+
+	if (bQueued)
+	{
+		Flush(RHICmdList);
+	}
+
+	FQueuedOcean& QueuedOcean = QueuedOceans.AddDefaulted_GetRef();
+	QueuedOcean.Proxy = Proxy;
+	QueuedOcean.Packet = Packet;
+}
+
+void FOceanRenderBatch::Flush(FRHICommandListImmediate& RHICmdList)
+{
+	check(IsInRenderingThread());
+
+	SCOPE_CYCLE_COUNTER(STAT_FFTOcean_RenderBatch);
+
+	++FlushIndex;
+
+	TArray<FBatchedOcean> BatchedOceans;
+	BatchedOceans.Reserve(QueuedOceans.Num());
+
+	// Flipbooks and Gerstner waves are rendered right away, the debug textures need the passes of the ocean itself
+	for (FQueuedOcean& QueuedOcean : QueuedOceans)
+	{
+		FOceanPassChain* Chain = QueuedOcean.Proxy->PrepareRender(RHICmdList, QueuedOcean.Packet);
+
+		if (!Chain)
+		{
+			continue;
+		}
+
+		if (HasTransformDebugTextures(QueuedOcean.Packet))
+		{
+			QueuedOcean.Proxy->RenderChain(RHICmdList, QueuedOcean.Packet);
+			continue;
+		}
+
+		FBatchedOcean& BatchedOcean = BatchedOceans.AddDefaulted_GetRef();
+		BatchedOcean.Proxy = QueuedOcean.Proxy.Get();
+		BatchedOcean.Chain = Chain;
+		BatchedOcean.Packet = &QueuedOcean.Packet;
+	}
+
+	// Oceans of the same size and component count end up next to each other
+	BatchedOceans.StableSort([](const FBatchedOcean& A, const FBatchedOcean& B)
+	{
+		const FOceanPassChainConfig& ConfigA = A.Chain->GetConfig();
+		const FOceanPassChainConfig& ConfigB = B.Chain->GetConfig();
+
+		if (ConfigA.TextureWidth != ConfigB.TextureWidth)
+		{
+			return ConfigA.TextureWidth < ConfigB.TextureWidth;
+		}
+
+		if (ConfigA.TextureHeight != ConfigB.TextureHeight)
+		{
+			return ConfigA.TextureHeight < ConfigB.TextureHeight;
+		}
+
+		return ConfigA.ComponentCount < ConfigB.ComponentCount;
+	});
+
+	int32 GroupStart = 0;
+
+	while (GroupStart < BatchedOceans.Num())
+	{
+		const FOceanPassChainConfig& GroupConfig = BatchedOceans[GroupStart].Chain->GetConfig();
+
+		int32 GroupEnd = GroupStart + 1;
+		while (GroupEnd < BatchedOceans.Num()
+			&& GroupEnd - GroupStart < OCEAN_MAX_BATCH_INSTANCE_COUNT
+			&& IsSameChainConfig(BatchedOceans[GroupEnd].Chain->GetConfig(), GroupConfig))
+		{
+			++GroupEnd;
+		}
+
+		RenderBatch(RHICmdList, TArrayView<const FBatchedOcean>(BatchedOceans.GetData() + GroupStart, GroupEnd - GroupStart));
+
+		GroupStart = GroupEnd;
+	}
+
+	// Proxies of destroyed oceans are released here, still on the render thread
+	QueuedOceans.Reset();
+
+	ReleaseUnusedTransformPasses();
+}
+
+void FOceanRenderBatch::Release()
+{
+	check(IsInRenderingThread());
+
+	QueuedOceans.Empty();
+	TransformPasses.Empty();
+}
+
+void FOceanRenderBatch::RenderBatch(FRHICommandListImmediate& RHICmdList, TArrayView<const FBatchedOcean> Oceans)
+{
+	// Copying a lone ocean in and out of a texture array would only cost more than its own transform
+	if (Oceans.Num() == 1)
+	{
+		Oceans[0].Proxy->RenderChain(RHICmdList, *Oceans[0].Packet);
+		return;
+	}
+
+	TArray<FBatchedTransformInstance, TInlineAllocator<OCEAN_MAX_BATCH_INSTANCE_COUNT>> Instances;
+
+	for (const FBatchedOcean& Ocean : Oceans)
+	{
+		Ocean.Chain->RenderSpectra(RHICmdList, *Ocean.Packet);
+		Instances.Add(Ocean.Chain->GetBatchedTransformInstance(*Ocean.Packet));
+	}
+
+	FTransformPassEntry& TransformPass = FindOrAddTransformPass(Oceans[0].Chain->GetConfig(), Oceans.Num());
+
+	FBatchedTransformPassParam Param;
+	Param.Instances = Instances;
+	Param.TwiddleFactorsTextureSRV = Oceans[0].Chain->GetTwiddleFactorsTextureSRV();
+
+	TransformPass.GpuTimer.Begin(RHICmdList);
+	TransformPass.Pass->Render(RHICmdList, TransformPass.Config, Param);
+	TransformPass.GpuTimer.End(RHICmdList);
+
+	// Every ocean of the batch pays an equal share of the transforms
+	const float SharedGpuTime = TransformPass.GpuTimer.GetTime() / Oceans.Num();
+
+	for (const FBatchedOcean& Ocean : Oceans)
+	{
+		Ocean.Proxy->RenderChainSurface(RHICmdList, *Ocean.Packet, SharedGpuTime);
+	}
+}
+
+FOceanRenderBatch::FTransformPassEntry& FOceanRenderBatch::FindOrAddTransformPass(const FOceanPassChainConfig& ChainConfig, uint32 InstanceCount)
+{
+	FTransformPassEntry* Entry = TransformPasses.FindByPredicate([&ChainConfig](const FTransformPassEntry& TransformPass)
+	{
+		return TransformPass.Config.TextureWidth == ChainConfig.TextureWidth
+			&& TransformPass.Config.TextureHeight == ChainConfig.TextureHeight
+			&& TransformPass.Config.ComponentCount == ChainConfig.ComponentCount;
+	});
+
+	if (!Entry)
+	{
+		Entry = &TransformPasses.AddDefaulted_GetRef();
+		Entry->Config.TextureWidth = ChainConfig.TextureWidth;
+		Entry->Config.TextureHeight = ChainConfig.TextureHeight;
+		Entry->Config.ComponentCount = ChainConfig.ComponentCount;
+		Entry->Config.InstanceCount = 0;
+		Entry->Pass = MakeUnique<FBatchedTransformPass>();
+	}
+
+	// Arrays only grow, in powers of two, so oceans coming and going don't reallocate them every frame
+	if (InstanceCount > Entry->Config.InstanceCount)
+	{
+		Entry->Config.InstanceCount = FMath::Min<uint32>(FMath::RoundUpToPowerOfTwo(InstanceCount), OCEAN_MAX_BATCH_INSTANCE_COUNT);
+	}
+
+	Entry->LastFlushIndex = FlushIndex;
+
+	return *Entry;
+}
+
+void FOceanRenderBatch::ReleaseUnusedTransformPasses()
+{
+	TransformPasses.RemoveAll([this](const FTransformPassEntry& TransformPass)
+	{
+		return FlushIndex - TransformPass.LastFlushIndex >= UnusedTransformPassReleaseDelay;
+	});
+}
\ No newline at end of file
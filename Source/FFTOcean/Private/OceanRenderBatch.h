@@ -0,0 +1,60 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OceanRenderProxy.h"
+#include "Pass/BatchedTransformPass.h"
+
+// Render thread side of the batched backend. Oceans rendered with r.FFTOcean.Batching queue their packets here, and
+// each flush transforms every queued ocean of the same size in one dispatch chain over texture array slices.
+class FOceanRenderBatch final
+{
+public:
+
+	FOceanRenderBatch();
+
+	// Render thread only
+	static FOceanRenderBatch& Get();
+
+	// Queues the packet until the next flush. A second packet for the same ocean flushes the batch first, so the
+	// frames of an ocean are never reordered.
+	void Add(FRHICommandListImmediate& RHICmdList, const TSharedPtr<FOceanRenderProxy, ESPMode::ThreadSafe>& Proxy, const FOceanRenderPacket& Packet);
+
+	void Flush(FRHICommandListImmediate& RHICmdList);
+
+	// Drops the queued packets and the transform resources, for module shutdown
+	void Release();
+
+private:
+
+	struct FQueuedOcean
+	{
+		TSharedPtr<FOceanRenderProxy, ESPMode::ThreadSafe> Proxy;
+		FOceanRenderPacket                                 Packet;
+	};
+
+	struct FBatchedOcean
+	{
+		FOceanRenderProxy*        Proxy;
+		FOceanPassChain*          Chain;
+		const FOceanRenderPacket* Packet;
+	};
+
+	struct FTransformPassEntry
+	{
+		FBatchedTransformPassConfig       Config;
+		TUniquePtr<FBatchedTransformPass> Pass;
+		FOceanGpuTimer                    GpuTimer;
+		uint32                            LastFlushIndex;
+	};
+
+	TArray<FQueuedOcean>        QueuedOceans;
+	TArray<FTransformPassEntry> TransformPasses;
+	uint32                      FlushIndex;
+
+	void RenderBatch(FRHICommandListImmediate& RHICmdList, TArrayView<const FBatchedOcean> Oceans);
+
+	FTransformPassEntry& FindOrAddTransformPass(const FOceanPassChainConfig& ChainConfig, uint32 InstanceCount);
+	void ReleaseUnusedTransformPasses();
+};
\ No newline at end of file
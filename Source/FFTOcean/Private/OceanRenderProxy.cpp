@@ -0,0 +1,332 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "OceanRenderProxy.h"
+#include "FFTOcean.h"
+
+DECLARE_CYCLE_STAT(TEXT("Render Ocean"), STAT_FFTOcean_Render, STATGROUP_FFTOcean);
+DECLARE_CYCLE_STAT(TEXT("Warm Up Ocean"), STAT_FFTOcean_WarmUp, STATGROUP_FFTOcean);
+
+namespace
+{
+	// Frames a replaced chain is kept alive for, enough for the GPU to retire every frame that used it
+	constexpr uint32 RetiredChainReleaseDelay = 3;
+
+	// Proxies holding retired chains, render thread only. Oceans that stop rendering still release theirs.
+	TSet<FOceanRenderProxy*> ProxiesWithRetiredChains;
+
+	bool RunsTransform(const FOceanRenderPacket& Packet)
+	{
+		return !(Packet.DisplacementFlipbook && Packet.NormalFlipbook) && Packet.GerstnerWaves.Num() == 0;
+	}
+
+	FOceanPassChainConfig GetChainConfig(const FOceanRenderPacket& Packet)
+	{
+		FOceanPassChainConfig ChainConfig;
+		ChainConfig.TextureWidth = Packet.TextureWidth;
+		ChainConfig.TextureHeight = Packet.TextureHeight;
+		// Analytic normals add the packed slope spectrum to the batch of inverse transforms
+		ChainConfig.ComponentCount = Packet.bAnalyticNormals ? OCEAN_FOURIER_COMPONENT_COUNT : OCEAN_SLOPE_COMPONENT_INDEX;
+
+		return ChainConfig;
+	}
+}
+
+FOceanRenderProxy::FOceanRenderProxy() :
+	GpuTime(0),
+	ActiveTextureSize(FIntPoint::ZeroValue)
+{
+	FMemory::Memzero(WaveStatistics);
+}
+
+FOceanRenderProxy::~FOceanRenderProxy()
+{
+	// Pass resources are released by the pass destructors, which must not race a frame in flight
+	check(IsInRenderingThread());
+
+	ProxiesWithRetiredChains.Remove(this);
+}
+
+void FOceanRenderProxy::Render(FRHICommandListImmediate& RHICmdList, const FOceanRenderPacket& Packet)
+{
+	check(IsInRenderingThread());
+
+	SCOPE_CYCLE_COUNTER(STAT_FFTOcean_Render);
+
+	if (PrepareRender(RHICmdList, Packet))
+	{
+		RenderChain(RHICmdList, Packet);
+	}
+}
+
+void FOceanRenderProxy::WarmUp(FRHICommandListImmediate& RHICmdList, const FOceanRenderPacket& Packet)
+{
+	check(IsInRenderingThread());
+
+	SCOPE_CYCLE_COUNTER(STAT_FFTOcean_WarmUp);
+
+	ReleaseRetiredChains();
+
+	if (!RunsTransform(Packet))
+	{
+		return;
+	}
+
+	const FOceanPassChainConfig ChainConfig = GetChainConfig(Packet);
+
+	if (!ActiveChain)
+	{
+		ActiveChain = MakeUnique<FOceanPassChain>(ChainConfig);
+	}
+
+	if (ActiveChain->GetConfig() == ChainConfig)
+	{
+		ActiveChain->WarmUp(RHICmdList, Packet);
+		return;
+	}
+
+	// The active chain keeps rendering, PrepareRender swaps in the warm chain on the next frame
+	if (PendingChain && PendingChain->GetConfig() != ChainConfig)
+	{
+		RetireChain(MoveTemp(PendingChain));
+	}
+
+	if (!PendingChain)
+	{
+		PendingChain = MakeUnique<FOceanPassChain>(ChainConfig);
+	}
+
+	PendingChain->WarmUp(RHICmdList, Packet);
+}
+
+FOceanPassChain* FOceanRenderProxy::PrepareRender(FRHICommandListImmediate& RHICmdList, const FOceanRenderPacket& Packet)
+{
+	check(IsInRenderingThread());
+
+	ReleaseRetiredChains();
+
+	if (Packet.DisplacementFlipbook && Packet.NormalFlipbook)
+	{
+		RenderFlipbookPlayback(RHICmdList, Packet);
+		return nullptr;
+	}
+
+	if (Packet.GerstnerWaves.Num() > 0)
+	{
+		RenderGerstnerWaves(RHICmdList, Packet);
+		return nullptr;
+	}
+
+	const FOceanPassChainConfig ChainConfig = GetChainConfig(Packet);
+
+	if (!ActiveChain)
+	{
+		// Nothing is on screen yet, so the first chain is built in one go
+		ActiveChain = MakeUnique<FOceanPassChain>(ChainConfig);
+
+		while (!ActiveChain->PrepareNextPass(RHICmdList))
+		{
+		}
+	}
+	else if (ActiveChain->GetConfig() != ChainConfig)
+	{
+		// The configuration changed again before the pending chain was finished
+		if (PendingChain && PendingChain->GetConfig() != ChainConfig)
+		{
+			RetireChain(MoveTemp(PendingChain));
+		}
+
+		if (!PendingChain)
+		{
+			PendingChain = MakeUnique<FOceanPassChain>(ChainConfig);
+		}
+
+		// The old chain keeps rendering until the new one is complete, then they are swapped in the same frame
+		if (PendingChain->PrepareNextPass(RHICmdList))
+		{
+			RetireChain(MoveTemp(ActiveChain));
+			ActiveChain = MoveTemp(PendingChain);
+		}
+	}
+	else if (PendingChain)
+	{
+		// The configuration went back to the active one
+		RetireChain(MoveTemp(PendingChain));
+	}
+
+	return ActiveChain.Get();
+}
+
+void FOceanRenderProxy::RenderChain(FRHICommandListImmediate& RHICmdList, const FOceanRenderPacket& Packet)
+{
+	check(IsInRenderingThread());
+
+	GpuTimer.Begin(RHICmdList);
+	ActiveChain->Render(RHICmdList, Packet);
+	GpuTimer.End(RHICmdList);
+
+	PublishResults(0);
+}
+
+void FOceanRenderProxy::RenderChainSurface(FRHICommandListImmediate& RHICmdList, const FOceanRenderPacket& Packet, float SharedGpuTime)
+{
+	check(IsInRenderingThread());
+
+	GpuTimer.Begin(RHICmdList);
+	ActiveChain->RenderSurface(RHICmdList, Packet);
+	GpuTimer.End(RHICmdList);
+
+	PublishResults(SharedGpuTime);
+}
+
+void FOceanRenderProxy::PublishResults(float SharedGpuTime)
+{
+	const FWaveStatisticsPassResult Result = ActiveChain->GetWaveStatistics();
+
+	if (Result.bValid)
+	{
+		FScopeLock Lock(&WaveStatisticsLock);
+		WaveStatistics = Result;
+	}
+
+	{
+		FScopeLock Lock(&ResultLock);
+		GpuTime = GpuTimer.GetTime() + SharedGpuTime;
+		ActiveTextureSize = FIntPoint(ActiveChain->GetConfig().TextureWidth, ActiveChain->GetConfig().TextureHeight);
+	}
+}
+
+void FOceanRenderProxy::RenderFlipbookPlayback(FRHICommandListImmediate& RHICmdList, const FOceanRenderPacket& Packet)
+{
+	FRHITexture* DisplacementFlipbookRef = FFTOcean::GetRHITextureFromTextureReference(Packet.DisplacementFlipbook);
+	FRHITexture* NormalFlipbookRef = FFTOcean::GetRHITextureFromTextureReference(Packet.NormalFlipbook);
+	FRHITexture2DArray* DisplacementFlipbookArray = DisplacementFlipbookRef ? DisplacementFlipbookRef->GetTexture2DArray() : nullptr;
+
+	if (!DisplacementFlipbookArray || !NormalFlipbookRef || DisplacementFlipbookArray->GetSizeZ() == 0)
+	{
+		return;
+	}
+
+	if (!FlipbookPlaybackPass)
+	{
+		FlipbookPlaybackPass = MakeUnique<FFlipbookPlaybackPass>();
+		FlipbookMipChainPass = MakeUnique<FMipChainPass>();
+	}
+
+	// The timestamp has already been wrapped into the loop period
+	const uint32 FrameCount = DisplacementFlipbookArray->GetSizeZ();
+	const float FramePosition = Packet.LoopPeriod > 0 ? Packet.Timestamp / Packet.LoopPeriod * FrameCount : 0;
+	const uint32 FrameA = StaticCast<uint32>(FMath::FloorToInt(FramePosition)) % FrameCount;
+
+	FFlipbookPlaybackPassConfig PassConfig;
+	PassConfig.TextureWidth = DisplacementFlipbookArray->GetSizeX();
+	PassConfig.TextureHeight = DisplacementFlipbookArray->GetSizeY();
+
+	FFlipbookPlaybackPassParam Param;
+	Param.DisplacementFlipbook = DisplacementFlipbookRef;
+	Param.NormalFlipbook = NormalFlipbookRef;
+	Param.FrameA = FrameA;
+	Param.FrameB = (FrameA + 1) % FrameCount;
+	Param.FrameBlend = FMath::Frac(FramePosition);
+
+	FlipbookPlaybackPass->Render(RHICmdList, PassConfig, Param);
+
+	FMipChainPassConfig MipChainPassConfig;
+	MipChainPassConfig.TextureWidth = PassConfig.TextureWidth;
+	MipChainPassConfig.TextureHeight = PassConfig.TextureHeight;
+
+	FMipChainPassParam MipChainParam;
+	MipChainParam.DisplacementTexture = FlipbookPlaybackPass->GetDisplacementTexture();
+	MipChainParam.NormalTexture = FlipbookPlaybackPass->GetNormalTexture();
+
+	FRHITexture* DisplacementTargetRef = FFTOcean::GetRHITextureFromTextureReference(Packet.DisplacementMap);
+	FRHITexture* NormalTargetRef = FFTOcean::GetRHITextureFromTextureReference(Packet.NormalMap);
+
+	FlipbookMipChainPass->Render(RHICmdList, MipChainPassConfig, MipChainParam, DisplacementTargetRef, NormalTargetRef);
+}
+
+void FOceanRenderProxy::RenderGerstnerWaves(FRHICommandListImmediate& RHICmdList, const FOceanRenderPacket& Packet)
+{
+	if (!GerstnerWavePass)
+	{
+		GerstnerWavePass = MakeUnique<FGerstnerWavePass>();
+		GerstnerMipChainPass = MakeUnique<FMipChainPass>();
+	}
+
+	FGerstnerWavePassConfig PassConfig;
+	PassConfig.TextureWidth = Packet.TextureWidth;
+	PassConfig.TextureHeight = Packet.TextureHeight;
+
+	FGerstnerWavePassParam Param;
+	Param.Waves = Packet.GerstnerWaves;
+	Param.NormalStrength = Packet.NormalStrength;
+
+	GerstnerWavePass->Render(RHICmdList, PassConfig, Param);
+
+	FMipChainPassConfig MipChainPassConfig;
+	MipChainPassConfig.TextureWidth = PassConfig.TextureWidth;
+	MipChainPassConfig.TextureHeight = PassConfig.TextureHeight;
+
+	FMipChainPassParam MipChainParam;
+	MipChainParam.DisplacementTexture = GerstnerWavePass->GetDisplacementTexture();
+	MipChainParam.NormalTexture = GerstnerWavePass->GetNormalTexture();
+
+	FRHITexture* DisplacementTargetRef = FFTOcean::GetRHITextureFromTextureReference(Packet.DisplacementMap);
+	FRHITexture* NormalTargetRef = FFTOcean::GetRHITextureFromTextureReference(Packet.NormalMap);
+
+	GerstnerMipChainPass->Render(RHICmdList, MipChainPassConfig, MipChainParam, DisplacementTargetRef, NormalTargetRef);
+}
+
+FWaveStatisticsPassResult FOceanRenderProxy::GetWaveStatistics() const
+{
+	FScopeLock Lock(&WaveStatisticsLock);
+	return WaveStatistics;
+}
+
+float FOceanRenderProxy::GetGpuTime() const
+{
+	FScopeLock Lock(&ResultLock);
+	return GpuTime;
+}
+
+FIntPoint FOceanRenderProxy::GetActiveTextureSize() const
+{
+	FScopeLock Lock(&ResultLock);
+	return ActiveTextureSize;
+}
+
+void FOceanRenderProxy::RetireChain(TUniquePtr<FOceanPassChain>&& Chain)
+{
+	FRetiredPassChain RetiredChain;
+	RetiredChain.Chain = MoveTemp(Chain);
+	RetiredChain.RetiredFrameNumber = GFrameNumberRenderThread;
+
+	RetiredChains.Add(MoveTemp(RetiredChain));
+
+	ProxiesWithRetiredChains.Add(this);
+}
+
+void FOceanRenderProxy::ReleaseRetiredChains()
+{
+	RetiredChains.RemoveAll([](const FRetiredPassChain& RetiredChain)
+	{
+		return GFrameNumberRenderThread - RetiredChain.RetiredFrameNumber >= RetiredChainReleaseDelay;
+	});
+
+	if (RetiredChains.Num() == 0)
+	{
+		ProxiesWithRetiredChains.Remove(this);
+	}
+}
+
+void FOceanRenderProxy::ReleaseAllRetiredChains()
+{
+	check(IsInRenderingThread());
+
+	// Releasing may remove the proxy from the set
+	const TArray<FOceanRenderProxy*> Proxies = ProxiesWithRetiredChains.Array();
+
+	for (FOceanRenderProxy* Proxy : Proxies)
+	{
+		Proxy->ReleaseRetiredChains();
+	}
+}
\ No newline at end of file
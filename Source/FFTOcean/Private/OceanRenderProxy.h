@@ -0,0 +1,129 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FFTOceanRenderer.h"
+#include "OceanPassChain.h"
+#include "OceanGpuTimer.h"
+#include "Pass/FlipbookPlaybackPass.h"
+#include "Pass/GerstnerWavePass.h"
+
+// Everything the render thread needs for one frame, copied by value so nothing points back into the component
+struct FOceanRenderPacket
+{
+	float     Timestamp;
+	uint32    TextureWidth;
+	uint32    TextureHeight;
+	// Spectra the surface blends between while the sea state changes, the same one outside of transitions
+	FOceanSeaState OutgoingSeaState;
+	FOceanSeaState IncomingSeaState;
+	float          SeaStateBlend;
+	float     NormalStrength;
+	bool      bAnalyticNormals;
+	float     LoopPeriod;
+
+	// Disturbances of this frame, as start and end points, then radius, amplitude and start amplitude scale
+	TArray<FVector4> DisturbanceSegments;
+	TArray<FVector4> DisturbanceShapes;
+
+	// Weighted waves of this frame, two registers each, replacing the transform when not empty
+	TArray<FVector4> GerstnerWaves;
+
+	// Only set when the surface is read back, snapshots are published to it a few frames later
+	TSharedPtr<FOceanSnapshotPublisher, ESPMode::ThreadSafe> SnapshotPublisher;
+
+	FTextureReferenceRHIRef DisplacementMap;
+	FTextureReferenceRHIRef NormalMap;
+
+	FTextureReferenceRHIRef DisplacementFlipbook;
+	FTextureReferenceRHIRef NormalFlipbook;
+
+	FTextureReferenceRHIRef PhillipsFourierPassDebugTexture;
+	FTextureReferenceRHIRef SurfaceDebugTextureX;
+	FTextureReferenceRHIRef SurfaceDebugTextureY;
+	FTextureReferenceRHIRef SurfaceDebugTextureZ;
+	FTextureReferenceRHIRef TwiddleFactorsDebugTexture;
+	FTextureReferenceRHIRef TransformDebugTextureX;
+	FTextureReferenceRHIRef TransformDebugTextureY;
+	FTextureReferenceRHIRef TransformDebugTextureZ;
+};
+
+// Owns every GPU resource of an ocean; created on the game thread, then only touched and destroyed on the render thread
+class FOceanRenderProxy final
+{
+public:
+
+	FOceanRenderProxy();
+	~FOceanRenderProxy();
+
+	FOceanRenderProxy(const FOceanRenderProxy&) = delete;
+	FOceanRenderProxy& operator=(const FOceanRenderProxy&) = delete;
+
+	void Render(FRHICommandListImmediate& RHICmdList, const FOceanRenderPacket& Packet);
+
+	// Builds the chain for the packet ahead of its first frame, as the active chain or as the pending one when another
+	// configuration is rendering. Packets that don't run the transform have nothing to build.
+	void WarmUp(FRHICommandListImmediate& RHICmdList, const FOceanRenderPacket& Packet);
+
+	// Render in steps, for the batched backend. Packets that don't run the transform are rendered right away and
+	// return null. Otherwise the returned chain renders the packet through RenderChain, or through its RenderSpectra,
+	// the batched transforms, then RenderChainSurface.
+	FOceanPassChain* PrepareRender(FRHICommandListImmediate& RHICmdList, const FOceanRenderPacket& Packet);
+	void RenderChain(FRHICommandListImmediate& RHICmdList, const FOceanRenderPacket& Packet);
+
+	// SharedGpuTime is the share of this ocean in the GPU time of the batched transforms, in milliseconds
+	void RenderChainSurface(FRHICommandListImmediate& RHICmdList, const FOceanRenderPacket& Packet, float SharedGpuTime);
+
+	// Safe to call from any thread
+	FWaveStatisticsPassResult GetWaveStatistics() const;
+
+	// GPU milliseconds of the last measured simulation, zero when nothing was measured yet. Safe to call from any thread.
+	float GetGpuTime() const;
+
+	// Size of the chain that renders the surface, zero before the first one. Safe to call from any thread.
+	FIntPoint GetActiveTextureSize() const;
+
+	// Releases the chains retired long enough ago by every proxy, once a frame, so that proxies which stopped
+	// rendering don't keep theirs alive. Render thread only.
+	static void ReleaseAllRetiredChains();
+
+private:
+
+	struct FRetiredPassChain
+	{
+		TUniquePtr<FOceanPassChain> Chain;
+		uint32                      RetiredFrameNumber;
+	};
+
+	// Renders until a chain for a new configuration is ready, then retires
+	TUniquePtr<FOceanPassChain> ActiveChain;
+	TUniquePtr<FOceanPassChain> PendingChain;
+	TArray<FRetiredPassChain>   RetiredChains;
+
+	// Only created once a flipbook is played back
+	TUniquePtr<FFlipbookPlaybackPass> FlipbookPlaybackPass;
+	TUniquePtr<FMipChainPass>         FlipbookMipChainPass;
+
+	// Only created once Gerstner waves are rendered
+	TUniquePtr<FGerstnerWavePass> GerstnerWavePass;
+	TUniquePtr<FMipChainPass>     GerstnerMipChainPass;
+
+	// Kept across chain switches, a new chain has nothing to read back for a few frames
+	FWaveStatisticsPassResult WaveStatistics;
+	mutable FCriticalSection  WaveStatisticsLock;
+
+	// Measures the passes of the active chain, published along with its size under ResultLock
+	FOceanGpuTimer           GpuTimer;
+	float                    GpuTime;
+	FIntPoint                ActiveTextureSize;
+	mutable FCriticalSection ResultLock;
+
+	void RenderFlipbookPlayback(FRHICommandListImmediate& RHICmdList, const FOceanRenderPacket& Packet);
+	void RenderGerstnerWaves(FRHICommandListImmediate& RHICmdList, const FOceanRenderPacket& Packet);
+
+	void PublishResults(float SharedGpuTime);
+
+	void RetireChain(TUniquePtr<FOceanPassChain>&& Chain);
+	void ReleaseRetiredChains();
+};
\ No newline at end of file
@@ -0,0 +1,200 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "OceanSimulationDriver.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+
+void FOceanGameThreadTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	Driver->TickGameThread();
+}
+
+FString FOceanGameThreadTickFunction::DiagnosticMessage()
+{
+	return TEXT("FOceanGameThreadTickFunction");
+}
+
+FOceanSimulationDriver::FOceanSimulationDriver() :
+	Component(nullptr),
+	RenderConfig(nullptr),
+	DebugConfig(nullptr),
+	SimulationPolicy(nullptr),
+	OceanRenderer(new FFFTOceanRenderer),
+	bForceSurfaceReadback(false)
+{
+	GameThreadTickFunction.Driver = this;
+	GameThreadTickFunction.bCanEverTick = true;
+	GameThreadTickFunction.bRunOnAnyThread = false;
+}
+
+FOceanSimulationDriver::~FOceanSimulationDriver()
+{
+}
+
+void FOceanSimulationDriver::Register(
+	UPrimitiveComponent* InComponent,
+	const FOceanRenderConfig& InRenderConfig,
+	const FOceanDebugConfig& InDebugConfig,
+	const FOceanSimulationPolicy& InSimulationPolicy,
+	FMaxDisplacementSetter InSetMaxDisplacement,
+	FTickPropertiesCopier InCopyTickProperties)
+{
+	Component = InComponent;
+	RenderConfig = &InRenderConfig;
+	DebugConfig = &InDebugConfig;
+	SimulationPolicy = &InSimulationPolicy;
+	SetMaxDisplacement = MoveTemp(InSetMaxDisplacement);
+	CopyComponentTickProperties = MoveTemp(InCopyTickProperties);
+
+	// Editor viewports can only be inspected from the game thread, and editor worlds are cheap enough to tick there.
+	// The component tick also runs the Blueprint tick event, which must stay on the game thread, so only native
+	// classes tick on any thread.
+	const UWorld* World = Component->GetWorld();
+	const UClass* Class = Component->GetClass();
+	const bool bNativeTick = !Class->HasAnyClassFlags(CLASS_CompiledFromBlueprint) && !Class->IsFunctionImplementedInScript(TEXT("ReceiveTick"));
+	Component->PrimaryComponentTick.bRunOnAnyThread = World && World->IsGameWorld() && bNativeTick;
+
+	SimulationThrottle.Reset();
+	ResolutionController.Reset();
+
+	// A tick ahead of the first game thread tick still has copies to read
+	CopyTickProperties();
+}
+
+void FOceanSimulationDriver::RegisterTickFunction(bool bRegister)
+{
+	check(Component);
+
+	FActorComponentTickFunction& ComponentTick = Component->PrimaryComponentTick;
+
+	if (bRegister)
+	{
+		if (!Component->IsTemplate() && ComponentTick.bCanEverTick && !GameThreadTickFunction.IsTickFunctionRegistered())
+		{
+			GameThreadTickFunction.TickGroup = ComponentTick.TickGroup;
+			GameThreadTickFunction.EndTickGroup = ComponentTick.TickGroup;
+			GameThreadTickFunction.bTickEvenWhenPaused = ComponentTick.bTickEvenWhenPaused;
+			GameThreadTickFunction.RegisterTickFunction(Component->GetComponentLevel());
+
+			// The component tick only starts once the copies of this frame are taken
+			ComponentTick.AddPrerequisite(Component, GameThreadTickFunction);
+		}
+	}
+	else if (GameThreadTickFunction.IsTickFunctionRegistered())
+	{
+		ComponentTick.RemovePrerequisite(Component, GameThreadTickFunction);
+		GameThreadTickFunction.UnRegisterTickFunction();
+	}
+}
+
+void FOceanSimulationDriver::BeginPlay()
+{
+	if (SimulationPolicy->bWarmUpOnBeginPlay)
+	{
+		WarmUp();
+	}
+}
+
+void FOceanSimulationDriver::EndPlay()
+{
+	ResolutionController.RestoreTargets();
+	ResolutionController.Reset();
+}
+
+void FOceanSimulationDriver::WarmUp()
+{
+	CopyTickProperties();
+
+	OceanRenderer->WarmUp(TickRenderConfig, SimulationThrottle.IsFarField());
+}
+
+void FOceanSimulationDriver::CopyTickProperties()
+{
+	check(IsInGameThread());
+
+	TickRenderConfig = *RenderConfig;
+	TickRenderConfig.bReadbackSurface |= bForceSurfaceReadback;
+	TickDebugConfig = *DebugConfig;
+	TickSimulationPolicy = *SimulationPolicy;
+
+	// The GPU budget changes the resolution of the copy and resizes the render targets, which is only allowed here
+	ResolutionController.Apply(Component->GetWorld(), TickRenderConfig, *OceanRenderer, SimulationThrottle.IsFarField());
+
+	if (CopyComponentTickProperties)
+	{
+		CopyComponentTickProperties();
+	}
+}
+
+void FOceanSimulationDriver::TickGameThread()
+{
+	if (!Component->IsRegistered() || Component->IsPendingKill())
+	{
+		return;
+	}
+
+	CopyTickProperties();
+
+	// Bounds can only change on the game thread, the component tick hasn't started yet so nothing reads them
+	const FOceanWaveStatistics WaveStatistics = OceanRenderer->GetWaveStatistics();
+
+	if (WaveStatistics.bValid)
+	{
+		SetMaxDisplacement(WaveStatistics.MaxDisplacement);
+	}
+}
+
+bool FOceanSimulationDriver::Tick(float DeltaTime)
+{
+	if (!SimulationThrottle.Advance(Component, TickSimulationPolicy, DeltaTime))
+	{
+		return false;
+	}
+
+	const float Timestamp = SimulationThrottle.GetSimulationTime() * TickRenderConfig.TimeMultiply + TickRenderConfig.StartTime;
+
+	OceanRenderer->Render(Timestamp, TickRenderConfig, TickDebugConfig, SimulationThrottle.IsFarField());
+
+	return true;
+}
+
+void FOceanSimulationDriver::AddRadialImpulse(FVector2D Center, float Radius, float Amplitude)
+{
+	OceanRenderer->AddDisturbance(FOceanDisturbance::MakeRadialImpulse(Center, Radius, Amplitude));
+}
+
+void FOceanSimulationDriver::AddWake(FVector2D Start, FVector2D End, float Width, float Amplitude)
+{
+	OceanRenderer->AddDisturbance(FOceanDisturbance::MakeWake(Start, End, Width, Amplitude));
+}
+
+FOceanWaveStatistics FOceanSimulationDriver::GetWaveStatistics() const
+{
+	return OceanRenderer->GetWaveStatistics();
+}
+
+FOceanSnapshotRef FOceanSimulationDriver::GetSurfaceSnapshot() const
+{
+	return OceanRenderer->GetSurfaceSnapshot();
+}
+
+void FOceanSimulationDriver::TransitionSeaState(FOceanRenderConfig& Config, float WaveAmplitude, float WindVelocity, float WindDirection, float TransitionTime)
+{
+	Config.WaveAmplitude = WaveAmplitude;
+	Config.WindVelocity = WindVelocity;
+	Config.WindDirection = WindDirection;
+	Config.SeaStateTransitionTime = TransitionTime;
+}
+
+void FOceanSimulationDriver::BakeFlipbook(UObject* Owner, FOceanRenderConfig& Config, const FOceanFlipbookBakeSettings& Settings)
+{
+	UTexture2DArray* DisplacementFlipbook = nullptr;
+	UTexture2DArray* NormalFlipbook = nullptr;
+
+	if (FFTOcean::BakeOceanFlipbook(Config, Settings, DisplacementFlipbook, NormalFlipbook))
+	{
+		Owner->Modify();
+		Config.DisplacementFlipbook = DisplacementFlipbook;
+		Config.NormalFlipbook = NormalFlipbook;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,405 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "OceanSimulationPolicy.h"
+#include "FFTOceanRenderer.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "Kismet/GameplayStatics.h"
+#include "HAL/IConsoleManager.h"
+
+#if WITH_EDITOR
+#include "Editor.h"
+#include "EditorViewportClient.h"
+#endif
+
+static TAutoConsoleVariable<int32> CVarFFTOceanGerstnerWaves(
+	TEXT("r.FFTOcean.GerstnerWaves"),
+	0,
+	TEXT("0: oceans render their Gerstner waves beyond their GerstnerDistance only\n")
+	TEXT("1: every ocean renders its Gerstner waves instead of the transform, for low scalability levels"),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<float> CVarFFTOceanGPUBudgetMs(
+	TEXT("r.FFTOcean.GPUBudgetMs"),
+	0,
+	TEXT("GPU milliseconds each ocean may spend on its transform, its resolution steps between r.FFTOcean.MinResolution and\n")
+	TEXT("r.FFTOcean.MaxResolution to stay within it. Game worlds only.\n")
+	TEXT("0: oceans render at their configured resolution"),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<int32> CVarFFTOceanMinResolution(
+	TEXT("r.FFTOcean.MinResolution"),
+	64,
+	TEXT("Smallest resolution r.FFTOcean.GPUBudgetMs steps an ocean down to, rounded up to a power of two within 64 and 1024"),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<int32> CVarFFTOceanMaxResolution(
+	TEXT("r.FFTOcean.MaxResolution"),
+	1024,
+	TEXT("Largest resolution r.FFTOcean.GPUBudgetMs steps an ocean up to, rounded up to a power of two within 64 and 1024"),
+	ECVF_Scalability);
+
+namespace
+{
+	// Share of the Gerstner distance a view has to come back within before the transform takes over again
+	constexpr float FarFieldHysteresis = 0.9f;
+
+	// Weight of each new GPU time in the smoothed one, the readback already lags a few frames
+	constexpr float GpuTimeSmoothing = 0.1f;
+
+	// Share of the budget the predicted time of the next resolution has to stay under before stepping up
+	constexpr float StepUpHysteresis = 0.8f;
+
+	// Seconds after a step before the new resolution is measured, so timings of the previous one are not blamed on it
+	constexpr float ResolutionSettleTime = 1.0f;
+
+	// Controller resizing each render target, game thread only. Oceans may share their render targets, the first
+	// controller to resize one keeps it until it restores it.
+	TMap<TWeakObjectPtr<UTextureRenderTarget2D>, const FOceanResolutionController*> TargetOwners;
+
+	int32 GetBudgetResolution(const TAutoConsoleVariable<int32>& CVar)
+	{
+		const uint32 Resolution = FMath::RoundUpToPowerOfTwo(FMath::Max(CVar.GetValueOnAnyThread(), 1));
+		return FMath::Clamp<int32>(Resolution, 64, 1024);
+	}
+
+	// Value times 2^Shift, never below one texel
+	int32 ScaleByPowerOfTwo(int32 Value, int32 Shift)
+	{
+		return Shift >= 0 ? Value << Shift : FMath::Max(Value >> -Shift, 1);
+	}
+
+#if WITH_EDITOR
+	bool IsAnyEditorViewportRealtime()
+	{
+		if (!GEditor)
+		{
+			return true;
+		}
+
+		for (const FEditorViewportClient* ViewportClient : GEditor->GetAllViewportClients())
+		{
+			if (ViewportClient && ViewportClient->IsRealtime())
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+#endif
+}
+
+FOceanSimulationThrottle::FOceanSimulationThrottle()
+{
+	SimulationTime = 0;
+	Reset();
+}
+
+void FOceanSimulationThrottle::Reset()
+{
+	TimeSinceSimulation = 0;
+	bHasSimulated = false;
+	bFarField = false;
+}
+
+bool FOceanSimulationThrottle::IsFarField() const
+{
+	return bFarField || CVarFFTOceanGerstnerWaves.GetValueOnAnyThread() != 0;
+}
+
+bool FOceanSimulationThrottle::Advance(const UPrimitiveComponent* Component, const FOceanSimulationPolicy& Policy, float DeltaTime)
+{
+	const UWorld* World = Component->GetWorld();
+	const bool bPaused = World->IsPaused();
+
+	if (!Policy.bFreezeWhenPaused)
+	{
+		SimulationTime = UGameplayStatics::GetRealTimeSeconds(World);
+	}
+	else if (!bPaused)
+	{
+		SimulationTime += DeltaTime;
+	}
+
+	TimeSinceSimulation += DeltaTime;
+
+	// Whatever the policy says, the render targets need one frame to show anything
+	if (!bHasSimulated)
+	{
+		bHasSimulated = true;
+		TimeSinceSimulation = 0;
+		return true;
+	}
+
+	if (bPaused && Policy.bFreezeWhenPaused)
+	{
+		return false;
+	}
+
+	if (Policy.bSkipWhenNotRendered && !Component->WasRecentlyRendered(Policy.RenderedTimeTolerance))
+	{
+		return false;
+	}
+
+#if WITH_EDITOR
+	// Editor viewport clients can only be inspected on the game thread, editor worlds tick there
+	if (Policy.bRenderOnceInNonRealtimeViewports && World->WorldType == EWorldType::Editor && IsInGameThread() && !IsAnyEditorViewportRealtime())
+	{
+		return false;
+	}
+#endif
+
+	const float ViewDistance = GetClosestViewDistance(Component);
+
+	UpdateFarField(Policy, ViewDistance);
+
+	if (TimeSinceSimulation < GetUpdateInterval(Policy, ViewDistance))
+	{
+		return false;
+	}
+
+	TimeSinceSimulation = 0;
+	return true;
+}
+
+void FOceanSimulationThrottle::UpdateFarField(const FOceanSimulationPolicy& Policy, float ViewDistance)
+{
+	if (Policy.GerstnerDistance <= 0)
+	{
+		bFarField = false;
+		return;
+	}
+
+	// Views moving around the threshold would otherwise flip the mode every tick
+	bFarField = ViewDistance > Policy.GerstnerDistance * (bFarField ? FarFieldHysteresis : 1);
+}
+
+float FOceanSimulationThrottle::GetClosestViewDistance(const UPrimitiveComponent* Component)
+{
+	const TArray<FVector>& ViewLocations = Component->GetWorld()->ViewLocationsRenderedLastFrame;
+
+	// Without any view the ocean is treated as close, so it never degrades before being seen
+	if (ViewLocations.Num() == 0)
+	{
+		return 0;
+	}
+
+	const FBox Bounds = Component->Bounds.GetBox();
+
+	float MinDistanceSquared = MAX_flt;
+	for (const FVector& ViewLocation : ViewLocations)
+	{
+		MinDistanceSquared = FMath::Min(MinDistanceSquared, Bounds.ComputeSquaredDistanceToPoint(ViewLocation));
+	}
+
+	return FMath::Sqrt(MinDistanceSquared);
+}
+
+float FOceanSimulationThrottle::GetUpdateInterval(const FOceanSimulationPolicy& Policy, float ViewDistance)
+{
+	if (Policy.MinRateDistance <= Policy.FullRateDistance)
+	{
+		return 0;
+	}
+
+	const float Alpha = FMath::GetRangePct(Policy.FullRateDistance, Policy.MinRateDistance, ViewDistance);
+
+	// Blend the interval so the rate falls off smoothly, a view at the full rate distance never waits
+	return FMath::Clamp(Alpha, 0.0f, 1.0f) / Policy.MinUpdateRate;
+}
+
+FOceanResolutionController::FOceanResolutionController()
+{
+	Reset();
+}
+
+FOceanResolutionController::~FOceanResolutionController()
+{
+	// Components restore their targets on EndPlay, this only drops the claims of controllers destroyed without one
+	for (const FResizedTarget& ResizedTarget : ResizedTargets)
+	{
+		TargetOwners.Remove(ResizedTarget.Target);
+	}
+}
+
+void FOceanResolutionController::Reset()
+{
+	Size = 0;
+	SmoothedGpuTime = 0;
+	LastSwitchTime = 0;
+}
+
+void FOceanResolutionController::Apply(const UWorld* World, FOceanRenderConfig& Config, const FFFTOceanRenderer& Renderer, bool bFarField)
+{
+	check(IsInGameThread());
+
+	const float BudgetMs = CVarFFTOceanGPUBudgetMs.GetValueOnGameThread();
+
+	// Lifting the budget gives the render targets back their authored size. Targets shared with an ocean that already
+	// budgets them keep the configured resolution, the mip chain resolves into them whatever size they are.
+	if (BudgetMs <= 0 || !World || !World->IsGameWorld() || !ClaimTargets(Config))
+	{
+		RestoreTargets();
+		Reset();
+		return;
+	}
+
+	const int32 MinSize = GetBudgetResolution(CVarFFTOceanMinResolution);
+	const int32 MaxSize = FMath::Max(MinSize, GetBudgetResolution(CVarFFTOceanMaxResolution));
+	const float Now = World->GetRealTimeSeconds();
+
+	// The controller steps the width, the height follows by the same power of two so the authored aspect is kept
+	const int32 AuthoredWidth = FMath::RoundUpToPowerOfTwo(FMath::Max(Config.RenderTextureWidth, 1));
+	const int32 AuthoredHeight = FMath::RoundUpToPowerOfTwo(FMath::Max(Config.RenderTextureHeight, 1));
+
+	if (Size == 0)
+	{
+		Size = AuthoredWidth;
+		LastSwitchTime = Now;
+	}
+
+	Size = FMath::Clamp(Size, MinSize, MaxSize);
+
+	const bool bSpectral = !Config.bGerstnerWaves && !(Config.DisplacementFlipbook && Config.NormalFlipbook);
+	const bool bTransform = !bFarField && bSpectral;
+	const FIntPoint ActiveSize = Renderer.GetActiveTextureSize();
+
+	// Only the transform is measured, and only once the pass chain of the current size has taken over
+	if (bTransform && ActiveSize.X == Size && Now - LastSwitchTime >= ResolutionSettleTime)
+	{
+		const float GpuTime = Renderer.GetGpuTime();
+
+		if (GpuTime > 0)
+		{
+			SmoothedGpuTime = SmoothedGpuTime > 0 ? FMath::Lerp(SmoothedGpuTime, GpuTime, GpuTimeSmoothing) : GpuTime;
+		}
+
+		const int32 NewSize = ChooseSize(BudgetMs, MinSize, MaxSize);
+
+		if (NewSize != Size)
+		{
+			Size = NewSize;
+			SmoothedGpuTime = 0;
+			LastSwitchTime = Now;
+		}
+	}
+
+	const int32 SizeShift = FMath::FloorLog2(Size) - FMath::FloorLog2(AuthoredWidth);
+
+	Config.RenderTextureWidth = Size;
+	Config.RenderTextureHeight = ScaleByPowerOfTwo(AuthoredHeight, SizeShift);
+
+	// Gerstner waves and flipbooks fill the render targets at their authored size, whatever the transform resolution
+	if (!bSpectral)
+	{
+		ResizeTargets(0);
+		return;
+	}
+
+	// The render targets never outgrow the transform resolving into them. Stepping down shrinks them at once and the
+	// previous pass chain resolves from its next mip until the new one is built, stepping up grows them once it is.
+	const int32 TargetSize = bTransform && ActiveSize.X > 0 ? FMath::Min(Size, ActiveSize.X) : Size;
+	ResizeTargets(FMath::FloorLog2(TargetSize) - FMath::FloorLog2(AuthoredWidth));
+}
+
+int32 FOceanResolutionController::ChooseSize(float BudgetMs, int32 MinSize, int32 MaxSize) const
+{
+	if (SmoothedGpuTime <= 0)
+	{
+		return Size;
+	}
+
+	if (SmoothedGpuTime > BudgetMs && Size > MinSize)
+	{
+		return Size / 2;
+	}
+
+	// Every pass is linear in the texel count, except the inverse transform which also runs one more stage per doubling
+	const float StageCount = FMath::FloorLog2(Size);
+	const float PredictedGpuTime = SmoothedGpuTime * 4 * (StageCount + 1) / StageCount;
+
+	if (PredictedGpuTime < BudgetMs * StepUpHysteresis && Size < MaxSize)
+	{
+		return Size * 2;
+	}
+
+	return Size;
+}
+
+bool FOceanResolutionController::ClaimTargets(const FOceanRenderConfig& Config)
+{
+	UTextureRenderTarget2D* const Targets[] = { Config.DisplacementMap, Config.NormalMap };
+
+	// Targets swapped out of the config since the last tick get their size back first
+	for (int32 Index = ResizedTargets.Num() - 1; Index >= 0; --Index)
+	{
+		UTextureRenderTarget2D* Target = ResizedTargets[Index].Target.Get();
+
+		if (!Target || (Target != Targets[0] && Target != Targets[1]))
+		{
+			if (Target)
+			{
+				Target->ResizeTarget(ResizedTargets[Index].AuthoredSize.X, ResizedTargets[Index].AuthoredSize.Y);
+			}
+
+			TargetOwners.Remove(ResizedTargets[Index].Target);
+			ResizedTargets.RemoveAtSwap(Index);
+		}
+	}
+
+	for (UTextureRenderTarget2D* Target : Targets)
+	{
+		const FOceanResolutionController* const* Owner = Target ? TargetOwners.Find(Target) : nullptr;
+
+		if (Owner && *Owner != this)
+		{
+			return false;
+		}
+	}
+
+	for (UTextureRenderTarget2D* Target : Targets)
+	{
+		if (Target && !TargetOwners.Contains(Target))
+		{
+			TargetOwners.Add(Target, this);
+			ResizedTargets.Add({ Target, FIntPoint(Target->SizeX, Target->SizeY) });
+		}
+	}
+
+	return true;
+}
+
+void FOceanResolutionController::ResizeTargets(int32 SizeShift)
+{
+	for (const FResizedTarget& ResizedTarget : ResizedTargets)
+	{
+		UTextureRenderTarget2D* Target = ResizedTarget.Target.Get();
+		const FIntPoint TargetSize(ScaleByPowerOfTwo(ResizedTarget.AuthoredSize.X, SizeShift), ScaleByPowerOfTwo(ResizedTarget.AuthoredSize.Y, SizeShift));
+
+		if (Target && (Target->SizeX != TargetSize.X || Target->SizeY != TargetSize.Y))
+		{
+			Target->ResizeTarget(TargetSize.X, TargetSize.Y);
+		}
+	}
+}
+
+void FOceanResolutionController::RestoreTargets()
+{
+	check(IsInGameThread());
+
+	for (const FResizedTarget& ResizedTarget : ResizedTargets)
+	{
+		UTextureRenderTarget2D* Target = ResizedTarget.Target.Get();
+
+		if (Target && (Target->SizeX != ResizedTarget.AuthoredSize.X || Target->SizeY != ResizedTarget.AuthoredSize.Y))
+		{
+			Target->ResizeTarget(ResizedTarget.AuthoredSize.X, ResizedTarget.AuthoredSize.Y);
+		}
+
+		TargetOwners.Remove(ResizedTarget.Target);
+	}
+
+	ResizedTargets.Reset();
+}
\ No newline at end of file
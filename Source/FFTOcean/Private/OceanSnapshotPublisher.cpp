@@ -0,0 +1,127 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "OceanSnapshotPublisher.h"
+
+FOceanSnapshotRef::FOceanSnapshotRef() :
+	BufferIndex(INDEX_NONE)
+{
+}
+
+FOceanSnapshotRef::FOceanSnapshotRef(const TSharedRef<const FOceanSnapshotPublisher, ESPMode::ThreadSafe>& InPublisher, int32 InBufferIndex) :
+	Publisher(InPublisher),
+	BufferIndex(InBufferIndex)
+{
+	// The publisher already counted this reader
+}
+
+FOceanSnapshotRef::FOceanSnapshotRef(const FOceanSnapshotRef& Other) :
+	Publisher(Other.Publisher),
+	BufferIndex(Other.BufferIndex)
+{
+	if (IsValid())
+	{
+		++Publisher->Buffers[BufferIndex].ReaderCount;
+	}
+}
+
+FOceanSnapshotRef::FOceanSnapshotRef(FOceanSnapshotRef&& Other) :
+	Publisher(MoveTemp(Other.Publisher)),
+	BufferIndex(Other.BufferIndex)
+{
+	Other.BufferIndex = INDEX_NONE;
+}
+
+FOceanSnapshotRef::~FOceanSnapshotRef()
+{
+	Reset();
+}
+
+FOceanSnapshotRef& FOceanSnapshotRef::operator=(const FOceanSnapshotRef& Other)
+{
+	if (this != &Other)
+	{
+		*this = FOceanSnapshotRef(Other);
+	}
+
+	return *this;
+}
+
+FOceanSnapshotRef& FOceanSnapshotRef::operator=(FOceanSnapshotRef&& Other)
+{
+	if (this != &Other)
+	{
+		Reset();
+
+		Publisher = MoveTemp(Other.Publisher);
+		BufferIndex = Other.BufferIndex;
+		Other.BufferIndex = INDEX_NONE;
+	}
+
+	return *this;
+}
+
+const FOceanSurfaceSnapshot& FOceanSnapshotRef::Get() const
+{
+	check(IsValid());
+	return Publisher->Buffers[BufferIndex].Snapshot.GetValue();
+}
+
+void FOceanSnapshotRef::Reset()
+{
+	if (IsValid())
+	{
+		--Publisher->Buffers[BufferIndex].ReaderCount;
+	}
+
+	Publisher.Reset();
+	BufferIndex = INDEX_NONE;
+}
+
+FOceanSnapshotPublisher::FOceanSnapshotPublisher() :
+	PublishedIndex(INDEX_NONE)
+{
+}
+
+bool FOceanSnapshotPublisher::Publish(FOceanSurfaceSnapshot&& Snapshot)
+{
+	const int32 CurrentIndex = PublishedIndex.Load();
+
+	for (int32 Index = 0; Index < OCEAN_SNAPSHOT_BUFFER_COUNT; ++Index)
+	{
+		// A reader that pins this buffer from now on sees it unpublished and lets go before reading it
+		if (Index == CurrentIndex || Buffers[Index].ReaderCount.Load() != 0)
+		{
+			continue;
+		}
+
+		Buffers[Index].Snapshot.Emplace(MoveTemp(Snapshot));
+		PublishedIndex.Store(Index);
+
+		return true;
+	}
+
+	return false;
+}
+
+FOceanSnapshotRef FOceanSnapshotPublisher::Acquire() const
+{
+	for (;;)
+	{
+		const int32 Index = PublishedIndex.Load();
+
+		if (Index == INDEX_NONE)
+		{
+			return FOceanSnapshotRef();
+		}
+
+		++Buffers[Index].ReaderCount;
+
+		// Still published once pinned, so the producer can't be writing it and won't until the count drops
+		if (PublishedIndex.Load() == Index)
+		{
+			return FOceanSnapshotRef(AsShared(), Index);
+		}
+
+		--Buffers[Index].ReaderCount;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,253 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "OceanSparseWaves.h"
+
+namespace
+{
+	constexpr int32 SparseWaveLaneCount = 4;
+
+	// Fixed point iterations of the horizontal displacement inversion, like the snapshot height queries
+	constexpr int32 SparseHeightIterationCount = 4;
+
+	// Cosine and sine weights of every wave at one time, laid out per field so each is broadcast from a flat array
+	struct FWaveCoefficients
+	{
+		TArray<float> WaveVectorX;
+		TArray<float> WaveVectorY;
+		TArray<float> CosX;
+		TArray<float> SinX;
+		TArray<float> CosY;
+		TArray<float> SinY;
+		TArray<float> CosZ;
+		TArray<float> SinZ;
+
+		FWaveCoefficients(const TArray<FOceanSparseWave>& Waves, float Time)
+		{
+			const int32 WaveCount = Waves.Num();
+
+			WaveVectorX.SetNumUninitialized(WaveCount);
+			WaveVectorY.SetNumUninitialized(WaveCount);
+			CosX.SetNumUninitialized(WaveCount);
+			SinX.SetNumUninitialized(WaveCount);
+			CosY.SetNumUninitialized(WaveCount);
+			SinY.SetNumUninitialized(WaveCount);
+			CosZ.SetNumUninitialized(WaveCount);
+			SinZ.SetNumUninitialized(WaveCount);
+
+			for (int32 Index = 0; Index < WaveCount; ++Index)
+			{
+				const FOceanSparseWave& Wave = Waves[Index];
+
+				FVector Cos, Sin;
+				FFTOcean::GetSparseWaveWeights(Wave, Time, Cos, Sin);
+
+				WaveVectorX[Index] = Wave.WaveVector.X;
+				WaveVectorY[Index] = Wave.WaveVector.Y;
+				CosX[Index] = Cos.X;
+				SinX[Index] = Sin.X;
+				CosY[Index] = Cos.Y;
+				SinY[Index] = Sin.Y;
+				CosZ[Index] = Cos.Z;
+				SinZ[Index] = Sin.Z;
+			}
+		}
+	};
+
+	// Displacement of four patch space locations, already wrapped into the patch
+	void EvaluateLanes(const FWaveCoefficients& Coefficients, const VectorRegister& LocationX, const VectorRegister& LocationY, VectorRegister& OutX, VectorRegister& OutY, VectorRegister& OutZ)
+	{
+		OutX = VectorZero();
+		OutY = VectorZero();
+		OutZ = VectorZero();
+
+		for (int32 Index = 0; Index < Coefficients.WaveVectorX.Num(); ++Index)
+		{
+			const VectorRegister Theta = VectorMultiplyAdd(VectorLoadFloat1(&Coefficients.WaveVectorX[Index]), LocationX, VectorMultiply(VectorLoadFloat1(&Coefficients.WaveVectorY[Index]), LocationY));
+
+			VectorRegister SinTheta;
+			VectorRegister CosTheta;
+			VectorSinCos(&SinTheta, &CosTheta, &Theta);
+
+			OutX = VectorMultiplyAdd(CosTheta, VectorLoadFloat1(&Coefficients.CosX[Index]), VectorMultiplyAdd(SinTheta, VectorLoadFloat1(&Coefficients.SinX[Index]), OutX));
+			OutY = VectorMultiplyAdd(CosTheta, VectorLoadFloat1(&Coefficients.CosY[Index]), VectorMultiplyAdd(SinTheta, VectorLoadFloat1(&Coefficients.SinY[Index]), OutY));
+			OutZ = VectorMultiplyAdd(CosTheta, VectorLoadFloat1(&Coefficients.CosZ[Index]), VectorMultiplyAdd(SinTheta, VectorLoadFloat1(&Coefficients.SinZ[Index]), OutZ));
+		}
+	}
+
+	// Every wave repeats over the patch, wrapping keeps the phases small enough for float precision
+	FORCEINLINE float WrapToPatch(float Value)
+	{
+		return Value - FFTOcean::PatchLength * FMath::FloorToFloat(Value / FFTOcean::PatchLength);
+	}
+}
+
+void FFTOcean::GetSparseWaveWeights(const FOceanSparseWave& Wave, float Time, FVector& OutCos, FVector& OutSin)
+{
+	// Phases are wrapped in double precision, so timestamps far from zero keep their accuracy
+	double Phase = StaticCast<double>(Wave.Omega) * Time;
+	Phase -= 2 * PI * FMath::FloorToDouble(Phase / (2 * PI));
+
+	float SinV, CosV;
+	FMath::SinCos(&SinV, &CosV, StaticCast<float>(Phase));
+
+	// h(k, t) = A * exp(iwt) + B * exp(-iwt), then the real part of h(k, t) * exp(ik.x) and of its
+	// componentwise products with the displacement direction, like the Fourier component shader
+	const float Real = (Wave.A + Wave.B) * CosV;
+	const float Imaginary = (Wave.A - Wave.B) * SinV;
+
+	OutCos = FVector(Wave.Direction.X * Real, Wave.Direction.Y * Real, Real);
+	OutSin = FVector(Wave.Direction.X * Imaginary, Wave.Direction.Y * Imaginary, -Imaginary);
+}
+
+FOceanSparseWaveEvaluator::FOceanSparseWaveEvaluator(const FOceanCpuSimulationConfig& InConfig, int32 WaveCount) :
+	Config(InConfig)
+{
+	const int32 Size = Config.Size;
+
+	// Inverse transform scale, see the surface displacement shader
+	const float Scale = 10.0f / (Size * Size);
+
+	TArray<FOceanSparseWave> Candidates;
+	Candidates.Reserve(Size * Size);
+
+	float TotalEnergy = 0;
+
+	for (int32 Y = 0; Y < Size; ++Y)
+	{
+		for (int32 X = 0; X < Size; ++X)
+		{
+			const FVector2D Amplitudes = FFTOcean::GetPhillipsAmplitudes(Config, X, Y) * Scale;
+
+			if (Amplitudes.IsZero())
+			{
+				continue;
+			}
+
+			const FVector2D K = FFTOcean::GetWaveVector(X, Y);
+
+			FOceanSparseWave Wave;
+			Wave.WaveVector = FFTOcean::GetWaveVector(X < Size / 2 ? X : X - Size, Y < Size / 2 ? Y : Y - Size);
+			Wave.Direction = K / FMath::Max(K.Size(), 0.0001f);
+			Wave.Omega = FFTOcean::GetWaveOmega(K, Config.LoopPeriod);
+			Wave.A = Amplitudes.X;
+			Wave.B = Amplitudes.Y;
+
+			Candidates.Add(Wave);
+			TotalEnergy += Amplitudes.SizeSquared();
+		}
+	}
+
+	Candidates.Sort([](const FOceanSparseWave& Lhs, const FOceanSparseWave& Rhs)
+	{
+		return FMath::Square(Lhs.A) + FMath::Square(Lhs.B) > FMath::Square(Rhs.A) + FMath::Square(Rhs.B);
+	});
+
+	const int32 KeptCount = FMath::Clamp(WaveCount, 0, Candidates.Num());
+	Waves.Append(Candidates.GetData(), KeptCount);
+
+	float KeptEnergy = 0;
+	for (const FOceanSparseWave& Wave : Waves)
+	{
+		KeptEnergy += FMath::Square(Wave.A) + FMath::Square(Wave.B);
+	}
+
+	float DroppedAmplitude = 0;
+	float DroppedEnergy = 0;
+	for (int32 Index = KeptCount; Index < Candidates.Num(); ++Index)
+	{
+		DroppedAmplitude += FMath::Abs(Candidates[Index].A) + FMath::Abs(Candidates[Index].B);
+		DroppedEnergy += FMath::Square(Candidates[Index].A) + FMath::Square(Candidates[Index].B);
+	}
+
+	// A * cos(u) + B * cos(v) averages to (A^2 + B^2) / 2 squared over the patch and over time
+	TruncationError.MaxHeightError = DroppedAmplitude;
+	TruncationError.RmsHeightError = FMath::Sqrt(DroppedEnergy * 0.5f);
+	TruncationError.EnergyFraction = TotalEnergy > 0 ? KeptEnergy / TotalEnergy : 1;
+}
+
+void FOceanSparseWaveEvaluator::EvaluateDisplacements(float Time, TArrayView<const FVector2D> Locations, TArrayView<FVector> OutDisplacements) const
+{
+	check(Locations.Num() == OutDisplacements.Num());
+
+	const FWaveCoefficients Coefficients(Waves, Time);
+
+	MS_ALIGN(16) float LocationX[SparseWaveLaneCount] GCC_ALIGN(16);
+	MS_ALIGN(16) float LocationY[SparseWaveLaneCount] GCC_ALIGN(16);
+	MS_ALIGN(16) float Displacement[3][SparseWaveLaneCount] GCC_ALIGN(16);
+
+	for (int32 First = 0; First < Locations.Num(); First += SparseWaveLaneCount)
+	{
+		const int32 LaneCount = FMath::Min(SparseWaveLaneCount, Locations.Num() - First);
+
+		// A partial group repeats its last location in the unused lanes
+		for (int32 Lane = 0; Lane < SparseWaveLaneCount; ++Lane)
+		{
+			const FVector2D& Location = Locations[First + FMath::Min(Lane, LaneCount - 1)];
+			LocationX[Lane] = WrapToPatch(Location.X);
+			LocationY[Lane] = WrapToPatch(Location.Y);
+		}
+
+		VectorRegister DisplacementX;
+		VectorRegister DisplacementY;
+		VectorRegister DisplacementZ;
+		EvaluateLanes(Coefficients, VectorLoadAligned(LocationX), VectorLoadAligned(LocationY), DisplacementX, DisplacementY, DisplacementZ);
+
+		VectorStoreAligned(DisplacementX, Displacement[0]);
+		VectorStoreAligned(DisplacementY, Displacement[1]);
+		VectorStoreAligned(DisplacementZ, Displacement[2]);
+
+		for (int32 Lane = 0; Lane < LaneCount; ++Lane)
+		{
+			OutDisplacements[First + Lane] = FVector(Displacement[0][Lane], Displacement[1][Lane], Displacement[2][Lane]);
+		}
+	}
+}
+
+void FOceanSparseWaveEvaluator::EvaluateHeights(float Time, TArrayView<const FVector2D> Locations, TArrayView<float> OutHeights) const
+{
+	check(Locations.Num() == OutHeights.Num());
+
+	const FWaveCoefficients Coefficients(Waves, Time);
+
+	MS_ALIGN(16) float LocationX[SparseWaveLaneCount] GCC_ALIGN(16);
+	MS_ALIGN(16) float LocationY[SparseWaveLaneCount] GCC_ALIGN(16);
+	MS_ALIGN(16) float Heights[SparseWaveLaneCount] GCC_ALIGN(16);
+
+	for (int32 First = 0; First < Locations.Num(); First += SparseWaveLaneCount)
+	{
+		const int32 LaneCount = FMath::Min(SparseWaveLaneCount, Locations.Num() - First);
+
+		for (int32 Lane = 0; Lane < SparseWaveLaneCount; ++Lane)
+		{
+			const FVector2D& Location = Locations[First + FMath::Min(Lane, LaneCount - 1)];
+			LocationX[Lane] = WrapToPatch(Location.X);
+			LocationY[Lane] = WrapToPatch(Location.Y);
+		}
+
+		const VectorRegister TargetX = VectorLoadAligned(LocationX);
+		const VectorRegister TargetY = VectorLoadAligned(LocationY);
+
+		// Solve Source + D(Source).XY = Location. Sources may leave the patch by the displacement, which the waves don't mind.
+		VectorRegister SourceX = TargetX;
+		VectorRegister SourceY = TargetY;
+
+		VectorRegister DisplacementX;
+		VectorRegister DisplacementY;
+		VectorRegister DisplacementZ;
+
+		for (int32 Iteration = 0; Iteration < SparseHeightIterationCount; ++Iteration)
+		{
+			EvaluateLanes(Coefficients, SourceX, SourceY, DisplacementX, DisplacementY, DisplacementZ);
+			SourceX = VectorSubtract(TargetX, DisplacementX);
+			SourceY = VectorSubtract(TargetY, DisplacementY);
+		}
+
+		EvaluateLanes(Coefficients, SourceX, SourceY, DisplacementX, DisplacementY, DisplacementZ);
+		VectorStoreAligned(DisplacementZ, Heights);
+
+		for (int32 Lane = 0; Lane < LaneCount; ++Lane)
+		{
+			OutHeights[First + Lane] = Heights[Lane];
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,245 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "OceanSurfaceSnapshot.h"
+#include "OceanCpuSimulation.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+	// Fixed point iterations of the horizontal displacement inversion, the error shrinks by the wave steepness each time
+	constexpr int32 HeightInversionIterationCount = 4;
+
+	// Batched queries stop iterating once every point moved less than this, in patch units
+	constexpr int32 MaxHeightQueryIterationCount = 8;
+	constexpr float HeightQueryTolerance = 0.1f;
+
+	// Points per SIMD group, and per parallel task of large queries
+	constexpr int32 HeightQueryLaneCount = 4;
+	constexpr int32 HeightQueryBatchSize = 1024;
+
+	FORCEINLINE VectorRegister LerpLanes(const VectorRegister& A, const VectorRegister& B, const VectorRegister& Alpha)
+	{
+		return VectorMultiplyAdd(VectorSubtract(B, A), Alpha, A);
+	}
+}
+
+FOceanSurfaceSnapshot::FOceanSurfaceSnapshot(int32 InWidth, int32 InHeight, float InTime, TArray<FVector>&& InDisplacement) :
+	Width(InWidth),
+	Height(InHeight),
+	Time(InTime),
+	TexelLength(FFTOcean::PatchLength / InWidth, FFTOcean::PatchLength / InHeight),
+	Displacement(MoveTemp(InDisplacement))
+{
+	// Power of two sizes let texel lookups wrap with a mask
+	check(FMath::IsPowerOfTwo(Width) && FMath::IsPowerOfTwo(Height));
+	check(Displacement.Num() == Width * Height);
+}
+
+FOceanSurfaceSnapshot FOceanSurfaceSnapshot::FromCpuSimulation(const FOceanCpuSimulation& Simulation, float Time)
+{
+	const TArray<FVector4>& DisplacementMap = Simulation.GetDisplacementMap();
+	const int32 Size = Simulation.GetConfig().Size;
+
+	TArray<FVector> Displacement;
+	Displacement.SetNumUninitialized(DisplacementMap.Num());
+
+	for (int32 Index = 0; Index < DisplacementMap.Num(); ++Index)
+	{
+		Displacement[Index] = FVector(DisplacementMap[Index]);
+	}
+
+	return FOceanSurfaceSnapshot(Size, Size, Time, MoveTemp(Displacement));
+}
+
+FOceanSurfaceSnapshot FOceanSurfaceSnapshot::FromHalfTexels(int32 Width, int32 Height, float Time, TArrayView<const FFloat16Color> Texels)
+{
+	TArray<FVector> Displacement;
+	Displacement.SetNumUninitialized(Texels.Num());
+
+	for (int32 Index = 0; Index < Texels.Num(); ++Index)
+	{
+		const FFloat16Color& Texel = Texels[Index];
+		Displacement[Index] = FVector(Texel.R.GetFloat(), Texel.G.GetFloat(), Texel.B.GetFloat());
+	}
+
+	return FOceanSurfaceSnapshot(Width, Height, Time, MoveTemp(Displacement));
+}
+
+FVector FOceanSurfaceSnapshot::SampleDisplacement(const FVector2D& Location) const
+{
+	const float U = Location.X / TexelLength.X;
+	const float V = Location.Y / TexelLength.Y;
+
+	const float FloorU = FMath::FloorToFloat(U);
+	const float FloorV = FMath::FloorToFloat(V);
+
+	const int32 X = FMath::FloorToInt(FloorU);
+	const int32 Y = FMath::FloorToInt(FloorV);
+
+	const float FracU = U - FloorU;
+	const float FracV = V - FloorV;
+
+	const FVector Top = FMath::Lerp(GetTexelDisplacement(X, Y), GetTexelDisplacement(X + 1, Y), FracU);
+	const FVector Bottom = FMath::Lerp(GetTexelDisplacement(X, Y + 1), GetTexelDisplacement(X + 1, Y + 1), FracU);
+
+	return FMath::Lerp(Top, Bottom, FracV);
+}
+
+float FOceanSurfaceSnapshot::SampleHeight(const FVector2D& Location) const
+{
+	// Solve Source + D(Source).XY = Location, starting from the location itself
+	FVector2D Source = Location;
+	FVector SourceDisplacement = SampleDisplacement(Source);
+
+	for (int32 Iteration = 0; Iteration < HeightInversionIterationCount; ++Iteration)
+	{
+		Source = Location - FVector2D(SourceDisplacement);
+		SourceDisplacement = SampleDisplacement(Source);
+	}
+
+	return SourceDisplacement.Z;
+}
+
+void FOceanSurfaceSnapshot::QueryWaterHeights(TArrayView<const FVector2D> Locations, TArrayView<float> OutHeights, FOceanHeightQueryHandle* Handle) const
+{
+	check(Locations.Num() == OutHeights.Num());
+
+	const int32 Count = Locations.Num();
+
+	TArray<FVector2D> LocalSourceOffsets;
+	TArray<FVector2D>& SourceOffsets = Handle ? Handle->SourceOffsets : LocalSourceOffsets;
+
+	// A different set of points can't reuse the previous solution, starting from the points themselves is as good as any
+	if (SourceOffsets.Num() != Count)
+	{
+		SourceOffsets.Reset(Count);
+		SourceOffsets.AddZeroed(Count);
+	}
+
+	const int32 BatchCount = FMath::DivideAndRoundUp(Count, HeightQueryBatchSize);
+
+	ParallelFor(BatchCount, [this, &Locations, &OutHeights, &SourceOffsets, Count](int32 Batch)
+	{
+		const int32 First = Batch * HeightQueryBatchSize;
+		const int32 BatchNum = FMath::Min(HeightQueryBatchSize, Count - First);
+
+		QueryWaterHeightBatch(Locations.Slice(First, BatchNum), OutHeights.Slice(First, BatchNum), SourceOffsets.GetData() + First);
+	}, BatchCount == 1);
+}
+
+void FOceanSurfaceSnapshot::QueryWaterHeightBatch(TArrayView<const FVector2D> Locations, TArrayView<float> OutHeights, FVector2D* SourceOffsets) const
+{
+	const VectorRegister Tolerance = VectorSetFloat1(HeightQueryTolerance);
+
+	MS_ALIGN(16) float LocationX[HeightQueryLaneCount] GCC_ALIGN(16);
+	MS_ALIGN(16) float LocationY[HeightQueryLaneCount] GCC_ALIGN(16);
+	MS_ALIGN(16) float SourceX[HeightQueryLaneCount] GCC_ALIGN(16);
+	MS_ALIGN(16) float SourceY[HeightQueryLaneCount] GCC_ALIGN(16);
+	MS_ALIGN(16) float Heights[HeightQueryLaneCount] GCC_ALIGN(16);
+
+	for (int32 First = 0; First < Locations.Num(); First += HeightQueryLaneCount)
+	{
+		const int32 LaneCount = FMath::Min(HeightQueryLaneCount, Locations.Num() - First);
+
+		// A partial group repeats its last point in the unused lanes
+		for (int32 Lane = 0; Lane < HeightQueryLaneCount; ++Lane)
+		{
+			const int32 Index = First + FMath::Min(Lane, LaneCount - 1);
+			LocationX[Lane] = Locations[Index].X;
+			LocationY[Lane] = Locations[Index].Y;
+			SourceX[Lane] = Locations[Index].X + SourceOffsets[Index].X;
+			SourceY[Lane] = Locations[Index].Y + SourceOffsets[Index].Y;
+		}
+
+		const VectorRegister TargetX = VectorLoadAligned(LocationX);
+		const VectorRegister TargetY = VectorLoadAligned(LocationY);
+
+		VectorRegister DisplacementX;
+		VectorRegister DisplacementY;
+		VectorRegister DisplacementZ;
+
+		for (int32 Iteration = 0; Iteration < MaxHeightQueryIterationCount; ++Iteration)
+		{
+			SampleDisplacementLanes(SourceX, SourceY, DisplacementX, DisplacementY, DisplacementZ);
+
+			// Solve Source + D(Source).XY = Location
+			const VectorRegister PreviousX = VectorLoadAligned(SourceX);
+			const VectorRegister PreviousY = VectorLoadAligned(SourceY);
+			const VectorRegister NextX = VectorSubtract(TargetX, DisplacementX);
+			const VectorRegister NextY = VectorSubtract(TargetY, DisplacementY);
+
+			VectorStoreAligned(NextX, SourceX);
+			VectorStoreAligned(NextY, SourceY);
+
+			const VectorRegister Change = VectorMax(VectorAbs(VectorSubtract(NextX, PreviousX)), VectorAbs(VectorSubtract(NextY, PreviousY)));
+
+			if (!VectorAnyGreaterThan(Change, Tolerance))
+			{
+				break;
+			}
+		}
+
+		// Heights are read at the final guess, so the result always matches the stored offsets
+		SampleDisplacementLanes(SourceX, SourceY, DisplacementX, DisplacementY, DisplacementZ);
+		VectorStoreAligned(DisplacementZ, Heights);
+
+		for (int32 Lane = 0; Lane < LaneCount; ++Lane)
+		{
+			const int32 Index = First + Lane;
+			OutHeights[Index] = Heights[Lane];
+			SourceOffsets[Index] = FVector2D(SourceX[Lane] - LocationX[Lane], SourceY[Lane] - LocationY[Lane]);
+		}
+	}
+}
+
+void FOceanSurfaceSnapshot::SampleDisplacementLanes(const float* LocationX, const float* LocationY, VectorRegister& OutX, VectorRegister& OutY, VectorRegister& OutZ) const
+{
+	MS_ALIGN(16) float FracU[HeightQueryLaneCount] GCC_ALIGN(16);
+	MS_ALIGN(16) float FracV[HeightQueryLaneCount] GCC_ALIGN(16);
+
+	// Corner displacements as [Corner][Axis][Lane], the gather is scalar and the filtering vectorized
+	MS_ALIGN(16) float Corners[4][3][HeightQueryLaneCount] GCC_ALIGN(16);
+
+	for (int32 Lane = 0; Lane < HeightQueryLaneCount; ++Lane)
+	{
+		const float U = LocationX[Lane] / TexelLength.X;
+		const float V = LocationY[Lane] / TexelLength.Y;
+
+		const float FloorU = FMath::FloorToFloat(U);
+		const float FloorV = FMath::FloorToFloat(V);
+
+		FracU[Lane] = U - FloorU;
+		FracV[Lane] = V - FloorV;
+
+		const int32 X = FMath::FloorToInt(FloorU);
+		const int32 Y = FMath::FloorToInt(FloorV);
+
+		const FVector* CornerDisplacements[4] =
+		{
+			&GetTexelDisplacement(X, Y),
+			&GetTexelDisplacement(X + 1, Y),
+			&GetTexelDisplacement(X, Y + 1),
+			&GetTexelDisplacement(X + 1, Y + 1)
+		};
+
+		for (int32 Corner = 0; Corner < 4; ++Corner)
+		{
+			Corners[Corner][0][Lane] = CornerDisplacements[Corner]->X;
+			Corners[Corner][1][Lane] = CornerDisplacements[Corner]->Y;
+			Corners[Corner][2][Lane] = CornerDisplacements[Corner]->Z;
+		}
+	}
+
+	const VectorRegister AlphaU = VectorLoadAligned(FracU);
+	const VectorRegister AlphaV = VectorLoadAligned(FracV);
+
+	VectorRegister* Outputs[3] = { &OutX, &OutY, &OutZ };
+
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		const VectorRegister Top = LerpLanes(VectorLoadAligned(Corners[0][Axis]), VectorLoadAligned(Corners[1][Axis]), AlphaU);
+		const VectorRegister Bottom = LerpLanes(VectorLoadAligned(Corners[2][Axis]), VectorLoadAligned(Corners[3][Axis]), AlphaU);
+
+		*Outputs[Axis] = LerpLanes(Top, Bottom, AlphaV);
+	}
+}
\ No newline at end of file
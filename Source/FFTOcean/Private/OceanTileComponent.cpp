@@ -0,0 +1,233 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "OceanTileComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "Engine/StaticMesh.h"
+#include "Pass/PassUtil.h"
+#include "OceanBounds.h"
+#include "OceanCpuSimulation.h"
+
+UOceanTileComponent::UOceanTileComponent(const FObjectInitializer& ObjectInitializer) :
+	Super(ObjectInitializer),
+	BuiltTileCountX(0),
+	BuiltTileCountY(0),
+	BuiltTileSizeX(0),
+	BuiltTileSizeY(0),
+	BuiltDisplacementPadding(FVector::ZeroVector)
+{
+	TileCountX = 8;
+	TileCountY = 8;
+
+	TileSizeX = 1000;
+	TileSizeY = 1000;
+
+	// Estimated from the spectrum on register, until the GPU wave statistics take over
+	MaxDisplacement = FVector::ZeroVector;
+
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = true;
+	PrimaryComponentTick.bRunOnAnyThread = true;
+
+	bTickInEditor = true;
+	bAutoActivate = true;
+
+	// The cluster tree is built by this component with displacement padded bounds
+	bAutoRebuildTreeOnInstanceChanges = false;
+
+	RenderConfig.RenderTextureWidth = 512;
+	RenderConfig.RenderTextureHeight = 512;
+	RenderConfig.GerstnerWaveCount = 16;
+}
+
+void UOceanTileComponent::InitOceanTiles()
+{
+	PerInstanceSMData.Reset(TileCountX * TileCountY);
+
+	for (int32 Y = 0; Y < TileCountY; ++Y)
+	{
+		for (int32 X = 0; X < TileCountX; ++X)
+		{
+			FInstancedStaticMeshInstanceData& InstanceData = PerInstanceSMData.AddDefaulted_GetRef();
+			InstanceData.Transform = FTranslationMatrix(FVector(X * TileSizeX, Y * TileSizeY, 0));
+		}
+	}
+
+	BuiltTileCountX = TileCountX;
+	BuiltTileCountY = TileCountY;
+	BuiltTileSizeX = TileSizeX;
+	BuiltTileSizeY = TileSizeY;
+
+	BuildTileTree();
+}
+
+void UOceanTileComponent::SetMaxDisplacement(const FVector& InMaxDisplacement)
+{
+	MaxDisplacement = InMaxDisplacement.GetAbs();
+
+	if (IsRegistered() && IsDisplacementPaddingOutdated())
+	{
+		BuildTileTree();
+	}
+}
+
+bool UOceanTileComponent::IsOceanTilesOutdated() const
+{
+	bool bOutdated = PerInstanceSMData.Num() == 0;
+	bOutdated |= BuiltTileCountX != TileCountX;
+	bOutdated |= BuiltTileCountY != TileCountY;
+	bOutdated |= BuiltTileSizeX != TileSizeX;
+	bOutdated |= BuiltTileSizeY != TileSizeY;
+
+	return bOutdated;
+}
+
+bool UOceanTileComponent::IsDisplacementPaddingOutdated() const
+{
+	return FFTOcean::IsDisplacementPaddingOutdated(BuiltDisplacementPadding, MaxDisplacement);
+}
+
+void UOceanTileComponent::BuildTileTree()
+{
+	UStaticMesh* TileMesh = GetStaticMesh();
+
+	if (!TileMesh || PerInstanceSMData.Num() == 0)
+	{
+		return;
+	}
+
+	BuiltDisplacementPadding = FFTOcean::GetDisplacementPadding(MaxDisplacement);
+
+	// The default tree build uses the flat mesh bounds for every instance. Building it here with padded bounds gives
+	// each cluster node bounds that contain the displaced surface, so frustum and occlusion culling stay conservative.
+	const FBox PaddedMeshBox = TileMesh->GetBounds().GetBox().ExpandBy(BuiltDisplacementPadding);
+
+	TArray<FMatrix> InstanceTransforms;
+	InstanceTransforms.AddUninitialized(PerInstanceSMData.Num());
+
+	for (int32 Index = 0; Index < PerInstanceSMData.Num(); ++Index)
+	{
+		InstanceTransforms[Index] = PerInstanceSMData[Index].Transform;
+	}
+
+	TArray<FClusterNode> ClusterTree;
+	int32 OcclusionLayerNum = 0;
+
+	// Same result handling as BuildTree, the instance data keeps its order and the render data follows the reorder table
+	BuildTreeAnyThread(InstanceTransforms, PaddedMeshBox, ClusterTree, SortedInstances, InstanceReorderTable, OcclusionLayerNum, DesiredInstancesPerLeaf(), false);
+
+	NumBuiltInstances = InstanceReorderTable.Num();
+	NumBuiltRenderInstances = SortedInstances.Num();
+	OcclusionLayerNumNodes = OcclusionLayerNum;
+	BuiltInstanceBounds = ClusterTree.Num() > 0 ? FBox(ClusterTree[0].BoundMin, ClusterTree[0].BoundMax) : FBox(ForceInit);
+	UnbuiltInstanceBounds.Init();
+	UnbuiltInstanceBoundsList.Empty();
+	CacheMeshExtendedBounds = TileMesh->GetBounds();
+	ClusterTreePtr = MakeShareable(new TArray<FClusterNode>(MoveTemp(ClusterTree)));
+
+	InitPerInstanceRenderData(true);
+	MarkRenderStateDirty();
+}
+
+void UOceanTileComponent::OnRegister()
+{
+	Super::OnRegister();
+
+	SimulationDriver.Register(this, RenderConfig, DebugConfig, SimulationPolicy, [this](const FVector& InMaxDisplacement)
+	{
+		SetMaxDisplacement(InMaxDisplacement);
+	});
+
+	if (MaxDisplacement.IsZero())
+	{
+		MaxDisplacement = FFTOcean::EstimateMaxDisplacement(RenderConfig);
+	}
+
+	if (IsOceanTilesOutdated())
+	{
+		InitOceanTiles();
+	}
+	else if (IsDisplacementPaddingOutdated())
+	{
+		BuildTileTree();
+	}
+}
+
+#if WITH_EDITOR
+void UOceanTileComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	if (IsOceanTilesOutdated())
+	{
+		InitOceanTiles();
+	}
+	else if (IsDisplacementPaddingOutdated())
+	{
+		BuildTileTree();
+	}
+}
+#endif
+
+void UOceanTileComponent::RegisterComponentTickFunctions(bool bRegister)
+{
+	Super::RegisterComponentTickFunctions(bRegister);
+
+	SimulationDriver.RegisterTickFunction(bRegister);
+}
+
+void UOceanTileComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	SimulationDriver.BeginPlay();
+}
+
+void UOceanTileComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	SimulationDriver.EndPlay();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UOceanTileComponent::WarmUp()
+{
+	SimulationDriver.WarmUp();
+}
+
+void UOceanTileComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	SimulationDriver.Tick(DeltaTime);
+}
+
+void UOceanTileComponent::BakeFlipbook()
+{
+	FOceanSimulationDriver::BakeFlipbook(this, RenderConfig, FlipbookBakeSettings);
+}
+
+void UOceanTileComponent::TransitionSeaState(float WaveAmplitude, float WindVelocity, float WindDirection, float TransitionTime)
+{
+	FOceanSimulationDriver::TransitionSeaState(RenderConfig, WaveAmplitude, WindVelocity, WindDirection, TransitionTime);
+}
+
+void UOceanTileComponent::AddRadialImpulse(FVector2D Center, float Radius, float Amplitude)
+{
+	SimulationDriver.AddRadialImpulse(Center, Radius, Amplitude);
+}
+
+void UOceanTileComponent::AddWake(FVector2D Start, FVector2D End, float Width, float Amplitude)
+{
+	SimulationDriver.AddWake(Start, End, Width, Amplitude);
+}
+
+FOceanWaveStatistics UOceanTileComponent::GetWaveStatistics() const
+{
+	return SimulationDriver.GetWaveStatistics();
+}
+
+FOceanSnapshotRef UOceanTileComponent::GetSurfaceSnapshot() const
+{
+	return SimulationDriver.GetSurfaceSnapshot();
+}
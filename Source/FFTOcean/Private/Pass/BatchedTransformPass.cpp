@@ -0,0 +1,463 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "Pass/BatchedTransformPass.h"
+#include "FFTOcean.h"
+#include "RenderCore/Public/GlobalShader.h"
+#include "RenderCore/Public/ShaderParameterUtils.h"
+#include "RenderCore/Public/ShaderParameterMacros.h"
+
+#include "Public/GlobalShader.h"
+#include "Public/PipelineStateCache.h"
+#include "Public/RHIStaticStates.h"
+#include "Public/SceneUtils.h"
+#include "Public/SceneInterface.h"
+#include "Public/ShaderParameterUtils.h"
+#include "Public/Logging/MessageLog.h"
+#include "Public/Internationalization/Internationalization.h"
+#include "Public/StaticBoundShaderState.h"
+#include "RHI/Public/RHICommandList.h"
+
+#include "Classes/Engine/World.h"
+#include "Engine/Classes/Kismet/KismetRenderingLibrary.h"
+
+#include "Math/UnrealMathUtility.h"
+
+BEGIN_GLOBAL_SHADER_PARAMETER_STRUCT(FBatchedFourierComponentComputeShaderParameters, )
+	SHADER_PARAMETER(uint32, bComputeSlopes)
+END_GLOBAL_SHADER_PARAMETER_STRUCT()
+IMPLEMENT_GLOBAL_SHADER_PARAMETER_STRUCT(FBatchedFourierComponentComputeShaderParameters, "BatchedFourierComponentUniform");
+
+BEGIN_GLOBAL_SHADER_PARAMETER_STRUCT(FBatchedInverseTransformComputeShaderParameters, )
+	SHADER_PARAMETER(int, Stage)
+	SHADER_PARAMETER(int, StageCount)
+	SHADER_PARAMETER(int, Direction)
+END_GLOBAL_SHADER_PARAMETER_STRUCT()
+IMPLEMENT_GLOBAL_SHADER_PARAMETER_STRUCT(FBatchedInverseTransformComputeShaderParameters, "BatchedInverseTransformUniform");
+
+DECLARE_CYCLE_STAT(TEXT("Batched Transform"), STAT_FFTOcean_BatchedTransform, STATGROUP_FFTOcean);
+
+class FBatchedFourierComponentComputeShader : public FGlobalShader
+{
+	DECLARE_SHADER_TYPE(FBatchedFourierComponentComputeShader, Global)
+	using FParameters = FBatchedFourierComponentComputeShaderParameters;
+
+public:
+	FBatchedFourierComponentComputeShader() {}
+	FBatchedFourierComponentComputeShader(const ShaderMetaType::CompiledShaderInitializerType& Initializer)
+		: FGlobalShader(Initializer)
+	{
+		OutputSurfaceTextureXY.Bind(Initializer.ParameterMap, TEXT("OutputSurfaceTextureXY"));
+		OutputSurfaceTextureZ.Bind(Initializer.ParameterMap, TEXT("OutputSurfaceTextureZ"));
+		OutputSurfaceTextureJacobian.Bind(Initializer.ParameterMap, TEXT("OutputSurfaceTextureJacobian"));
+		OutputSurfaceTextureSlope.Bind(Initializer.ParameterMap, TEXT("OutputSurfaceTextureSlope"));
+		InputPhillipsFourierTexture.Bind(Initializer.ParameterMap, TEXT("InputPhillipsFourierTexture"));
+		InputIncomingPhillipsFourierTexture.Bind(Initializer.ParameterMap, TEXT("InputIncomingPhillipsFourierTexture"));
+		BatchInstances.Bind(Initializer.ParameterMap, TEXT("BatchInstances"));
+	}
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+
+	static bool ShouldCache(EShaderPlatform Platform)
+	{
+		return IsFeatureLevelSupported(Platform, ERHIFeatureLevel::SM5);
+	}
+
+	virtual bool Serialize(FArchive& Ar) override
+	{
+		bool bShaderHasOutdatedParameters = FGlobalShader::Serialize(Ar);
+		Ar << OutputSurfaceTextureXY << OutputSurfaceTextureZ << OutputSurfaceTextureJacobian << OutputSurfaceTextureSlope << InputPhillipsFourierTexture << InputIncomingPhillipsFourierTexture << BatchInstances;
+		return bShaderHasOutdatedParameters;
+	}
+
+	void BindShaderTextures(
+		FRHICommandList& RHICmdList,
+		FUnorderedAccessViewRHIRef OutputTextureXYUAV,
+		FUnorderedAccessViewRHIRef OutputTextureZUAV,
+		FUnorderedAccessViewRHIRef OutputTextureJacobianUAV,
+		FUnorderedAccessViewRHIRef OutputTextureSlopeUAV,
+		FShaderResourceViewRHIRef InputTextureSRV,
+		FShaderResourceViewRHIRef InputIncomingTextureSRV,
+		FShaderResourceViewRHIRef InstanceBufferSRV)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputSurfaceTextureXY, OutputTextureXYUAV);
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputSurfaceTextureZ, OutputTextureZUAV);
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputSurfaceTextureJacobian, OutputTextureJacobianUAV);
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputSurfaceTextureSlope, OutputTextureSlopeUAV);
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputPhillipsFourierTexture, InputTextureSRV);
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputIncomingPhillipsFourierTexture, InputIncomingTextureSRV);
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, BatchInstances, InstanceBufferSRV);
+	}
+
+	void UnbindShaderTextures(FRHICommandList& RHICmdList)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputSurfaceTextureXY, FUnorderedAccessViewRHIRef());
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputSurfaceTextureZ, FUnorderedAccessViewRHIRef());
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputSurfaceTextureJacobian, FUnorderedAccessViewRHIRef());
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputSurfaceTextureSlope, FUnorderedAccessViewRHIRef());
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputPhillipsFourierTexture, FShaderResourceViewRHIRef());
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputIncomingPhillipsFourierTexture, FShaderResourceViewRHIRef());
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, BatchInstances, FShaderResourceViewRHIRef());
+	}
+
+	void SetShaderParameters(FRHICommandList& RHICmdList, const FParameters& Parameters)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetUniformBufferParameterImmediate(RHICmdList, ComputeShaderRHI, GetUniformBufferParameter<FParameters>(), Parameters);
+	}
+
+private:
+
+	FShaderResourceParameter OutputSurfaceTextureXY;
+	FShaderResourceParameter OutputSurfaceTextureZ;
+	FShaderResourceParameter OutputSurfaceTextureJacobian;
+	FShaderResourceParameter OutputSurfaceTextureSlope;
+	FShaderResourceParameter InputPhillipsFourierTexture;
+	FShaderResourceParameter InputIncomingPhillipsFourierTexture;
+	FShaderResourceParameter BatchInstances;
+};
+
+IMPLEMENT_SHADER_TYPE(, FBatchedFourierComponentComputeShader, TEXT("/Plugin/FFTOcean/BatchedFourierComponentComputeShader.usf"), TEXT("ComputeBatchedFourierComponent"), SF_Compute);
+
+class FBatchedInverseTransformComputeShader : public FGlobalShader
+{
+	DECLARE_SHADER_TYPE(FBatchedInverseTransformComputeShader, Global)
+	using FParameters = FBatchedInverseTransformComputeShaderParameters;
+
+public:
+	FBatchedInverseTransformComputeShader() {}
+	FBatchedInverseTransformComputeShader(const ShaderMetaType::CompiledShaderInitializerType& Initializer)
+		: FGlobalShader(Initializer)
+	{
+		OutputInverseTransformTexture.Bind(Initializer.ParameterMap, TEXT("OutputInverseTransformTexture"));
+		InputTwiddleFactorsTexture.Bind(Initializer.ParameterMap, TEXT("InputTwiddleFactorsTexture"));
+		InputFourierComponentTexture.Bind(Initializer.ParameterMap, TEXT("InputFourierComponentTexture"));
+	}
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+
+	static bool ShouldCache(EShaderPlatform Platform)
+	{
+		return IsFeatureLevelSupported(Platform, ERHIFeatureLevel::SM5);
+	}
+
+	virtual bool Serialize(FArchive& Ar) override
+	{
+		bool bShaderHasOutdatedParameters = FGlobalShader::Serialize(Ar);
+		Ar << OutputInverseTransformTexture << InputTwiddleFactorsTexture << InputFourierComponentTexture;
+		return bShaderHasOutdatedParameters;
+	}
+
+	void BindShaderTextures(FRHICommandList& RHICmdList, FUnorderedAccessViewRHIRef OutputTextureUAV, FShaderResourceViewRHIRef InputTwiddleFactorsTextureSRV, FShaderResourceViewRHIRef InputFourierComponentTextureSRV)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputInverseTransformTexture, OutputTextureUAV);
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputTwiddleFactorsTexture, InputTwiddleFactorsTextureSRV);
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputFourierComponentTexture, InputFourierComponentTextureSRV);
+	}
+
+	void UnbindShaderTextures(FRHICommandList& RHICmdList)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputInverseTransformTexture, FUnorderedAccessViewRHIRef());
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputTwiddleFactorsTexture, FShaderResourceViewRHIRef());
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputFourierComponentTexture, FShaderResourceViewRHIRef());
+	}
+
+	void SetShaderUniformBuffer(FRHICommandList& RHICmdList, FRHIUniformBuffer* UniformBuffer)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetUniformBufferParameter(RHICmdList, ComputeShaderRHI, GetUniformBufferParameter<FParameters>(), UniformBuffer);
+	}
+
+private:
+
+	FShaderResourceParameter OutputInverseTransformTexture;
+	FShaderResourceParameter InputTwiddleFactorsTexture;
+	FShaderResourceParameter InputFourierComponentTexture;
+};
+
+IMPLEMENT_SHADER_TYPE(, FBatchedInverseTransformComputeShader, TEXT("/Plugin/FFTOcean/BatchedInverseTransformComputeShader.usf"), TEXT("ComputeBatchedInverseTransform"), SF_Compute);
+
+inline bool operator==(const FBatchedTransformPassConfig& A, const FBatchedTransformPassConfig& B)
+{
+	return FMemory::Memcmp(&A, &B, sizeof(FBatchedTransformPassConfig)) == 0;
+}
+
+inline bool operator!=(const FBatchedTransformPassConfig& A, const FBatchedTransformPassConfig& B)
+{
+	return !(A == B);
+}
+
+namespace
+{
+	void CopyTextureSlice(FRHICommandListImmediate& RHICmdList, FRHITexture* Source, uint32 SourceSlice, FRHITexture* Dest, uint32 DestSlice, uint32 Width, uint32 Height)
+	{
+		FRHICopyTextureInfo CopyInfo;
+		CopyInfo.Size = FIntVector(Width, Height, 1);
+		CopyInfo.SourceSliceIndex = SourceSlice;
+		CopyInfo.DestSliceIndex = DestSlice;
+
+		RHICmdList.CopyTexture(Source, Dest, CopyInfo);
+	}
+}
+
+FBatchedTransformPass::FBatchedTransformPass()
+{
+	FMemory::Memzero(Config);
+}
+
+FBatchedTransformPass::~FBatchedTransformPass()
+{
+	ReleaseRenderResource();
+}
+
+bool FBatchedTransformPass::IsValidPass() const
+{
+	bool bValid = Config.ComponentCount > 0 && Config.InstanceCount > 0;
+
+	for (int32 Index = 0; Index < OCEAN_SPECTRUM_COUNT; ++Index)
+	{
+		bValid &= !!PhillipsFourierTextures[Index];
+		bValid &= !!PhillipsFourierTextureSRVs[Index];
+	}
+
+	for (uint32 Index = 0; Index < Config.ComponentCount; ++Index)
+	{
+		bValid &= !!SurfaceTextures[Index];
+		bValid &= !!SurfaceTextureSRVs[Index];
+		bValid &= !!SurfaceTextureUAVs[Index];
+	}
+
+	bValid &= !!ScratchTexture;
+	bValid &= !!ScratchTextureSRV;
+	bValid &= !!ScratchTextureUAV;
+	bValid &= !!InstanceBuffer;
+	bValid &= !!InstanceBufferSRV;
+
+	return bValid;
+}
+
+void FBatchedTransformPass::ReleaseRenderResource()
+{
+	for (int32 Index = 0; Index < OCEAN_SPECTRUM_COUNT; ++Index)
+	{
+		SafeReleaseTextureResource(PhillipsFourierTextures[Index]);
+		SafeReleaseTextureResource(PhillipsFourierTextureSRVs[Index]);
+
+		SliceSpectrumTextures[Index].Reset();
+		SliceSpectrumParams[Index].Reset();
+	}
+
+	for (int32 Index = 0; Index < OCEAN_FOURIER_COMPONENT_COUNT; ++Index)
+	{
+		SafeReleaseTextureResource(SurfaceTextures[Index]);
+		SafeReleaseTextureResource(SurfaceTextureSRVs[Index]);
+		SafeReleaseTextureResource(SurfaceTextureUAVs[Index]);
+	}
+
+	SafeReleaseTextureResource(ScratchTexture);
+	SafeReleaseTextureResource(ScratchTextureSRV);
+	SafeReleaseTextureResource(ScratchTextureUAV);
+
+	SafeReleaseTextureResource(InstanceBuffer);
+	SafeReleaseTextureResource(InstanceBufferSRV);
+
+	StageUniformBuffers.Reset();
+}
+
+void FBatchedTransformPass::ConfigurePass(const FBatchedTransformPassConfig& InConfig)
+{
+	// Always release current resource before creating new render resources
+	ReleaseRenderResource();
+
+	Config = InConfig;
+
+	FRHIResourceCreateInfo CreateInfo;
+	uint32 TextureWidth = InConfig.TextureWidth;
+	uint32 TextureHeight = InConfig.TextureHeight;
+	uint32 InstanceCount = InConfig.InstanceCount;
+
+	for (int32 Index = 0; Index < OCEAN_SPECTRUM_COUNT; ++Index)
+	{
+		PhillipsFourierTextures[Index] = RHICreateTexture2DArray(TextureWidth, TextureHeight, InstanceCount, PF_G16R16F, 1, TexCreate_ShaderResource, CreateInfo);
+		PhillipsFourierTextureSRVs[Index] = RHICreateShaderResourceView(PhillipsFourierTextures[Index], 0);
+
+		SliceSpectrumTextures[Index].SetNum(InstanceCount);
+		SliceSpectrumParams[Index].SetNumZeroed(InstanceCount);
+	}
+
+	for (uint32 Index = 0; Index < InConfig.ComponentCount; ++Index)
+	{
+		SurfaceTextures[Index] = RHICreateTexture2DArray(TextureWidth, TextureHeight, InstanceCount, PF_G32R32F, 1, TexCreate_ShaderResource | TexCreate_UAV, CreateInfo);
+		SurfaceTextureSRVs[Index] = RHICreateShaderResourceView(SurfaceTextures[Index], 0);
+		SurfaceTextureUAVs[Index] = RHICreateUnorderedAccessView(SurfaceTextures[Index]);
+	}
+
+	ScratchTexture = RHICreateTexture2DArray(TextureWidth, TextureHeight, InstanceCount, PF_G32R32F, 1, TexCreate_ShaderResource | TexCreate_UAV, CreateInfo);
+	ScratchTextureSRV = RHICreateShaderResourceView(ScratchTexture, 0);
+	ScratchTextureUAV = RHICreateUnorderedAccessView(ScratchTexture);
+
+	InstanceBuffer = RHICreateStructuredBuffer(
+		sizeof(FVector4),                      // Stride
+		sizeof(FVector4) * InstanceCount,      // Size
+		BUF_Dynamic | BUF_ShaderResource,      // Usage
+		CreateInfo                             // Create info
+	);
+	InstanceBufferSRV = RHICreateShaderResourceView(InstanceBuffer);
+
+	const uint32 StageCount = StaticCast<uint32>(FMath::Log2(TextureHeight));
+
+	for (uint32 Direction = 0; Direction < 2; ++Direction)
+	{
+		for (uint32 Stage = 0; Stage < StageCount; ++Stage)
+		{
+			FBatchedInverseTransformComputeShader::FParameters UniformParam;
+			UniformParam.Stage = Stage;
+			UniformParam.StageCount = StageCount;
+			UniformParam.Direction = Direction;
+
+			StageUniformBuffers.Add(TUniformBufferRef<FBatchedInverseTransformComputeShader::FParameters>::CreateUniformBufferImmediate(UniformParam, UniformBuffer_MultiFrame));
+		}
+	}
+}
+
+void FBatchedTransformPass::Render(FRHICommandListImmediate& RHICmdList, const FBatchedTransformPassConfig& InConfig, const FBatchedTransformPassParam& Param)
+{
+	check(IsInRenderingThread());
+	check(StaticCast<uint32>(Param.Instances.Num()) <= InConfig.InstanceCount);
+
+	SCOPE_CYCLE_COUNTER(STAT_FFTOcean_BatchedTransform);
+
+	if (Config != InConfig)
+	{
+		ConfigurePass(InConfig);
+	}
+
+	if (IsValidPass() && Param.Instances.Num() > 0)
+	{
+		GatherSpectra(RHICmdList, Param);
+		RenderFourierComponents(RHICmdList, Param);
+		RenderInverseTransforms(RHICmdList, Param);
+		ScatterInverseTransforms(RHICmdList, Param);
+	}
+}
+
+void FBatchedTransformPass::GatherSpectra(FRHICommandListImmediate& RHICmdList, const FBatchedTransformPassParam& Param)
+{
+	// Spectra only change with the sea state, so most frames copy nothing here
+	for (int32 Slice = 0; Slice < Param.Instances.Num(); ++Slice)
+	{
+		const FBatchedTransformInstance& Instance = Param.Instances[Slice];
+
+		for (int32 Index = 0; Index < OCEAN_SPECTRUM_COUNT; ++Index)
+		{
+			FTexture2DRHIRef& SliceTexture = SliceSpectrumTextures[Index][Slice];
+			FPhillipsFourierPassParam& SliceParam = SliceSpectrumParams[Index][Slice];
+
+			// Holding the texture keeps its address unique, and a Phillips pass only regenerates a texture for another sea state
+			if (SliceTexture != Instance.PhillipsFourierTextures[Index] || FMemory::Memcmp(&SliceParam, &Instance.PhillipsFourierParams[Index], sizeof(FPhillipsFourierPassParam)) != 0)
+			{
+				CopyTextureSlice(RHICmdList, Instance.PhillipsFourierTextures[Index], 0, PhillipsFourierTextures[Index], Slice, Config.TextureWidth, Config.TextureHeight);
+
+				SliceTexture = Instance.PhillipsFourierTextures[Index];
+				SliceParam = Instance.PhillipsFourierParams[Index];
+			}
+		}
+	}
+}
+
+void FBatchedTransformPass::RenderFourierComponents(FRHICommandListImmediate& RHICmdList, const FBatchedTransformPassParam& Param)
+{
+	const uint32 InstanceCount = StaticCast<uint32>(Param.Instances.Num());
+
+	// Per slice parameters go up in one copy
+	FVector4* Instances = StaticCast<FVector4*>(RHILockStructuredBuffer(InstanceBuffer, 0, sizeof(FVector4) * InstanceCount, RLM_WriteOnly));
+	for (uint32 Slice = 0; Slice < InstanceCount; ++Slice)
+	{
+		const FBatchedTransformInstance& Instance = Param.Instances[Slice];
+		Instances[Slice] = FVector4(Instance.Time, Instance.LoopPeriod, Instance.SeaStateBlend, 0);
+	}
+	RHIUnlockStructuredBuffer(InstanceBuffer);
+
+	TShaderMapRef<FBatchedFourierComponentComputeShader> FourierComponentComputeShader(GetGlobalShaderMap(ERHIFeatureLevel::SM5));
+	RHICmdList.SetComputeShader(FourierComponentComputeShader->GetComputeShader());
+
+	// Bind shader textures
+	const bool bComputeSlopes = Config.ComponentCount > OCEAN_SLOPE_COMPONENT_INDEX;
+	FourierComponentComputeShader->BindShaderTextures(
+		RHICmdList,
+		SurfaceTextureUAVs[0],
+		SurfaceTextureUAVs[1],
+		SurfaceTextureUAVs[OCEAN_JACOBIAN_COMPONENT_INDEX],
+		bComputeSlopes ? SurfaceTextureUAVs[OCEAN_SLOPE_COMPONENT_INDEX] : FUnorderedAccessViewRHIRef(),
+		PhillipsFourierTextureSRVs[0],
+		PhillipsFourierTextureSRVs[1],
+		InstanceBufferSRV);
+
+	// Bind shader uniform
+	FBatchedFourierComponentComputeShader::FParameters UniformParam;
+	UniformParam.bComputeSlopes = bComputeSlopes ? 1 : 0;
+	FourierComponentComputeShader->SetShaderParameters(RHICmdList, UniformParam);
+
+	// Dispatch shader, one slice per ocean
+	const int ThreadGroupCountX = StaticCast<int>(Config.TextureWidth / 32);
+	const int ThreadGroupCountY = StaticCast<int>(Config.TextureHeight / 32);
+	DispatchComputeShader(RHICmdList, *FourierComponentComputeShader, ThreadGroupCountX, ThreadGroupCountY, InstanceCount);
+
+	// Unbind shader textures
+	FourierComponentComputeShader->UnbindShaderTextures(RHICmdList);
+}
+
+void FBatchedTransformPass::RenderInverseTransforms(FRHICommandListImmediate& RHICmdList, const FBatchedTransformPassParam& Param)
+{
+	TShaderMapRef<FBatchedInverseTransformComputeShader> InverseTransformComputeShader(GetGlobalShaderMap(ERHIFeatureLevel::SM5));
+	RHICmdList.SetComputeShader(InverseTransformComputeShader->GetComputeShader());
+
+	const int ThreadGroupCountX = StaticCast<int>(Config.TextureWidth / 32);
+	const int ThreadGroupCountY = StaticCast<int>(Config.TextureHeight / 32);
+	const int ThreadGroupCountZ = Param.Instances.Num();
+
+	for (uint32 Component = 0; Component < Config.ComponentCount; ++Component)
+	{
+		FShaderResourceViewRHIRef  PingPongTextureSRVs[2] = { SurfaceTextureSRVs[Component], ScratchTextureSRV };
+		FUnorderedAccessViewRHIRef PingPongTextureUAVs[2] = { SurfaceTextureUAVs[Component], ScratchTextureUAV };
+
+		// Both directions take the same number of stages, so the result always lands back in the component array
+		for (int32 FrameIndex = 0; FrameIndex < StageUniformBuffers.Num(); ++FrameIndex)
+		{
+			InverseTransformComputeShader->SetShaderUniformBuffer(RHICmdList, StageUniformBuffers[FrameIndex]);
+
+			const uint32 InputIndex = FrameIndex % 2;
+			const uint32 OutputIndex = (FrameIndex + 1) % 2;
+			InverseTransformComputeShader->BindShaderTextures(RHICmdList, PingPongTextureUAVs[OutputIndex], Param.TwiddleFactorsTextureSRV, PingPongTextureSRVs[InputIndex]);
+
+			DispatchComputeShader(RHICmdList, *InverseTransformComputeShader, ThreadGroupCountX, ThreadGroupCountY, ThreadGroupCountZ);
+
+			InverseTransformComputeShader->UnbindShaderTextures(RHICmdList);
+		}
+	}
+}
+
+void FBatchedTransformPass::ScatterInverseTransforms(FRHICommandListImmediate& RHICmdList, const FBatchedTransformPassParam& Param)
+{
+	// Copies, not dispatches: every ocean then builds its surface from its own inverse transform textures as usual
+	for (int32 Slice = 0; Slice < Param.Instances.Num(); ++Slice)
+	{
+		const FBatchedTransformInstance& Instance = Param.Instances[Slice];
+
+		for (uint32 Component = 0; Component < Config.ComponentCount; ++Component)
+		{
+			CopyTextureSlice(RHICmdList, SurfaceTextures[Component], Slice, Instance.InverseTransformTextures[Component], 0, Config.TextureWidth, Config.TextureHeight);
+		}
+	}
+}
\ No newline at end of file
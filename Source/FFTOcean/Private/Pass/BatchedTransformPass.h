@@ -0,0 +1,95 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Pass/PassUtil.h"
+#include "Pass/PhillipsFourierPass.h"
+
+// Most oceans transformed by one batch, larger groups are split into several batches
+#define OCEAN_MAX_BATCH_INSTANCE_COUNT 16
+
+struct FBatchedTransformPassConfig
+{
+	uint32 TextureWidth;
+	uint32 TextureHeight;
+	uint32 ComponentCount;
+	// Slices of every texture array, at least the number of oceans of a batch
+	uint32 InstanceCount;
+};
+
+// One ocean of a batch, its spectra come from its own Phillips pass and its transforms go back to its own pass chain
+struct FBatchedTransformInstance
+{
+	float Time;
+	float LoopPeriod;
+	float SeaStateBlend;
+
+	// Outgoing then incoming h0 spectrum, along with the sea state they were generated for
+	FTexture2DRHIRef          PhillipsFourierTextures[OCEAN_SPECTRUM_COUNT];
+	FPhillipsFourierPassParam PhillipsFourierParams[OCEAN_SPECTRUM_COUNT];
+
+	FTexture2DRHIRef InverseTransformTextures[OCEAN_FOURIER_COMPONENT_COUNT];
+};
+
+struct FBatchedTransformPassParam
+{
+	TArrayView<const FBatchedTransformInstance> Instances;
+
+	// Every ocean of the same size shares the same twiddle factors
+	FShaderResourceViewRHIRef TwiddleFactorsTextureSRV;
+};
+
+// Fourier components and inverse transforms of several oceans of the same size, one texture array slice per ocean.
+// Every dispatch covers the whole batch, so the dispatch count doesn't depend on the number of oceans.
+class FBatchedTransformPass final : public FOceanRenderPass
+{
+public:
+
+	FBatchedTransformPass();
+	~FBatchedTransformPass();
+
+	virtual bool IsValidPass() const override;
+	virtual void ReleaseRenderResource() override;
+
+	void Render(FRHICommandListImmediate& RHICmdList, const FBatchedTransformPassConfig& InConfig, const FBatchedTransformPassParam& Param);
+
+	FORCEINLINE const FBatchedTransformPassConfig& GetConfig() const
+	{
+		return Config;
+	}
+
+private:
+
+	// h0 spectra gathered from the oceans, outgoing then incoming
+	FTexture2DArrayRHIRef     PhillipsFourierTextures[OCEAN_SPECTRUM_COUNT];
+	FShaderResourceViewRHIRef PhillipsFourierTextureSRVs[OCEAN_SPECTRUM_COUNT];
+
+	// What each slice of the spectra holds, so an unchanged spectrum isn't copied again
+	TArray<FTexture2DRHIRef>          SliceSpectrumTextures[OCEAN_SPECTRUM_COUNT];
+	TArray<FPhillipsFourierPassParam> SliceSpectrumParams[OCEAN_SPECTRUM_COUNT];
+
+	// Fourier components, the inverse transform ping pongs between them and the scratch array
+	FTexture2DArrayRHIRef      SurfaceTextures[OCEAN_FOURIER_COMPONENT_COUNT];
+	FShaderResourceViewRHIRef  SurfaceTextureSRVs[OCEAN_FOURIER_COMPONENT_COUNT];
+	FUnorderedAccessViewRHIRef SurfaceTextureUAVs[OCEAN_FOURIER_COMPONENT_COUNT];
+
+	FTexture2DArrayRHIRef      ScratchTexture;
+	FShaderResourceViewRHIRef  ScratchTextureSRV;
+	FUnorderedAccessViewRHIRef ScratchTextureUAV;
+
+	// Time, loop period and sea state blend of every slice
+	FStructuredBufferRHIRef   InstanceBuffer;
+	FShaderResourceViewRHIRef InstanceBufferSRV;
+
+	// Stage parameters of the horizontal then the vertical stages
+	TArray<FUniformBufferRHIRef> StageUniformBuffers;
+
+	FBatchedTransformPassConfig Config;
+
+	void ConfigurePass(const FBatchedTransformPassConfig& InConfig);
+
+	void GatherSpectra(FRHICommandListImmediate& RHICmdList, const FBatchedTransformPassParam& Param);
+	void RenderFourierComponents(FRHICommandListImmediate& RHICmdList, const FBatchedTransformPassParam& Param);
+	void RenderInverseTransforms(FRHICommandListImmediate& RHICmdList, const FBatchedTransformPassParam& Param);
+	void ScatterInverseTransforms(FRHICommandListImmediate& RHICmdList, const FBatchedTransformPassParam& Param);
+};
\ No newline at end of file
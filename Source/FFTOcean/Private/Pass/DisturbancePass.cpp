@@ -0,0 +1,306 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "Pass/DisturbancePass.h"
+#include "RenderCore/Public/GlobalShader.h"
+#include "RenderCore/Public/ShaderParameterUtils.h"
+#include "RenderCore/Public/ShaderParameterMacros.h"
+
+#include "Public/GlobalShader.h"
+#include "Public/PipelineStateCache.h"
+#include "Public/RHIStaticStates.h"
+#include "Public/SceneUtils.h"
+#include "Public/SceneInterface.h"
+#include "Public/ShaderParameterUtils.h"
+#include "Public/Logging/MessageLog.h"
+#include "Public/Internationalization/Internationalization.h"
+#include "Public/StaticBoundShaderState.h"
+#include "RHI/Public/RHICommandList.h"
+
+#include "Classes/Engine/World.h"
+#include "Engine/Classes/Kismet/KismetRenderingLibrary.h"
+
+#include "Math/UnrealMathUtility.h"
+
+// Smallest disturbance buffer allocation, in disturbances
+#define OCEAN_MIN_DISTURBANCE_BUFFER_CAPACITY 64
+
+BEGIN_GLOBAL_SHADER_PARAMETER_STRUCT(FDisturbanceComputeShaderParameters, )
+	SHADER_PARAMETER(uint32, DisturbanceCount)
+	SHADER_PARAMETER(float,  NormalStrength)
+END_GLOBAL_SHADER_PARAMETER_STRUCT()
+IMPLEMENT_GLOBAL_SHADER_PARAMETER_STRUCT(FDisturbanceComputeShaderParameters, "DisturbanceUniform");
+
+class FDisturbanceComputeShader : public FGlobalShader
+{
+	DECLARE_SHADER_TYPE(FDisturbanceComputeShader, Global);
+	using FParameters = FDisturbanceComputeShaderParameters;
+
+public:
+
+	FDisturbanceComputeShader() {}
+	FDisturbanceComputeShader(const ShaderMetaType::CompiledShaderInitializerType& Initializer) :
+		FGlobalShader(Initializer)
+	{
+		InputDisplacementTexture.Bind(Initializer.ParameterMap, TEXT("InputDisplacementTexture"));
+		InputNormalTexture.Bind(Initializer.ParameterMap, TEXT("InputNormalTexture"));
+		OutputDisplacementTexture.Bind(Initializer.ParameterMap, TEXT("OutputDisplacementTexture"));
+		OutputNormalTexture.Bind(Initializer.ParameterMap, TEXT("OutputNormalTexture"));
+		DisturbanceSegments.Bind(Initializer.ParameterMap, TEXT("DisturbanceSegments"));
+		DisturbanceShapes.Bind(Initializer.ParameterMap, TEXT("DisturbanceShapes"));
+	}
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+
+	static void ModifyCompilationEnvironment(const FGlobalShaderPermutationParameters& Parameters, FShaderCompilerEnvironment& OutEnvironment)
+	{
+		FGlobalShader::ModifyCompilationEnvironment(Parameters, OutEnvironment);
+	}
+
+	virtual bool Serialize(FArchive& Ar) override
+	{
+		bool bShaderHasOutdatedParameters = FGlobalShader::Serialize(Ar);
+
+		Ar << InputDisplacementTexture;
+		Ar << InputNormalTexture;
+		Ar << OutputDisplacementTexture;
+		Ar << OutputNormalTexture;
+		Ar << DisturbanceSegments;
+		Ar << DisturbanceShapes;
+
+		return bShaderHasOutdatedParameters;
+	}
+
+	void BindShaderTextures(
+		FRHICommandList& RHICmdList,
+		FShaderResourceViewRHIRef InputDisplacementTextureSRV,
+		FShaderResourceViewRHIRef InputNormalTextureSRV,
+		FUnorderedAccessViewRHIRef DisplacementTextureUAV,
+		FUnorderedAccessViewRHIRef NormalTextureUAV,
+		FShaderResourceViewRHIRef SegmentBufferSRV,
+		FShaderResourceViewRHIRef ShapeBufferSRV)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputDisplacementTexture, InputDisplacementTextureSRV);
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputNormalTexture, InputNormalTextureSRV);
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputDisplacementTexture, DisplacementTextureUAV);
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputNormalTexture, NormalTextureUAV);
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, DisturbanceSegments, SegmentBufferSRV);
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, DisturbanceShapes, ShapeBufferSRV);
+	}
+
+	void UnbindShaderTextures(FRHICommandList& RHICmdList)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputDisplacementTexture, FShaderResourceViewRHIRef());
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputNormalTexture, FShaderResourceViewRHIRef());
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputDisplacementTexture, FUnorderedAccessViewRHIRef());
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputNormalTexture, FUnorderedAccessViewRHIRef());
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, DisturbanceSegments, FShaderResourceViewRHIRef());
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, DisturbanceShapes, FShaderResourceViewRHIRef());
+	}
+
+	void SetShaderParameters(FRHICommandList& RHICmdList, const FParameters& Parameters)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetUniformBufferParameterImmediate(RHICmdList, ComputeShaderRHI, GetUniformBufferParameter<FParameters>(), Parameters);
+	}
+
+private:
+
+	FShaderResourceParameter InputDisplacementTexture;
+	FShaderResourceParameter InputNormalTexture;
+	FShaderResourceParameter OutputDisplacementTexture;
+	FShaderResourceParameter OutputNormalTexture;
+	FShaderResourceParameter DisturbanceSegments;
+	FShaderResourceParameter DisturbanceShapes;
+};
+
+IMPLEMENT_SHADER_TYPE(, FDisturbanceComputeShader, TEXT("/Plugin/FFTOcean/DisturbanceComputeShader.usf"), TEXT("ComputeDisturbance"), SF_Compute)
+
+inline bool operator==(const FDisturbancePassConfig& A, const FDisturbancePassConfig& B)
+{
+	return FMemory::Memcmp(&A, &B, sizeof(FDisturbancePassConfig)) == 0;
+}
+
+inline bool operator!=(const FDisturbancePassConfig& A, const FDisturbancePassConfig& B)
+{
+	return !(A == B);
+}
+
+namespace
+{
+	void UploadDisturbanceArray(FStructuredBufferRHIRef Buffer, const TArrayView<const FVector4>& Values)
+	{
+		const uint32 Size = sizeof(FVector4) * Values.Num();
+
+		void* Data = RHILockStructuredBuffer(Buffer, 0, Size, RLM_WriteOnly);
+		FMemory::Memcpy(Data, Values.GetData(), Size);
+		RHIUnlockStructuredBuffer(Buffer);
+	}
+
+	void CopyFirstMip(FRHICommandListImmediate& RHICmdList, FRHITexture* Source, FRHITexture* Dest, uint32 Width, uint32 Height)
+	{
+		FRHICopyTextureInfo CopyInfo;
+		CopyInfo.Size = FIntVector(Width, Height, 1);
+
+		RHICmdList.CopyTexture(Source, Dest, CopyInfo);
+	}
+}
+
+FDisturbancePass::FDisturbancePass() :
+	BufferCapacity(0)
+{
+
+}
+
+FDisturbancePass::~FDisturbancePass()
+{
+	ReleaseRenderResource();
+}
+
+bool FDisturbancePass::IsValidPass() const
+{
+	bool bValid = !!OutputDisplacementTexture;
+	bValid &= !!OutputDisplacementTextureUAV;
+	bValid &= !!OutputNormalTexture;
+	bValid &= !!OutputNormalTextureUAV;
+	bValid &= !!DisturbanceSegmentBuffer;
+	bValid &= !!DisturbanceSegmentBufferSRV;
+	bValid &= !!DisturbanceShapeBuffer;
+	bValid &= !!DisturbanceShapeBufferSRV;
+
+	return bValid;
+}
+
+void FDisturbancePass::ReleaseRenderResource()
+{
+	SafeReleaseTextureResource(OutputDisplacementTexture);
+	SafeReleaseTextureResource(OutputDisplacementTextureUAV);
+	SafeReleaseTextureResource(OutputNormalTexture);
+	SafeReleaseTextureResource(OutputNormalTextureUAV);
+	SafeReleaseTextureResource(DisturbanceSegmentBuffer);
+	SafeReleaseTextureResource(DisturbanceSegmentBufferSRV);
+	SafeReleaseTextureResource(DisturbanceShapeBuffer);
+	SafeReleaseTextureResource(DisturbanceShapeBufferSRV);
+
+	BufferCapacity = 0;
+}
+
+void FDisturbancePass::Prepare(const FDisturbancePassConfig& InConfig)
+{
+	if (Config != InConfig)
+	{
+		ConfigurePass(InConfig);
+	}
+}
+
+void FDisturbancePass::Render(FRHICommandListImmediate& RHICmdList, const FDisturbancePassConfig& InConfig, const FDisturbancePassParam& Param)
+{
+	check(IsInRenderingThread());
+	check(Param.DisturbanceSegments.Num() == Param.DisturbanceShapes.Num());
+
+	if (Config != InConfig)
+	{
+		ConfigurePass(InConfig);
+	}
+
+	const uint32 DisturbanceCount = StaticCast<uint32>(Param.DisturbanceSegments.Num());
+
+	// Calm frames cost nothing, not even the upload
+	if (DisturbanceCount == 0)
+	{
+		return;
+	}
+
+	if (DisturbanceCount > BufferCapacity)
+	{
+		CreateBuffers(FMath::RoundUpToPowerOfTwo(DisturbanceCount));
+	}
+
+	if (IsValidPass())
+	{
+		// Both arrays go up once per frame, whatever the number of disturbances
+		UploadDisturbanceArray(DisturbanceSegmentBuffer, Param.DisturbanceSegments);
+		UploadDisturbanceArray(DisturbanceShapeBuffer, Param.DisturbanceShapes);
+
+		// Set up compute shader
+		TShaderMapRef<FDisturbanceComputeShader> DisturbanceComputeShader(GetGlobalShaderMap(ERHIFeatureLevel::SM5));
+		RHICmdList.SetComputeShader(DisturbanceComputeShader->GetComputeShader());
+
+		// Bind shader textures
+		DisturbanceComputeShader->BindShaderTextures(
+			RHICmdList,
+			Param.DisplacementTextureSRV,
+			Param.NormalTextureSRV,
+			OutputDisplacementTextureUAV,
+			OutputNormalTextureUAV,
+			DisturbanceSegmentBufferSRV,
+			DisturbanceShapeBufferSRV);
+
+		// Bind shader uniform
+		FDisturbanceComputeShader::FParameters UniformParam;
+		UniformParam.DisturbanceCount = DisturbanceCount;
+		UniformParam.NormalStrength = Param.NormalStrength;
+		DisturbanceComputeShader->SetShaderParameters(RHICmdList, UniformParam);
+
+		// Dispatch shader, one group per binning tile
+		const int ThreadGroupCountX = StaticCast<int>(Config.TextureWidth / 32);
+		const int ThreadGroupCountY = StaticCast<int>(Config.TextureHeight / 32);
+		DispatchComputeShader(RHICmdList, *DisturbanceComputeShader, ThreadGroupCountX, ThreadGroupCountY, 1);
+
+		// Unbind shader textures
+		DisturbanceComputeShader->UnbindShaderTextures(RHICmdList);
+
+		// Every texel was written, so the disturbed surface replaces the first mip and the mip chain pass builds on it
+		CopyFirstMip(RHICmdList, OutputDisplacementTexture, Param.DisplacementTexture, Config.TextureWidth, Config.TextureHeight);
+		CopyFirstMip(RHICmdList, OutputNormalTexture, Param.NormalTexture, Config.TextureWidth, Config.TextureHeight);
+	}
+}
+
+void FDisturbancePass::ConfigurePass(const FDisturbancePassConfig& InConfig)
+{
+	// Always release current resource before creating new render resources
+	ReleaseRenderResource();
+
+	Config = InConfig;
+
+	FRHIResourceCreateInfo CreateInfo;
+
+	OutputDisplacementTexture = RHICreateTexture2D(Config.TextureWidth, Config.TextureHeight, PF_FloatRGBA, 1, 1, TexCreate_ShaderResource | TexCreate_UAV, CreateInfo);
+	OutputDisplacementTextureUAV = RHICreateUnorderedAccessView(OutputDisplacementTexture);
+	OutputNormalTexture = RHICreateTexture2D(Config.TextureWidth, Config.TextureHeight, PF_FloatRGBA, 1, 1, TexCreate_ShaderResource | TexCreate_UAV, CreateInfo);
+	OutputNormalTextureUAV = RHICreateUnorderedAccessView(OutputNormalTexture);
+
+	CreateBuffers(OCEAN_MIN_DISTURBANCE_BUFFER_CAPACITY);
+}
+
+void FDisturbancePass::CreateBuffers(uint32 Capacity)
+{
+	SafeReleaseTextureResource(DisturbanceSegmentBuffer);
+	SafeReleaseTextureResource(DisturbanceSegmentBufferSRV);
+	SafeReleaseTextureResource(DisturbanceShapeBuffer);
+	SafeReleaseTextureResource(DisturbanceShapeBufferSRV);
+
+	BufferCapacity = FMath::Max<uint32>(Capacity, OCEAN_MIN_DISTURBANCE_BUFFER_CAPACITY);
+
+	FRHIResourceCreateInfo CreateInfo;
+
+	DisturbanceSegmentBuffer = RHICreateStructuredBuffer(
+		sizeof(FVector4),                      // Stride
+		sizeof(FVector4) * BufferCapacity,     // Size
+		BUF_Dynamic | BUF_ShaderResource,      // Usage
+		CreateInfo                             // Create info
+	);
+	DisturbanceSegmentBufferSRV = RHICreateShaderResourceView(DisturbanceSegmentBuffer);
+
+	DisturbanceShapeBuffer = RHICreateStructuredBuffer(
+		sizeof(FVector4),                      // Stride
+		sizeof(FVector4) * BufferCapacity,     // Size
+		BUF_Dynamic | BUF_ShaderResource,      // Usage
+		CreateInfo                             // Create info
+	);
+	DisturbanceShapeBufferSRV = RHICreateShaderResourceView(DisturbanceShapeBuffer);
+}
\ No newline at end of file
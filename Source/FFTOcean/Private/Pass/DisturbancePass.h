@@ -0,0 +1,64 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Pass/PassUtil.h"
+
+struct FDisturbancePassConfig
+{
+	uint32 TextureWidth;
+	uint32 TextureHeight;
+};
+
+struct FDisturbancePassParam
+{
+	// One entry per disturbance in each array: start and end of the segment, then radius, amplitude and start amplitude scale
+	TArrayView<const FVector4> DisturbanceSegments;
+	TArrayView<const FVector4> DisturbanceShapes;
+
+	float NormalStrength;
+
+	// Read through the SRVs, then the disturbed surface is copied back into the first mip of the textures
+	FTexture2DRHIRef          DisplacementTexture;
+	FShaderResourceViewRHIRef DisplacementTextureSRV;
+	FTexture2DRHIRef          NormalTexture;
+	FShaderResourceViewRHIRef NormalTextureSRV;
+};
+
+// Adds every disturbance of the frame onto the displacement and normal textures in a single dispatch.
+// Each 32x32 tile first bins the disturbances overlapping it into group shared memory, then only evaluates those.
+// The sum goes to textures of the pass, since typed UAV loads of half float textures aren't available everywhere.
+class FDisturbancePass final : public FOceanRenderPass
+{
+public:
+
+	FDisturbancePass();
+	~FDisturbancePass();
+
+	virtual bool IsValidPass() const override;
+	virtual void ReleaseRenderResource() override;
+
+	void Render(FRHICommandListImmediate& RHICmdList, const FDisturbancePassConfig& InConfig, const FDisturbancePassParam& Param);
+
+	// Creates the output textures and disturbance buffers ahead of the first render
+	void Prepare(const FDisturbancePassConfig& InConfig);
+
+private:
+
+	FDisturbancePassConfig Config;
+
+	FTexture2DRHIRef           OutputDisplacementTexture;
+	FUnorderedAccessViewRHIRef OutputDisplacementTextureUAV;
+	FTexture2DRHIRef           OutputNormalTexture;
+	FUnorderedAccessViewRHIRef OutputNormalTextureUAV;
+
+	// Grown to the largest disturbance count seen so far, then reused every frame
+	uint32                    BufferCapacity;
+	FStructuredBufferRHIRef   DisturbanceSegmentBuffer;
+	FShaderResourceViewRHIRef DisturbanceSegmentBufferSRV;
+	FStructuredBufferRHIRef   DisturbanceShapeBuffer;
+	FShaderResourceViewRHIRef DisturbanceShapeBufferSRV;
+
+	void ConfigurePass(const FDisturbancePassConfig& InConfig);
+	void CreateBuffers(uint32 Capacity);
+};
\ No newline at end of file
@@ -0,0 +1,183 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "Pass/FlipbookPlaybackPass.h"
+#include "RenderCore/Public/GlobalShader.h"
+#include "RenderCore/Public/ShaderParameterUtils.h"
+#include "RenderCore/Public/ShaderParameterMacros.h"
+
+#include "Public/GlobalShader.h"
+#include "Public/PipelineStateCache.h"
+#include "Public/RHIStaticStates.h"
+#include "Public/ShaderParameterUtils.h"
+#include "RHI/Public/RHICommandList.h"
+
+BEGIN_GLOBAL_SHADER_PARAMETER_STRUCT(FFlipbookPlaybackComputeShaderParameters, )
+	SHADER_PARAMETER(uint32, FrameA)
+	SHADER_PARAMETER(uint32, FrameB)
+	SHADER_PARAMETER(float,  FrameBlend)
+END_GLOBAL_SHADER_PARAMETER_STRUCT()
+IMPLEMENT_GLOBAL_SHADER_PARAMETER_STRUCT(FFlipbookPlaybackComputeShaderParameters, "FlipbookPlaybackUniform");
+
+class FFlipbookPlaybackComputeShader : public FGlobalShader
+{
+	DECLARE_SHADER_TYPE(FFlipbookPlaybackComputeShader, Global);
+	using FParameters = FFlipbookPlaybackComputeShaderParameters;
+
+public:
+
+	FFlipbookPlaybackComputeShader() {}
+	FFlipbookPlaybackComputeShader(const ShaderMetaType::CompiledShaderInitializerType& Initializer) :
+		FGlobalShader(Initializer)
+	{
+		InputDisplacementFlipbook.Bind(Initializer.ParameterMap, TEXT("InputDisplacementFlipbook"));
+		InputNormalFlipbook.Bind(Initializer.ParameterMap, TEXT("InputNormalFlipbook"));
+		OutputDisplacementTexture.Bind(Initializer.ParameterMap, TEXT("OutputDisplacementTexture"));
+		OutputNormalTexture.Bind(Initializer.ParameterMap, TEXT("OutputNormalTexture"));
+	}
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+
+	virtual bool Serialize(FArchive& Ar) override
+	{
+		bool bShaderHasOutdatedParameters = FGlobalShader::Serialize(Ar);
+
+		Ar << InputDisplacementFlipbook;
+		Ar << InputNormalFlipbook;
+		Ar << OutputDisplacementTexture;
+		Ar << OutputNormalTexture;
+
+		return bShaderHasOutdatedParameters;
+	}
+
+	void BindShaderTextures(
+		FRHICommandList& RHICmdList,
+		FRHITexture* DisplacementFlipbook,
+		FRHITexture* NormalFlipbook,
+		FUnorderedAccessViewRHIRef DisplacementOutputTextureUAV,
+		FUnorderedAccessViewRHIRef NormalOutputTextureUAV)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetTextureParameter(RHICmdList, ComputeShaderRHI, InputDisplacementFlipbook, DisplacementFlipbook);
+		SetTextureParameter(RHICmdList, ComputeShaderRHI, InputNormalFlipbook, NormalFlipbook);
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputDisplacementTexture, DisplacementOutputTextureUAV);
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputNormalTexture, NormalOutputTextureUAV);
+	}
+
+	void UnbindShaderTextures(FRHICommandList& RHICmdList)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputDisplacementTexture, FUnorderedAccessViewRHIRef());
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputNormalTexture, FUnorderedAccessViewRHIRef());
+	}
+
+	void SetShaderParameters(FRHICommandList& RHICmdList, const FParameters& Parameters)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetUniformBufferParameterImmediate(RHICmdList, ComputeShaderRHI, GetUniformBufferParameter<FParameters>(), Parameters);
+	}
+
+private:
+
+	FShaderResourceParameter InputDisplacementFlipbook;
+	FShaderResourceParameter InputNormalFlipbook;
+	FShaderResourceParameter OutputDisplacementTexture;
+	FShaderResourceParameter OutputNormalTexture;
+};
+
+IMPLEMENT_SHADER_TYPE(, FFlipbookPlaybackComputeShader, TEXT("/Plugin/FFTOcean/FlipbookPlaybackComputeShader.usf"), TEXT("ComputeFlipbookPlayback"), SF_Compute)
+
+inline bool operator==(const FFlipbookPlaybackPassConfig& A, const FFlipbookPlaybackPassConfig& B)
+{
+	return FMemory::Memcmp(&A, &B, sizeof(FFlipbookPlaybackPassConfig)) == 0;
+}
+
+inline bool operator!=(const FFlipbookPlaybackPassConfig& A, const FFlipbookPlaybackPassConfig& B)
+{
+	return !(A == B);
+}
+
+FFlipbookPlaybackPass::FFlipbookPlaybackPass()
+{
+	FMemory::Memzero(Config);
+}
+
+FFlipbookPlaybackPass::~FFlipbookPlaybackPass()
+{
+	ReleaseRenderResource();
+}
+
+bool FFlipbookPlaybackPass::IsValidPass() const
+{
+	bool bValid = !!OutputDisplacementTexture;
+	bValid &= !!OutputDisplacementTextureUAV;
+	bValid &= !!OutputNormalTexture;
+	bValid &= !!OutputNormalTextureUAV;
+
+	return bValid;
+}
+
+void FFlipbookPlaybackPass::ReleaseRenderResource()
+{
+	SafeReleaseTextureResource(OutputDisplacementTexture);
+	SafeReleaseTextureResource(OutputDisplacementTextureUAV);
+	SafeReleaseTextureResource(OutputNormalTexture);
+	SafeReleaseTextureResource(OutputNormalTextureUAV);
+}
+
+void FFlipbookPlaybackPass::Render(FRHICommandListImmediate& RHICmdList, const FFlipbookPlaybackPassConfig& InConfig, const FFlipbookPlaybackPassParam& Param)
+{
+	check(IsInRenderingThread());
+
+	if (Config != InConfig)
+	{
+		ConfigurePass(InConfig);
+	}
+
+	if (IsValidPass() && Param.DisplacementFlipbook && Param.NormalFlipbook)
+	{
+		TShaderMapRef<FFlipbookPlaybackComputeShader> FlipbookPlaybackComputeShader(GetGlobalShaderMap(ERHIFeatureLevel::SM5));
+		RHICmdList.SetComputeShader(FlipbookPlaybackComputeShader->GetComputeShader());
+
+		// Bind shader textures
+		FlipbookPlaybackComputeShader->BindShaderTextures(RHICmdList, Param.DisplacementFlipbook, Param.NormalFlipbook, OutputDisplacementTextureUAV, OutputNormalTextureUAV);
+
+		// Bind shader uniform
+		FFlipbookPlaybackComputeShader::FParameters UniformParam;
+		UniformParam.FrameA = Param.FrameA;
+		UniformParam.FrameB = Param.FrameB;
+		UniformParam.FrameBlend = Param.FrameBlend;
+		FlipbookPlaybackComputeShader->SetShaderParameters(RHICmdList, UniformParam);
+
+		// Dispatch shader
+		const int ThreadGroupCountX = StaticCast<int>(Config.TextureWidth / 32);
+		const int ThreadGroupCountY = StaticCast<int>(Config.TextureHeight / 32);
+		DispatchComputeShader(RHICmdList, *FlipbookPlaybackComputeShader, ThreadGroupCountX, ThreadGroupCountY, 1);
+
+		// Unbind shader textures
+		FlipbookPlaybackComputeShader->UnbindShaderTextures(RHICmdList);
+	}
+}
+
+void FFlipbookPlaybackPass::ConfigurePass(const FFlipbookPlaybackPassConfig& InConfig)
+{
+	// Always release current resource before creating new render resources
+	ReleaseRenderResource();
+
+	Config = InConfig;
+
+	FRHIResourceCreateInfo CreateInfo;
+	uint32 TextureWidth = InConfig.TextureWidth;
+	uint32 TextureHeight = InConfig.TextureHeight;
+
+	// Same layout as the simulated surface, so the mip chain pass can take over from here
+	uint32 MipCount = FFTOcean::GetMipCount(TextureWidth, TextureHeight);
+
+	OutputDisplacementTexture = RHICreateTexture2D(TextureWidth, TextureHeight, PF_FloatRGBA, MipCount, 1, TexCreate_ShaderResource | TexCreate_UAV, CreateInfo);
+	OutputDisplacementTextureUAV = RHICreateUnorderedAccessView(OutputDisplacementTexture);
+
+	OutputNormalTexture = RHICreateTexture2D(TextureWidth, TextureHeight, PF_FloatRGBA, MipCount, 1, TexCreate_ShaderResource | TexCreate_UAV, CreateInfo);
+	OutputNormalTextureUAV = RHICreateUnorderedAccessView(OutputNormalTexture);
+}
\ No newline at end of file
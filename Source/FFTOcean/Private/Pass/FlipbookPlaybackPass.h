@@ -0,0 +1,57 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Pass/PassUtil.h"
+
+struct FFlipbookPlaybackPassConfig
+{
+	uint32 TextureWidth;
+	uint32 TextureHeight;
+};
+
+struct FFlipbookPlaybackPassParam
+{
+	// Texture arrays with one slice per baked frame
+	FRHITexture* DisplacementFlipbook;
+	FRHITexture* NormalFlipbook;
+
+	uint32 FrameA;
+	uint32 FrameB;
+	float  FrameBlend;
+};
+
+// Replaces the whole simulation with two texture array fetches per texel, for platforms that can't afford the FFT
+class FFlipbookPlaybackPass final : public FOceanRenderPass
+{
+public:
+
+	FFlipbookPlaybackPass();
+	~FFlipbookPlaybackPass();
+
+	virtual bool IsValidPass() const override;
+	virtual void ReleaseRenderResource() override;
+
+	void Render(FRHICommandListImmediate& RHICmdList, const FFlipbookPlaybackPassConfig& InConfig, const FFlipbookPlaybackPassParam& Param);
+
+	FORCEINLINE FTexture2DRHIRef GetDisplacementTexture() const
+	{
+		return OutputDisplacementTexture;
+	}
+
+	FORCEINLINE FTexture2DRHIRef GetNormalTexture() const
+	{
+		return OutputNormalTexture;
+	}
+
+private:
+
+	FFlipbookPlaybackPassConfig Config;
+
+	FTexture2DRHIRef           OutputDisplacementTexture;
+	FUnorderedAccessViewRHIRef OutputDisplacementTextureUAV;
+	FTexture2DRHIRef           OutputNormalTexture;
+	FUnorderedAccessViewRHIRef OutputNormalTextureUAV;
+
+	void ConfigurePass(const FFlipbookPlaybackPassConfig& InConfig);
+};
\ No newline at end of file
@@ -27,6 +27,9 @@ BEGIN_GLOBAL_SHADER_PARAMETER_STRUCT(FFourierComponentComputeShaderParameters, )
 	SHADER_PARAMETER(float,     Time)
 	SHADER_PARAMETER(FVector2D, WindSpeed)
 	SHADER_PARAMETER(FVector2D, WaveDirection)
+	SHADER_PARAMETER(uint32,    bComputeSlopes)
+	SHADER_PARAMETER(float,     LoopPeriod)
+	SHADER_PARAMETER(float,     SeaStateBlend)
 END_GLOBAL_SHADER_PARAMETER_STRUCT()
 IMPLEMENT_GLOBAL_SHADER_PARAMETER_STRUCT(FFourierComponentComputeShaderParameters, "FourierComponentUniform");
 
@@ -40,10 +43,12 @@ public:
 	FFourierComponentComputeShader(const ShaderMetaType::CompiledShaderInitializerType& Initializer)
 		: FGlobalShader(Initializer)
 	{
-		OutputSurfaceTextureX.Bind(Initializer.ParameterMap, TEXT("OutputSurfaceTextureX"));
-		OutputSurfaceTextureY.Bind(Initializer.ParameterMap, TEXT("OutputSurfaceTextureY"));
+		OutputSurfaceTextureXY.Bind(Initializer.ParameterMap, TEXT("OutputSurfaceTextureXY"));
 		OutputSurfaceTextureZ.Bind(Initializer.ParameterMap, TEXT("OutputSurfaceTextureZ"));
+		OutputSurfaceTextureJacobian.Bind(Initializer.ParameterMap, TEXT("OutputSurfaceTextureJacobian"));
+		OutputSurfaceTextureSlope.Bind(Initializer.ParameterMap, TEXT("OutputSurfaceTextureSlope"));
 		InputPhillipsFourierTexture.Bind(Initializer.ParameterMap, TEXT("InputPhillipsFourierTexture"));
+		InputIncomingPhillipsFourierTexture.Bind(Initializer.ParameterMap, TEXT("InputIncomingPhillipsFourierTexture"));
 	}
 
 	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
@@ -59,33 +64,39 @@ public:
 	virtual bool Serialize(FArchive& Ar) override
 	{
 		bool bShaderHasOutdatedParameters = FGlobalShader::Serialize(Ar);
-		Ar << OutputSurfaceTextureX << OutputSurfaceTextureY << OutputSurfaceTextureZ << InputPhillipsFourierTexture;
+		Ar << OutputSurfaceTextureXY << OutputSurfaceTextureZ << OutputSurfaceTextureJacobian << OutputSurfaceTextureSlope << InputPhillipsFourierTexture << InputIncomingPhillipsFourierTexture;
 		return bShaderHasOutdatedParameters;
 	}
 
 	void BindShaderTextures(
 		FRHICommandList& RHICmdList,
-		FUnorderedAccessViewRHIRef OutputTextureXUAV,
-		FUnorderedAccessViewRHIRef OutputTextureYUAV,
+		FUnorderedAccessViewRHIRef OutputTextureXYUAV,
 		FUnorderedAccessViewRHIRef OutputTextureZUAV,
-		FShaderResourceViewRHIRef InputTextureSRV)
+		FUnorderedAccessViewRHIRef OutputTextureJacobianUAV,
+		FUnorderedAccessViewRHIRef OutputTextureSlopeUAV,
+		FShaderResourceViewRHIRef InputTextureSRV,
+		FShaderResourceViewRHIRef InputIncomingTextureSRV)
 	{
 		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
 
-		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputSurfaceTextureX, OutputTextureXUAV);
-		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputSurfaceTextureY, OutputTextureYUAV);
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputSurfaceTextureXY, OutputTextureXYUAV);
 		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputSurfaceTextureZ, OutputTextureZUAV);
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputSurfaceTextureJacobian, OutputTextureJacobianUAV);
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputSurfaceTextureSlope, OutputTextureSlopeUAV);
 		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputPhillipsFourierTexture, InputTextureSRV);
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputIncomingPhillipsFourierTexture, InputIncomingTextureSRV);
 	}
 
 	void UnbindShaderTextures(FRHICommandList& RHICmdList)
 	{
 		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
 
-		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputSurfaceTextureX, FUnorderedAccessViewRHIRef());
-		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputSurfaceTextureY, FUnorderedAccessViewRHIRef());
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputSurfaceTextureXY, FUnorderedAccessViewRHIRef());
 		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputSurfaceTextureZ, FUnorderedAccessViewRHIRef());
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputSurfaceTextureJacobian, FUnorderedAccessViewRHIRef());
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputSurfaceTextureSlope, FUnorderedAccessViewRHIRef());
 		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputPhillipsFourierTexture, FShaderResourceViewRHIRef());
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputIncomingPhillipsFourierTexture, FShaderResourceViewRHIRef());
 	}
 
 	void SetShaderParameters(FRHICommandList& RHICmdList, const FParameters& Parameters)
@@ -96,10 +107,12 @@ public:
 
 private:
 
-	FShaderResourceParameter OutputSurfaceTextureX;
-	FShaderResourceParameter OutputSurfaceTextureY;
+	FShaderResourceParameter OutputSurfaceTextureXY;
 	FShaderResourceParameter OutputSurfaceTextureZ;
+	FShaderResourceParameter OutputSurfaceTextureJacobian;
+	FShaderResourceParameter OutputSurfaceTextureSlope;
 	FShaderResourceParameter InputPhillipsFourierTexture;
+	FShaderResourceParameter InputIncomingPhillipsFourierTexture;
 };
 
 IMPLEMENT_SHADER_TYPE(, FFourierComponentComputeShader, TEXT("/Plugin/FFTOcean/FourierComponentComputeShader.usf"), TEXT("ComputeFourierComponent"), SF_Compute);
@@ -125,21 +138,13 @@ FFourierComponentPass::~FFourierComponentPass()
 
 bool FFourierComponentPass::IsValidPass() const
 {
-	bool bValid = true;
+	bool bValid = Config.ComponentCount > 0;
 
-	for (FTexture2DRHIRef Texture : OutputSurfaceTextures)
+	for (uint32 Index = 0; Index < Config.ComponentCount; ++Index)
 	{
-		bValid &= !!Texture;
-	}
-
-	for (FShaderResourceViewRHIRef TextureSRV : OutputSurfaceTexturesSRV)
-	{
-		bValid &= !!TextureSRV;
-	}
-
-	for (FUnorderedAccessViewRHIRef TextureUAV : OutputSurfaceTexturesUAV)
-	{
-		bValid &= !!TextureUAV;
+		bValid &= !!OutputSurfaceTextures[Index];
+		bValid &= !!OutputSurfaceTexturesSRV[Index];
+		bValid &= !!OutputSurfaceTexturesUAV[Index];
 	}
 
 	return bValid;
@@ -147,17 +152,17 @@ bool FFourierComponentPass::IsValidPass() const
 
 void FFourierComponentPass::ReleaseRenderResource()
 {
-	for (FTexture2DRHIRef Texture : OutputSurfaceTextures)
+	for (FTexture2DRHIRef& Texture : OutputSurfaceTextures)
 	{
 		SafeReleaseTextureResource(Texture);
 	}
 	
-	for (FShaderResourceViewRHIRef TextureSRV : OutputSurfaceTexturesSRV)
+	for (FShaderResourceViewRHIRef& TextureSRV : OutputSurfaceTexturesSRV)
 	{
 		SafeReleaseTextureResource(TextureSRV);
 	}
 
-	for (FUnorderedAccessViewRHIRef TextureUAV : OutputSurfaceTexturesUAV)
+	for (FUnorderedAccessViewRHIRef& TextureUAV : OutputSurfaceTexturesUAV)
 	{
 		SafeReleaseTextureResource(TextureUAV);
 	}
@@ -174,7 +179,7 @@ void FFourierComponentPass::ConfigurePass(const FFourierComponentPassConfig& InC
 	uint32 TextureWidth = InConfig.TextureWidth;
 	uint32 TextureHeight = InConfig.TextureHeight;
 	
-	for (int32 Index = 0; Index < 3; ++Index)
+	for (uint32 Index = 0; Index < InConfig.ComponentCount; ++Index)
 	{
 		OutputSurfaceTextures[Index] = RHICreateTexture2D(TextureWidth, TextureHeight, PF_G32R32F, 1, 1, TexCreate_ShaderResource | TexCreate_UAV, CreateInfo);
 		OutputSurfaceTexturesSRV[Index] = RHICreateShaderResourceView(OutputSurfaceTextures[Index], 0);
@@ -182,13 +187,24 @@ void FFourierComponentPass::ConfigurePass(const FFourierComponentPassConfig& InC
 	}
 }
 
+void FFourierComponentPass::Prepare(const FFourierComponentPassConfig& InConfig)
+{
+	if (Config != InConfig)
+	{
+		ConfigurePass(InConfig);
+	}
+}
+
 void FFourierComponentPass::Render(
+	FRHICommandListImmediate& RHICmdList,
 	const FFourierComponentPassConfig& InConfig,
 	const FFourierComponentPassParam& Param,
 	FRHITexture* XDebugTextureRef,
 	FRHITexture* YDebugTextureRef,
 	FRHITexture* ZDebugTextureRef)
 {
+	check(IsInRenderingThread());
+
 	if (Config != InConfig)
 	{
 		ConfigurePass(InConfig);
@@ -196,52 +212,49 @@ void FFourierComponentPass::Render(
 
 	if (IsValidPass())
 	{
-		ENQUEUE_RENDER_COMMAND(FourierComponentPassCommand)
-		(
-			[Param, XDebugTextureRef, YDebugTextureRef, ZDebugTextureRef, this](FRHICommandListImmediate& RHICmdList)
-			{
-				check(IsInRenderingThread());
-
-				TShaderMapRef<FFourierComponentComputeShader> FourierComponentComputeShader(GetGlobalShaderMap(ERHIFeatureLevel::SM5));
-				RHICmdList.SetComputeShader(FourierComponentComputeShader->GetComputeShader());
-
-				// Bind shader textures
-				FourierComponentComputeShader->BindShaderTextures(
-					RHICmdList,
-					OutputSurfaceTexturesUAV[0],
-					OutputSurfaceTexturesUAV[1],
-					OutputSurfaceTexturesUAV[2],
-					Param.PhillipsFourierTextureSRV);
-
-				// Bind shader uniform
-				FFourierComponentComputeShader::FParameters UniformParam;
-				UniformParam.Time = Param.Time;
-				FourierComponentComputeShader->SetShaderParameters(RHICmdList, UniformParam);
-
-				// Dispatch shader
-				const int ThreadGroupCountX = StaticCast<int>(Config.TextureWidth / 32);
-				const int ThreadGroupCountY = StaticCast<int>(Config.TextureHeight / 32);
-				DispatchComputeShader(RHICmdList, *FourierComponentComputeShader, ThreadGroupCountX, ThreadGroupCountY, 1);
-
-				// Unbind shader textures
-				FourierComponentComputeShader->UnbindShaderTextures(RHICmdList);
-
-				// Debug drawing
-				if (XDebugTextureRef)
-				{
-					RHICmdList.CopyToResolveTarget(OutputSurfaceTextures[0], XDebugTextureRef, FResolveParams());
-				}
-
-				if (YDebugTextureRef)
-				{
-					RHICmdList.CopyToResolveTarget(OutputSurfaceTextures[1], YDebugTextureRef, FResolveParams());
-				}
-
-				if (ZDebugTextureRef)
-				{
-					RHICmdList.CopyToResolveTarget(OutputSurfaceTextures[2], ZDebugTextureRef, FResolveParams());
-				}
-			}
-		);
+		TShaderMapRef<FFourierComponentComputeShader> FourierComponentComputeShader(GetGlobalShaderMap(ERHIFeatureLevel::SM5));
+		RHICmdList.SetComputeShader(FourierComponentComputeShader->GetComputeShader());
+
+		// Bind shader textures
+		FourierComponentComputeShader->BindShaderTextures(
+			RHICmdList,
+			OutputSurfaceTexturesUAV[0],
+			OutputSurfaceTexturesUAV[1],
+		OutputSurfaceTexturesUAV[OCEAN_JACOBIAN_COMPONENT_INDEX],
+			OutputSurfaceTexturesUAV[OCEAN_SLOPE_COMPONENT_INDEX],
+			Param.PhillipsFourierTextureSRV,
+			Param.IncomingPhillipsFourierTextureSRV);
+
+		// Bind shader uniform
+		FFourierComponentComputeShader::FParameters UniformParam;
+		UniformParam.Time = Param.Time;
+		UniformParam.bComputeSlopes = Config.ComponentCount > OCEAN_SLOPE_COMPONENT_INDEX ? 1 : 0;
+		UniformParam.LoopPeriod = Param.LoopPeriod;
+		UniformParam.SeaStateBlend = Param.SeaStateBlend;
+		FourierComponentComputeShader->SetShaderParameters(RHICmdList, UniformParam);
+
+		// Dispatch shader
+		const int ThreadGroupCountX = StaticCast<int>(Config.TextureWidth / 32);
+		const int ThreadGroupCountY = StaticCast<int>(Config.TextureHeight / 32);
+		DispatchComputeShader(RHICmdList, *FourierComponentComputeShader, ThreadGroupCountX, ThreadGroupCountY, 1);
+
+		// Unbind shader textures
+		FourierComponentComputeShader->UnbindShaderTextures(RHICmdList);
+
+		// Debug drawing, X and Y share the packed spectrum
+		if (XDebugTextureRef)
+		{
+			RHICmdList.CopyToResolveTarget(OutputSurfaceTextures[0], XDebugTextureRef, FResolveParams());
+		}
+
+		if (YDebugTextureRef)
+		{
+			RHICmdList.CopyToResolveTarget(OutputSurfaceTextures[0], YDebugTextureRef, FResolveParams());
+		}
+
+		if (ZDebugTextureRef)
+		{
+			RHICmdList.CopyToResolveTarget(OutputSurfaceTextures[1], ZDebugTextureRef, FResolveParams());
+		}
 	}
 }
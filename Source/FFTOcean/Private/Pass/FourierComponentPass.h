@@ -8,12 +8,18 @@ struct FFourierComponentPassConfig
 {
 	uint32 TextureWidth;
 	uint32 TextureHeight;
+	uint32 ComponentCount;
 };
 
 struct FFourierComponentPassParam
 {
 	float                     Time;
+	// Frequencies are quantized so the surface repeats with this period, zero disables looping
+	float                     LoopPeriod;
 	FShaderResourceViewRHIRef PhillipsFourierTextureSRV;
+	// Spectrum of the sea state being transitioned to, weighted by SeaStateBlend
+	FShaderResourceViewRHIRef IncomingPhillipsFourierTextureSRV;
+	float                     SeaStateBlend;
 };
 
 class FFourierComponentPass final : public FOceanRenderPass
@@ -27,12 +33,16 @@ public:
 	virtual void ReleaseRenderResource() override;
 
 	void Render(
+		FRHICommandListImmediate& RHICmdList,
 		const FFourierComponentPassConfig& InConfig,
 		const FFourierComponentPassParam& Param,
 		FRHITexture* XDebugTextureRef,
 		FRHITexture* YDebugTextureRef,
 		FRHITexture* ZDebugTextureRef);
 
+	// Creates the pass resources ahead of the first render
+	void Prepare(const FFourierComponentPassConfig& InConfig);
+
 	FORCEINLINE FTexture2DRHIRef GetSurfaceTexture(int Index) const
 	{
 		return OutputSurfaceTextures[Index];
@@ -50,9 +60,9 @@ public:
 
 private:
 
-	FTexture2DRHIRef            OutputSurfaceTextures[3];
-	FShaderResourceViewRHIRef   OutputSurfaceTexturesSRV[3];
-	FUnorderedAccessViewRHIRef  OutputSurfaceTexturesUAV[3];
+	FTexture2DRHIRef            OutputSurfaceTextures[OCEAN_FOURIER_COMPONENT_COUNT];
+	FShaderResourceViewRHIRef   OutputSurfaceTexturesSRV[OCEAN_FOURIER_COMPONENT_COUNT];
+	FUnorderedAccessViewRHIRef  OutputSurfaceTexturesUAV[OCEAN_FOURIER_COMPONENT_COUNT];
 
 	FFourierComponentPassConfig Config;
 
@@ -0,0 +1,180 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "Pass/GerstnerWavePass.h"
+#include "FFTOceanRenderer.h"
+#include "RenderCore/Public/GlobalShader.h"
+#include "RenderCore/Public/ShaderParameterUtils.h"
+#include "RenderCore/Public/ShaderParameterMacros.h"
+
+#include "Public/GlobalShader.h"
+#include "Public/PipelineStateCache.h"
+#include "Public/RHIStaticStates.h"
+#include "Public/ShaderParameterUtils.h"
+#include "RHI/Public/RHICommandList.h"
+
+// Two registers per wave, and transitions blend two sets of waves
+#define OCEAN_GERSTNER_WAVE_REGISTER_COUNT (OCEAN_MAX_GERSTNER_WAVE_COUNT * 4)
+
+BEGIN_GLOBAL_SHADER_PARAMETER_STRUCT(FGerstnerWaveComputeShaderParameters, )
+	SHADER_PARAMETER(uint32, WaveCount)
+	SHADER_PARAMETER(float,  NormalStrength)
+	SHADER_PARAMETER_ARRAY(FVector4, Waves, [OCEAN_GERSTNER_WAVE_REGISTER_COUNT])
+END_GLOBAL_SHADER_PARAMETER_STRUCT()
+IMPLEMENT_GLOBAL_SHADER_PARAMETER_STRUCT(FGerstnerWaveComputeShaderParameters, "GerstnerWaveUniform");
+
+class FGerstnerWaveComputeShader : public FGlobalShader
+{
+	DECLARE_SHADER_TYPE(FGerstnerWaveComputeShader, Global);
+	using FParameters = FGerstnerWaveComputeShaderParameters;
+
+public:
+
+	FGerstnerWaveComputeShader() {}
+	FGerstnerWaveComputeShader(const ShaderMetaType::CompiledShaderInitializerType& Initializer) :
+		FGlobalShader(Initializer)
+	{
+		OutputDisplacementTexture.Bind(Initializer.ParameterMap, TEXT("OutputDisplacementTexture"));
+		OutputNormalTexture.Bind(Initializer.ParameterMap, TEXT("OutputNormalTexture"));
+	}
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+
+	virtual bool Serialize(FArchive& Ar) override
+	{
+		bool bShaderHasOutdatedParameters = FGlobalShader::Serialize(Ar);
+
+		Ar << OutputDisplacementTexture;
+		Ar << OutputNormalTexture;
+
+		return bShaderHasOutdatedParameters;
+	}
+
+	void BindShaderTextures(FRHICommandList& RHICmdList, FUnorderedAccessViewRHIRef DisplacementOutputTextureUAV, FUnorderedAccessViewRHIRef NormalOutputTextureUAV)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputDisplacementTexture, DisplacementOutputTextureUAV);
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputNormalTexture, NormalOutputTextureUAV);
+	}
+
+	void UnbindShaderTextures(FRHICommandList& RHICmdList)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputDisplacementTexture, FUnorderedAccessViewRHIRef());
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputNormalTexture, FUnorderedAccessViewRHIRef());
+	}
+
+	void SetShaderParameters(FRHICommandList& RHICmdList, const FParameters& Parameters)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetUniformBufferParameterImmediate(RHICmdList, ComputeShaderRHI, GetUniformBufferParameter<FParameters>(), Parameters);
+	}
+
+private:
+
+	FShaderResourceParameter OutputDisplacementTexture;
+	FShaderResourceParameter OutputNormalTexture;
+};
+
+IMPLEMENT_SHADER_TYPE(, FGerstnerWaveComputeShader, TEXT("/Plugin/FFTOcean/GerstnerWaveComputeShader.usf"), TEXT("ComputeGerstnerWaves"), SF_Compute)
+
+inline bool operator==(const FGerstnerWavePassConfig& A, const FGerstnerWavePassConfig& B)
+{
+	return FMemory::Memcmp(&A, &B, sizeof(FGerstnerWavePassConfig)) == 0;
+}
+
+inline bool operator!=(const FGerstnerWavePassConfig& A, const FGerstnerWavePassConfig& B)
+{
+	return !(A == B);
+}
+
+FGerstnerWavePass::FGerstnerWavePass()
+{
+	FMemory::Memzero(Config);
+}
+
+FGerstnerWavePass::~FGerstnerWavePass()
+{
+	ReleaseRenderResource();
+}
+
+bool FGerstnerWavePass::IsValidPass() const
+{
+	bool bValid = !!OutputDisplacementTexture;
+	bValid &= !!OutputDisplacementTextureUAV;
+	bValid &= !!OutputNormalTexture;
+	bValid &= !!OutputNormalTextureUAV;
+
+	return bValid;
+}
+
+void FGerstnerWavePass::ReleaseRenderResource()
+{
+	SafeReleaseTextureResource(OutputDisplacementTexture);
+	SafeReleaseTextureResource(OutputDisplacementTextureUAV);
+	SafeReleaseTextureResource(OutputNormalTexture);
+	SafeReleaseTextureResource(OutputNormalTextureUAV);
+}
+
+void FGerstnerWavePass::Render(FRHICommandListImmediate& RHICmdList, const FGerstnerWavePassConfig& InConfig, const FGerstnerWavePassParam& Param)
+{
+	check(IsInRenderingThread());
+	check(Param.Waves.Num() % 2 == 0);
+
+	if (Config != InConfig)
+	{
+		ConfigurePass(InConfig);
+	}
+
+	if (IsValidPass())
+	{
+		TShaderMapRef<FGerstnerWaveComputeShader> GerstnerWaveComputeShader(GetGlobalShaderMap(ERHIFeatureLevel::SM5));
+		RHICmdList.SetComputeShader(GerstnerWaveComputeShader->GetComputeShader());
+
+		// Bind shader textures
+		GerstnerWaveComputeShader->BindShaderTextures(RHICmdList, OutputDisplacementTextureUAV, OutputNormalTextureUAV);
+
+		// Bind shader uniform
+		const int32 RegisterCount = FMath::Min(Param.Waves.Num(), OCEAN_GERSTNER_WAVE_REGISTER_COUNT);
+
+		FGerstnerWaveComputeShader::FParameters UniformParam;
+		UniformParam.WaveCount = StaticCast<uint32>(RegisterCount / 2);
+		UniformParam.NormalStrength = Param.NormalStrength;
+		for (int32 Index = 0; Index < OCEAN_GERSTNER_WAVE_REGISTER_COUNT; ++Index)
+		{
+			UniformParam.Waves[Index] = Index < RegisterCount ? Param.Waves[Index] : FVector4(0, 0, 0, 0);
+		}
+		GerstnerWaveComputeShader->SetShaderParameters(RHICmdList, UniformParam);
+
+		// Dispatch shader
+		const int ThreadGroupCountX = StaticCast<int>(Config.TextureWidth / 32);
+		const int ThreadGroupCountY = StaticCast<int>(Config.TextureHeight / 32);
+		DispatchComputeShader(RHICmdList, *GerstnerWaveComputeShader, ThreadGroupCountX, ThreadGroupCountY, 1);
+
+		// Unbind shader textures
+		GerstnerWaveComputeShader->UnbindShaderTextures(RHICmdList);
+	}
+}
+
+void FGerstnerWavePass::ConfigurePass(const FGerstnerWavePassConfig& InConfig)
+{
+	// Always release current resource before creating new render resources
+	ReleaseRenderResource();
+
+	Config = InConfig;
+
+	FRHIResourceCreateInfo CreateInfo;
+	uint32 TextureWidth = InConfig.TextureWidth;
+	uint32 TextureHeight = InConfig.TextureHeight;
+
+	// Same layout as the simulated surface, so the mip chain pass can take over from here
+	uint32 MipCount = FFTOcean::GetMipCount(TextureWidth, TextureHeight);
+
+	OutputDisplacementTexture = RHICreateTexture2D(TextureWidth, TextureHeight, PF_FloatRGBA, MipCount, 1, TexCreate_ShaderResource | TexCreate_UAV, CreateInfo);
+	OutputDisplacementTextureUAV = RHICreateUnorderedAccessView(OutputDisplacementTexture);
+
+	OutputNormalTexture = RHICreateTexture2D(TextureWidth, TextureHeight, PF_FloatRGBA, MipCount, 1, TexCreate_ShaderResource | TexCreate_UAV, CreateInfo);
+	OutputNormalTextureUAV = RHICreateUnorderedAccessView(OutputNormalTexture);
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Pass/PassUtil.h"
+
+struct FGerstnerWavePassConfig
+{
+	uint32 TextureWidth;
+	uint32 TextureHeight;
+};
+
+struct FGerstnerWavePassParam
+{
+	// Two entries per wave: wave vector with the height cosine and sine weights, then the X and Y weights
+	TArrayView<const FVector4> Waves;
+
+	float NormalStrength;
+};
+
+// Replaces the whole simulation with a sum of a few analytic waves per texel, for distant oceans and low end hardware
+class FGerstnerWavePass final : public FOceanRenderPass
+{
+public:
+
+	FGerstnerWavePass();
+	~FGerstnerWavePass();
+
+	virtual bool IsValidPass() const override;
+	virtual void ReleaseRenderResource() override;
+
+	void Render(FRHICommandListImmediate& RHICmdList, const FGerstnerWavePassConfig& InConfig, const FGerstnerWavePassParam& Param);
+
+	FORCEINLINE FTexture2DRHIRef GetDisplacementTexture() const
+	{
+		return OutputDisplacementTexture;
+	}
+
+	FORCEINLINE FTexture2DRHIRef GetNormalTexture() const
+	{
+		return OutputNormalTexture;
+	}
+
+private:
+
+	FGerstnerWavePassConfig Config;
+
+	FTexture2DRHIRef           OutputDisplacementTexture;
+	FUnorderedAccessViewRHIRef OutputDisplacementTextureUAV;
+	FTexture2DRHIRef           OutputNormalTexture;
+	FUnorderedAccessViewRHIRef OutputNormalTextureUAV;
+
+	void ConfigurePass(const FGerstnerWavePassConfig& InConfig);
+};
\ No newline at end of file
@@ -1,6 +1,8 @@
 // Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
 
 #include "Pass/InverseTransformPass.h"
+#include "FFTOcean.h"
+#include "HAL/IConsoleManager.h"
 #include "RenderCore/Public/GlobalShader.h"
 #include "RenderCore/Public/ClearQuad.h"
 #include "RenderCore/Public/ShaderParameterUtils.h"
@@ -29,6 +31,15 @@ BEGIN_GLOBAL_SHADER_PARAMETER_STRUCT(FInverseTransformComputeShaderParameters, )
 END_GLOBAL_SHADER_PARAMETER_STRUCT()
 IMPLEMENT_GLOBAL_SHADER_PARAMETER_STRUCT(FInverseTransformComputeShaderParameters, "InverseTransformUniform");
 
+DECLARE_CYCLE_STAT(TEXT("Inverse Transform"), STAT_FFTOcean_InverseTransform, STATGROUP_FFTOcean);
+
+static TAutoConsoleVariable<int32> CVarFFTOceanPersistentUniformBuffers(
+	TEXT("r.FFTOcean.PersistentUniformBuffers"),
+	1,
+	TEXT("0: create a transient uniform buffer for every inverse transform stage, to compare against in stat FFTOcean\n")
+	TEXT("1: bind stage uniform buffers built once per configuration"),
+	ECVF_RenderThreadSafe);
+
 class FInverseTransformComputeShader : public FGlobalShader
 {
 	DECLARE_SHADER_TYPE(FInverseTransformComputeShader, Global)
@@ -83,6 +94,12 @@ public:
 		SetUniformBufferParameterImmediate(RHICmdList, ComputeShaderRHI, GetUniformBufferParameter<FParameters>(), Parameters);
 	}
 
+	void SetShaderUniformBuffer(FRHICommandList& RHICmdList, FRHIUniformBuffer* UniformBuffer)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetUniformBufferParameter(RHICmdList, ComputeShaderRHI, GetUniformBufferParameter<FParameters>(), UniformBuffer);
+	}
+
 private:
 
 	FShaderResourceParameter OutputInverseTransformTexture;
@@ -113,29 +130,36 @@ FInverseTransformPass::~FInverseTransformPass()
 
 bool FInverseTransformPass::IsValidPass() const
 {
-	bool bValid = !!OutputInverseTransformTextures;
-	bValid &= !!OutputInverseTransformTextureUAVs;
-	bValid &= !!OutputInverseTransformTextureSRVs;
+	bool bValid = Config.ComponentCount > 0;
+
+	for (uint32 Index = 0; Index < Config.ComponentCount; ++Index)
+	{
+		bValid &= !!OutputInverseTransformTextures[Index];
+		bValid &= !!OutputInverseTransformTextureUAVs[Index];
+		bValid &= !!OutputInverseTransformTextureSRVs[Index];
+	}
 
 	return bValid;
 }
 
 void FInverseTransformPass::ReleaseRenderResource()
 {
-	for (FTexture2DRHIRef Texture : OutputInverseTransformTextures)
+	for (FTexture2DRHIRef& Texture : OutputInverseTransformTextures)
 	{
 		SafeReleaseTextureResource(Texture);
 	}
 
-	for (FShaderResourceViewRHIRef TextureSRV : OutputInverseTransformTextureSRVs)
+	for (FShaderResourceViewRHIRef& TextureSRV : OutputInverseTransformTextureSRVs)
 	{
 		SafeReleaseTextureResource(TextureSRV);
 	}
 
-	for (FUnorderedAccessViewRHIRef TextureUAV : OutputInverseTransformTextureUAVs)
+	for (FUnorderedAccessViewRHIRef& TextureUAV : OutputInverseTransformTextureUAVs)
 	{
 		SafeReleaseTextureResource(TextureUAV);
 	}
+
+	StageUniformBuffers.Reset();
 }
 
 void FInverseTransformPass::ConfigurePass(const FInverseTransformPassConfig& InConfig)
@@ -149,21 +173,49 @@ void FInverseTransformPass::ConfigurePass(const FInverseTransformPassConfig& InC
 	uint32 TextureWidth = InConfig.TextureWidth;
 	uint32 TextureHeight = InConfig.TextureHeight;
 	
-	for (int32 Index = 0; Index < 3; ++Index)
+	for (uint32 Index = 0; Index < InConfig.ComponentCount; ++Index)
 	{
 		OutputInverseTransformTextures[Index] = RHICreateTexture2D(TextureWidth, TextureHeight, PF_G32R32F, 1, 1, TexCreate_ShaderResource | TexCreate_UAV, CreateInfo);
 		OutputInverseTransformTextureUAVs[Index] = RHICreateUnorderedAccessView(OutputInverseTransformTextures[Index]);
 		OutputInverseTransformTextureSRVs[Index] = RHICreateShaderResourceView(OutputInverseTransformTextures[Index], 0);
 	}
+
+	const uint32 StageCount = StaticCast<uint32>(FMath::Log2(TextureHeight));
+
+	for (uint32 Direction = 0; Direction < 2; ++Direction)
+	{
+		for (uint32 Stage = 0; Stage < StageCount; ++Stage)
+		{
+			FInverseTransformComputeShader::FParameters UniformParam;
+			UniformParam.Stage = Stage;
+			UniformParam.StageCount = StageCount;
+			UniformParam.Direction = Direction;
+
+			StageUniformBuffers.Add(TUniformBufferRef<FInverseTransformComputeShader::FParameters>::CreateUniformBufferImmediate(UniformParam, UniformBuffer_MultiFrame));
+		}
+	}
+}
+
+void FInverseTransformPass::Prepare(const FInverseTransformPassConfig& InConfig)
+{
+	if (Config != InConfig)
+	{
+		ConfigurePass(InConfig);
+	}
 }
 
 void FInverseTransformPass::Render(
+	FRHICommandListImmediate& RHICmdList,
 	const FInverseTransformPassConfig& InConfig,
 	const FInverseTransformPassParam& Param,
 	FRHITexture* XDebugTextureRef,
 	FRHITexture* YDebugTextureRef,
 	FRHITexture* ZDebugTextureRef)
 {
+	check(IsInRenderingThread());
+
+	SCOPE_CYCLE_COUNTER(STAT_FFTOcean_InverseTransform);
+
 	if (Config != InConfig)
 	{
 		ConfigurePass(InConfig);
@@ -171,29 +223,34 @@ void FInverseTransformPass::Render(
 
 	if (IsValidPass())
 	{
-		ENQUEUE_RENDER_COMMAND(InverseTransformPassCommand)
-		(
-			[Param, XDebugTextureRef, YDebugTextureRef, ZDebugTextureRef, this](FRHICommandListImmediate& RHICmdList)
-			{
-				check(IsInRenderingThread());
+		// Looked up once for every component, the stages then only swap textures and uniform buffers
+		TShaderMapRef<FInverseTransformComputeShader> InverseTransformComputeShader(GetGlobalShaderMap(ERHIFeatureLevel::SM5));
+		RHICmdList.SetComputeShader(InverseTransformComputeShader->GetComputeShader());
 
-				RenderInverseTransform(RHICmdList, Param, 0, XDebugTextureRef);
-				RenderInverseTransform(RHICmdList, Param, 1, YDebugTextureRef);
-				RenderInverseTransform(RHICmdList, Param, 2, ZDebugTextureRef);
-			}
-		);
+		RenderInverseTransform(RHICmdList, *InverseTransformComputeShader, Param, 0, XDebugTextureRef);
+		RenderInverseTransform(RHICmdList, *InverseTransformComputeShader, Param, 1, ZDebugTextureRef);
+
+		for (uint32 Index = 2; Index < Config.ComponentCount; ++Index)
+		{
+			RenderInverseTransform(RHICmdList, *InverseTransformComputeShader, Param, Index, nullptr);
+		}
+
+		// X and Y displacement come out of the same transform, in its real and imaginary parts
+		if (YDebugTextureRef)
+		{
+			RHICmdList.CopyToResolveTarget(OutputInverseTransformTextures[0], YDebugTextureRef, FResolveParams());
+		}
 	}
 }
 
 void FInverseTransformPass::RenderInverseTransform(
 	FRHICommandListImmediate& RHICmdList,
+	FInverseTransformComputeShader* InverseTransformComputeShader,
 	const FInverseTransformPassParam& Param,
 	int32 TextureIndex,
 	FRHITexture* DebugTextureRef)
 {
-	// Set up compute shader
-	TShaderMapRef<FInverseTransformComputeShader> InverseTransformComputeShader(GetGlobalShaderMap(ERHIFeatureLevel::SM5));
-	RHICmdList.SetComputeShader(InverseTransformComputeShader->GetComputeShader());
+	const bool bPersistentUniformBuffers = CVarFFTOceanPersistentUniformBuffers.GetValueOnRenderThread() != 0;
 
 	// Set up ping pong texture
 	FTexture2DRHIRef           PingPongTextures[2];
@@ -218,11 +275,18 @@ void FInverseTransformPass::RenderInverseTransform(
 		for (uint32 Stage = 0; Stage < StageCount; ++Stage, ++FrameIndex)
 		{
 			// Bind shader uniform
-			FInverseTransformComputeShader::FParameters UniformParam;
-			UniformParam.Stage = Stage;
-			UniformParam.StageCount = StageCount;
-			UniformParam.Direction = Direction;
-			InverseTransformComputeShader->SetShaderParameters(RHICmdList, UniformParam);
+			if (bPersistentUniformBuffers)
+			{
+				InverseTransformComputeShader->SetShaderUniformBuffer(RHICmdList, StageUniformBuffers[FrameIndex]);
+			}
+			else
+			{
+				FInverseTransformComputeShader::FParameters UniformParam;
+				UniformParam.Stage = Stage;
+				UniformParam.StageCount = StageCount;
+				UniformParam.Direction = Direction;
+				InverseTransformComputeShader->SetShaderParameters(RHICmdList, UniformParam);
+			}
 
 			// Bind shader textures
 			const uint32 InputIndex = FrameIndex % 2;
@@ -235,7 +299,7 @@ void FInverseTransformPass::RenderInverseTransform(
 			// Dispatch shader
 			const int ThreadGroupCountX = StaticCast<int>(Config.TextureWidth / 32);
 			const int ThreadGroupCountY = StaticCast<int>(Config.TextureHeight / 32);
-			DispatchComputeShader(RHICmdList, *InverseTransformComputeShader, ThreadGroupCountX, ThreadGroupCountY, 1);
+			DispatchComputeShader(RHICmdList, InverseTransformComputeShader, ThreadGroupCountX, ThreadGroupCountY, 1);
 
 			// Unbind shader textures
 			InverseTransformComputeShader->UnbindShaderTextures(RHICmdList);
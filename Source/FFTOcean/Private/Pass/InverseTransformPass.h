@@ -8,13 +8,14 @@ struct FInverseTransformPassConfig
 {
 	uint32       TextureWidth;
 	uint32       TextureHeight;
+	uint32       ComponentCount;
 };
 
 struct FInverseTransformPassParam
 {
-	FTexture2DRHIRef           FourierComponentTextures[3];
-	FShaderResourceViewRHIRef  FourierComponentTextureSRVs[3];
-	FUnorderedAccessViewRHIRef FourierComponentTextureUAVs[3];
+	FTexture2DRHIRef           FourierComponentTextures[OCEAN_FOURIER_COMPONENT_COUNT];
+	FShaderResourceViewRHIRef  FourierComponentTextureSRVs[OCEAN_FOURIER_COMPONENT_COUNT];
+	FUnorderedAccessViewRHIRef FourierComponentTextureUAVs[OCEAN_FOURIER_COMPONENT_COUNT];
 
 	FShaderResourceViewRHIRef  TwiddleFactorsTextureSRV;
 };
@@ -30,25 +31,37 @@ public:
 	virtual void ReleaseRenderResource() override;
 
 	void Render(
+		FRHICommandListImmediate& RHICmdList,
 		const FInverseTransformPassConfig& InConfig,
 		const FInverseTransformPassParam& Param,
 		FRHITexture* XDebugTextureRef,
 		FRHITexture* YDebugTextureRef,
 		FRHITexture* ZDebugTextureRef);
 
-	FORCEINLINE void GetInverseTransformTextureSRVs(FShaderResourceViewRHIRef (&Array)[3]) const
+	// Creates the pass resources ahead of the first render
+	void Prepare(const FInverseTransformPassConfig& InConfig);
+
+	FORCEINLINE void GetInverseTransformTextureSRVs(FShaderResourceViewRHIRef (&Array)[OCEAN_FOURIER_COMPONENT_COUNT]) const
 	{
-		for (int32 Index = 0; Index < 3; ++Index)
+		for (int32 Index = 0; Index < OCEAN_FOURIER_COMPONENT_COUNT; ++Index)
 		{
 			Array[Index] = OutputInverseTransformTextureSRVs[Index];
 		}
 	}
 
+	FORCEINLINE FTexture2DRHIRef GetInverseTransformTexture(int32 Index) const
+	{
+		return OutputInverseTransformTextures[Index];
+	}
+
 private:
 
-	FTexture2DRHIRef           OutputInverseTransformTextures[3];
-	FUnorderedAccessViewRHIRef OutputInverseTransformTextureUAVs[3];
-	FShaderResourceViewRHIRef  OutputInverseTransformTextureSRVs[3];
+	FTexture2DRHIRef           OutputInverseTransformTextures[OCEAN_FOURIER_COMPONENT_COUNT];
+	FUnorderedAccessViewRHIRef OutputInverseTransformTextureUAVs[OCEAN_FOURIER_COMPONENT_COUNT];
+	FShaderResourceViewRHIRef  OutputInverseTransformTextureSRVs[OCEAN_FOURIER_COMPONENT_COUNT];
+
+	// Stage parameters of the horizontal then the vertical stages, built once per configuration instead of every dispatch
+	TArray<FUniformBufferRHIRef> StageUniformBuffers;
 
 	FInverseTransformPassConfig Config;
 
@@ -56,6 +69,7 @@ private:
 
 	void RenderInverseTransform(
 		FRHICommandListImmediate& RHICmdList,
+		class FInverseTransformComputeShader* InverseTransformComputeShader,
 		const FInverseTransformPassParam& Param,
 		int32 TextureIndex,
 		FRHITexture* DebugTextureRef);
@@ -0,0 +1,331 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "Pass/MipChainPass.h"
+#include "RenderCore/Public/GlobalShader.h"
+#include "RenderCore/Public/ShaderParameterUtils.h"
+#include "RenderCore/Public/ShaderParameterMacros.h"
+
+#include "Public/GlobalShader.h"
+#include "Public/PipelineStateCache.h"
+#include "Public/RHIStaticStates.h"
+#include "Public/SceneUtils.h"
+#include "Public/SceneInterface.h"
+#include "Public/ShaderParameterUtils.h"
+#include "Public/Logging/MessageLog.h"
+#include "Public/Internationalization/Internationalization.h"
+#include "Public/StaticBoundShaderState.h"
+#include "RHI/Public/RHICommandList.h"
+
+#include "Classes/Engine/World.h"
+#include "Engine/Classes/Kismet/KismetRenderingLibrary.h"
+
+#include "Math/UnrealMathUtility.h"
+
+BEGIN_GLOBAL_SHADER_PARAMETER_STRUCT(FMipChainComputeShaderParameters, )
+	SHADER_PARAMETER(uint32, MipCount)
+	SHADER_PARAMETER(uint32, CounterIndex)
+	SHADER_PARAMETER(uint32, bNormalMap)
+END_GLOBAL_SHADER_PARAMETER_STRUCT()
+IMPLEMENT_GLOBAL_SHADER_PARAMETER_STRUCT(FMipChainComputeShaderParameters, "MipChainUniform");
+
+class FMipChainComputeShader : public FGlobalShader
+{
+	DECLARE_SHADER_TYPE(FMipChainComputeShader, Global);
+	using FParameters = FMipChainComputeShaderParameters;
+
+public:
+
+	FMipChainComputeShader() {}
+	FMipChainComputeShader(const ShaderMetaType::CompiledShaderInitializerType& Initializer) :
+		FGlobalShader(Initializer)
+	{
+		InputMip0.Bind(Initializer.ParameterMap, TEXT("InputMip0"));
+		GroupCounterBuffer.Bind(Initializer.ParameterMap, TEXT("GroupCounterBuffer"));
+		GroupMip6Buffer.Bind(Initializer.ParameterMap, TEXT("GroupMip6Buffer"));
+
+		for (int32 Mip = 1; Mip < OCEAN_MAX_MIP_COUNT; ++Mip)
+		{
+			OutputMips[Mip].Bind(Initializer.ParameterMap, *FString::Printf(TEXT("OutputMip%d"), Mip));
+		}
+	}
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+
+	virtual bool Serialize(FArchive& Ar) override
+	{
+		bool bShaderHasOutdatedParameters = FGlobalShader::Serialize(Ar);
+
+		Ar << InputMip0;
+		Ar << GroupCounterBuffer;
+		Ar << GroupMip6Buffer;
+
+		for (int32 Mip = 1; Mip < OCEAN_MAX_MIP_COUNT; ++Mip)
+		{
+			Ar << OutputMips[Mip];
+		}
+
+		return bShaderHasOutdatedParameters;
+	}
+
+	void BindShaderTextures(
+		FRHICommandList& RHICmdList,
+		const FUnorderedAccessViewRHIRef (&OutputMipUAVs)[OCEAN_MAX_MIP_COUNT],
+		FShaderResourceViewRHIRef InputMip0SRV,
+		FUnorderedAccessViewRHIRef CounterBufferUAV,
+		FUnorderedAccessViewRHIRef Mip6BufferUAV)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputMip0, InputMip0SRV);
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, GroupCounterBuffer, CounterBufferUAV);
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, GroupMip6Buffer, Mip6BufferUAV);
+
+		for (int32 Mip = 1; Mip < OCEAN_MAX_MIP_COUNT; ++Mip)
+		{
+			SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputMips[Mip], OutputMipUAVs[Mip]);
+		}
+	}
+
+	void UnbindShaderTextures(FRHICommandList& RHICmdList)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputMip0, FShaderResourceViewRHIRef());
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, GroupCounterBuffer, FUnorderedAccessViewRHIRef());
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, GroupMip6Buffer, FUnorderedAccessViewRHIRef());
+
+		for (int32 Mip = 1; Mip < OCEAN_MAX_MIP_COUNT; ++Mip)
+		{
+			SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputMips[Mip], FUnorderedAccessViewRHIRef());
+		}
+	}
+
+	void SetShaderParameters(FRHICommandList& RHICmdList, const FParameters& Parameters)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetUniformBufferParameterImmediate(RHICmdList, ComputeShaderRHI, GetUniformBufferParameter<FParameters>(), Parameters);
+	}
+
+private:
+
+	FShaderResourceParameter InputMip0;
+	FShaderResourceParameter GroupCounterBuffer;
+	FShaderResourceParameter GroupMip6Buffer;
+	FShaderResourceParameter OutputMips[OCEAN_MAX_MIP_COUNT];
+};
+
+IMPLEMENT_SHADER_TYPE(, FMipChainComputeShader, TEXT("/Plugin/FFTOcean/MipChainComputeShader.usf"), TEXT("ComputeMipChain"), SF_Compute)
+
+inline bool operator==(const FMipChainPassConfig& A, const FMipChainPassConfig& B)
+{
+	return FMemory::Memcmp(&A, &B, sizeof(FMipChainPassConfig)) == 0;
+}
+
+inline bool operator!=(const FMipChainPassConfig& A, const FMipChainPassConfig& B)
+{
+	return !(A == B);
+}
+
+namespace
+{
+	// Every group downsamples a 64x64 tile of mip 0
+	constexpr uint32 MipChainTileSize = 64;
+	constexpr uint32 MipChainCounterCount = 2;
+
+	// Mip 6 texels of one dispatch, one per group of the largest 1024x1024 texture
+	constexpr uint32 MipChainMaxGroupCount = 256;
+}
+
+FMipChainPass::FMipChainPass()
+{
+}
+
+FMipChainPass::~FMipChainPass()
+{
+	ReleaseRenderResource();
+}
+
+bool FMipChainPass::IsValidPass() const
+{
+	bool bValid = !!GroupCounterBuffer;
+	bValid &= !!GroupCounterBufferUAV;
+	bValid &= !!GroupMip6Buffer;
+	bValid &= !!GroupMip6BufferUAV;
+	bValid &= !!DisplacementTarget.Mip0SRV;
+	bValid &= !!NormalTarget.Mip0SRV;
+
+	return bValid;
+}
+
+void FMipChainPass::ReleaseRenderResource()
+{
+	SafeReleaseTextureResource(GroupCounterBuffer);
+	SafeReleaseTextureResource(GroupCounterBufferUAV);
+	SafeReleaseTextureResource(GroupMip6Buffer);
+	SafeReleaseTextureResource(GroupMip6BufferUAV);
+
+	ReleaseTarget(DisplacementTarget);
+	ReleaseTarget(NormalTarget);
+}
+
+void FMipChainPass::ReleaseTarget(FMipChainTarget& Target)
+{
+	// Views are dropped rather than released, the texture itself belongs to another pass
+	for (FUnorderedAccessViewRHIRef& MipUAV : Target.MipUAVs)
+	{
+		MipUAV = nullptr;
+	}
+
+	Target.Mip0SRV = nullptr;
+	Target.Texture = nullptr;
+}
+
+void FMipChainPass::ConfigurePass(const FMipChainPassConfig& InConfig)
+{
+	// Always release current resource before creating new render resources
+	ReleaseRenderResource();
+
+	Config = InConfig;
+
+	// Counters have to start at zero, every dispatch leaves them at zero again
+	TResourceArray<uint32> CounterArray;
+	CounterArray.AddZeroed(MipChainCounterCount);
+
+	FRHIResourceCreateInfo CreateInfo(&CounterArray);
+	GroupCounterBuffer = RHICreateVertexBuffer(sizeof(uint32) * MipChainCounterCount, BUF_UnorderedAccess | BUF_ShaderResource, CreateInfo);
+	GroupCounterBufferUAV = RHICreateUnorderedAccessView(GroupCounterBuffer, PF_R32_UINT);
+
+	// One range per counter, so both targets can be in flight
+	FRHIResourceCreateInfo Mip6CreateInfo;
+	GroupMip6Buffer = RHICreateStructuredBuffer(
+		sizeof(FVector4),                                                     // Stride
+		sizeof(FVector4) * MipChainMaxGroupCount * MipChainCounterCount,      // Size
+		BUF_UnorderedAccess,                                                  // Usage
+		Mip6CreateInfo                                                        // Create info
+	);
+	GroupMip6BufferUAV = RHICreateUnorderedAccessView(GroupMip6Buffer, false, false);
+}
+
+void FMipChainPass::ConfigureTarget(FMipChainTarget& Target, FTexture2DRHIRef Texture)
+{
+	ReleaseTarget(Target);
+
+	if (!Texture)
+	{
+		return;
+	}
+
+	Target.Texture = Texture;
+	Target.Mip0SRV = RHICreateShaderResourceView(Texture, 0);
+
+	for (uint32 Mip = 1; Mip < Texture->GetNumMips() && Mip < OCEAN_MAX_MIP_COUNT; ++Mip)
+	{
+		Target.MipUAVs[Mip] = RHICreateUnorderedAccessView(Texture, Mip);
+	}
+}
+
+void FMipChainPass::Prepare(const FMipChainPassConfig& InConfig)
+{
+	if (Config != InConfig)
+	{
+		ConfigurePass(InConfig);
+	}
+}
+
+void FMipChainPass::Render(
+	FRHICommandListImmediate& RHICmdList,
+	const FMipChainPassConfig& InConfig,
+	const FMipChainPassParam& Param,
+	FRHITexture* DisplacementTargetRef,
+	FRHITexture* NormalTargetRef)
+{
+	check(IsInRenderingThread());
+
+	if (Config != InConfig)
+	{
+		ConfigurePass(InConfig);
+	}
+
+	// Source textures are owned by other passes and are recreated along with them
+	if (DisplacementTarget.Texture != Param.DisplacementTexture)
+	{
+		ConfigureTarget(DisplacementTarget, Param.DisplacementTexture);
+	}
+
+	if (NormalTarget.Texture != Param.NormalTexture)
+	{
+		ConfigureTarget(NormalTarget, Param.NormalTexture);
+	}
+
+	if (IsValidPass())
+	{
+		RenderMipChain(RHICmdList, DisplacementTarget, 0, false, DisplacementTargetRef);
+		RenderMipChain(RHICmdList, NormalTarget, 1, true, NormalTargetRef);
+	}
+}
+
+void FMipChainPass::RenderMipChain(FRHICommandListImmediate& RHICmdList, const FMipChainTarget& Target, uint32 CounterIndex, bool bNormalMap, FRHITexture* TargetRef)
+{
+	const uint32 MipCount = FMath::Min<uint32>(Target.Texture->GetNumMips(), OCEAN_MAX_MIP_COUNT);
+
+	if (MipCount > 1)
+	{
+		// Set up compute shader
+		TShaderMapRef<FMipChainComputeShader> MipChainComputeShader(GetGlobalShaderMap(ERHIFeatureLevel::SM5));
+		RHICmdList.SetComputeShader(MipChainComputeShader->GetComputeShader());
+
+		// Bind shader textures
+		MipChainComputeShader->BindShaderTextures(RHICmdList, Target.MipUAVs, Target.Mip0SRV, GroupCounterBufferUAV, GroupMip6BufferUAV);
+
+		// Bind shader uniform
+		FMipChainComputeShader::FParameters UniformParam;
+		UniformParam.MipCount = MipCount;
+		UniformParam.CounterIndex = CounterIndex;
+		UniformParam.bNormalMap = bNormalMap ? 1 : 0;
+		MipChainComputeShader->SetShaderParameters(RHICmdList, UniformParam);
+
+		// Dispatch shader
+		const int ThreadGroupCountX = StaticCast<int>(Config.TextureWidth / MipChainTileSize);
+		const int ThreadGroupCountY = StaticCast<int>(Config.TextureHeight / MipChainTileSize);
+		DispatchComputeShader(RHICmdList, *MipChainComputeShader, ThreadGroupCountX, ThreadGroupCountY, 1);
+
+		// Unbind shader textures
+		MipChainComputeShader->UnbindShaderTextures(RHICmdList);
+	}
+
+	// Resolve every mip the output render target has room for
+	if (TargetRef)
+	{
+		const uint32 TargetWidth = TargetRef->GetSizeXYZ().X;
+		const uint32 TargetHeight = TargetRef->GetSizeXYZ().Y;
+
+		// While the simulation resolution steps, the render target is briefly smaller and takes the matching mips.
+		// A larger target keeps its previous frame instead.
+		if (TargetWidth > Config.TextureWidth || TargetHeight > Config.TextureHeight)
+		{
+			return;
+		}
+
+		const uint32 MipOffset = FMath::FloorLog2(Config.TextureWidth) - FMath::FloorLog2(TargetWidth);
+		const uint32 ResolveMipCount = MipCount > MipOffset ? FMath::Min(MipCount - MipOffset, TargetRef->GetNumMips()) : 0;
+
+		for (uint32 Mip = 0; Mip < ResolveMipCount; ++Mip)
+		{
+			if (MipOffset == 0)
+			{
+				FResolveParams ResolveParams;
+				ResolveParams.MipIndex = Mip;
+				RHICmdList.CopyToResolveTarget(Target.Texture, TargetRef, ResolveParams);
+			}
+			else
+			{
+				FRHICopyTextureInfo CopyInfo;
+				CopyInfo.Size = FIntVector(FMath::Max(TargetWidth >> Mip, 1u), FMath::Max(TargetHeight >> Mip, 1u), 1);
+				CopyInfo.SourceMipIndex = Mip + MipOffset;
+				CopyInfo.DestMipIndex = Mip;
+				RHICmdList.CopyTexture(Target.Texture, TargetRef, CopyInfo);
+			}
+		}
+	}
+}
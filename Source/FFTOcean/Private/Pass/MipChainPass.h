@@ -0,0 +1,66 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Pass/PassUtil.h"
+
+struct FMipChainPassConfig
+{
+	uint32 TextureWidth;
+	uint32 TextureHeight;
+};
+
+struct FMipChainPassParam
+{
+	FTexture2DRHIRef DisplacementTexture;
+	FTexture2DRHIRef NormalTexture;
+};
+
+class FMipChainPass final : public FOceanRenderPass
+{
+public:
+
+	FMipChainPass();
+	~FMipChainPass();
+
+	virtual bool IsValidPass() const override;
+	virtual void ReleaseRenderResource() override;
+
+	void Render(
+		FRHICommandListImmediate& RHICmdList,
+		const FMipChainPassConfig& InConfig,
+		const FMipChainPassParam& Param,
+		FRHITexture* DisplacementTargetRef,
+		FRHITexture* NormalTargetRef);
+
+	// Creates the pass resources ahead of the first render
+	void Prepare(const FMipChainPassConfig& InConfig);
+
+private:
+
+	struct FMipChainTarget
+	{
+		FTexture2DRHIRef           Texture;
+		FShaderResourceViewRHIRef  Mip0SRV;
+		FUnorderedAccessViewRHIRef MipUAVs[OCEAN_MAX_MIP_COUNT];
+	};
+
+	FMipChainPassConfig Config;
+
+	// One counter per target, reset to zero by the last group of each dispatch
+	FVertexBufferRHIRef        GroupCounterBuffer;
+	FUnorderedAccessViewRHIRef GroupCounterBufferUAV;
+
+	// Mip 6 texel of every group, read back by the last group instead of loading from the mip 6 UAV
+	FStructuredBufferRHIRef    GroupMip6Buffer;
+	FUnorderedAccessViewRHIRef GroupMip6BufferUAV;
+
+	FMipChainTarget DisplacementTarget;
+	FMipChainTarget NormalTarget;
+
+	void ConfigurePass(const FMipChainPassConfig& InConfig);
+	void ConfigureTarget(FMipChainTarget& Target, FTexture2DRHIRef Texture);
+	void ReleaseTarget(FMipChainTarget& Target);
+
+	void RenderMipChain(FRHICommandListImmediate& RHICmdList, const FMipChainTarget& Target, uint32 CounterIndex, bool bNormalMap, FRHITexture* TargetRef);
+};
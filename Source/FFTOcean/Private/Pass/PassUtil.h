@@ -11,13 +11,22 @@
 #include "RenderCore/Public/ShaderParameterMacros.h"
 #include "Engine/Classes/Engine/TextureRenderTarget2D.h"
 
+// Drops our reference, the RHI keeps the resource alive until the GPU is done with it
 #define SafeReleaseTextureResource(Texture)  \
 	do {                                     \
-		if (Texture.IsValid()) {             \
-			Texture->Release();              \
-		}                                    \
+		Texture.SafeRelease();               \
 	} while(0);
 
+// Hermitian surface spectra with two real outputs packed into each transform: the X/Y displacement spectrum, the
+// Z displacement and cross derivative spectrum, the X/Y displacement derivative spectrum for the Jacobian, plus the
+// X/Y slope spectrum when analytic normals are enabled
+#define OCEAN_FOURIER_COMPONENT_COUNT  4
+#define OCEAN_JACOBIAN_COMPONENT_INDEX 2
+#define OCEAN_SLOPE_COMPONENT_INDEX    3
+
+// Mip chains are generated for textures of up to 1024x1024
+#define OCEAN_MAX_MIP_COUNT 11
+
 class FOceanRenderPass
 {
 public:
@@ -37,20 +46,22 @@ public:
 
 namespace FFTOcean
 {
-	inline FRHITexture* GetRHITextureFromRenderTarget(const UTextureRenderTarget2D* RenderTarget)
+	// Taken on the game thread, the reference stays valid on the render thread even if the render target is resized meanwhile
+	inline FTextureReferenceRHIRef GetTextureReferenceFromTexture(const UTexture* Texture)
 	{
-		if (RenderTarget)
-		{
-			FTextureReferenceRHIRef OutputRenderTargetTextureRHI = RenderTarget->TextureReference.TextureReferenceRHI;
-
-			checkf(OutputRenderTargetTextureRHI, TEXT("Can't get render target %d texture"));
+		return Texture ? Texture->TextureReference.TextureReferenceRHI : FTextureReferenceRHIRef();
+	}
 
-			FRHITexture* RenderTargetTextureRef = OutputRenderTargetTextureRHI->GetTextureReference()->GetReferencedTexture();
+	inline FRHITexture* GetRHITextureFromTextureReference(const FTextureReferenceRHIRef& TextureReference)
+	{
+		check(IsInRenderingThread());
 
-			return RenderTargetTextureRef;
-		}
+		return TextureReference ? TextureReference->GetReferencedTexture() : nullptr;
+	}
 
-		return nullptr;
+	inline uint32 GetMipCount(uint32 TextureWidth, uint32 TextureHeight)
+	{
+		return FMath::Min<uint32>(FMath::FloorLog2(FMath::Max(TextureWidth, TextureHeight)) + 1, OCEAN_MAX_MIP_COUNT);
 	}
 
 	inline FRHITexture* GetRHITextureFromTexture2D(const UTexture2D* Texture)
@@ -94,8 +94,17 @@ inline bool operator!=(const FPhillipsFourierPassConfig& A, const FPhillipsFouri
 	return !(A == B);
 }
 
-FPhillipsFourierPass::FPhillipsFourierPass()
+inline bool operator==(const FPhillipsFourierPassParam& A, const FPhillipsFourierPassParam& B)
 {
+	return FMemory::Memcmp(&A, &B, sizeof(FPhillipsFourierPassParam)) == 0;
+}
+
+FPhillipsFourierPass::FPhillipsFourierPass() :
+	OutgoingSpectrumIndex(0),
+	IncomingSpectrumIndex(0)
+{
+	FMemory::Memzero(SpectrumParams);
+	FMemory::Memzero(bSpectrumGenerated);
 }
 
 FPhillipsFourierPass::~FPhillipsFourierPass()
@@ -105,18 +114,36 @@ FPhillipsFourierPass::~FPhillipsFourierPass()
 
 bool FPhillipsFourierPass::IsValidPass() const
 {
-	bool bValid = !!OutputPhillipsFourierTexture;
-	bValid &= !!OutputPhillipsFourierTextureUAV;
-	bValid &= !!OutputPhillipsFourierTextureSRV;
+	bool bValid = true;
+
+	for (int32 Index = 0; Index < OCEAN_SPECTRUM_COUNT; ++Index)
+	{
+		bValid &= !!OutputPhillipsFourierTextures[Index];
+		bValid &= !!OutputPhillipsFourierTextureUAVs[Index];
+		bValid &= !!OutputPhillipsFourierTextureSRVs[Index];
+	}
 
 	return bValid;
 }
 
 void FPhillipsFourierPass::ReleaseRenderResource()
 {
-	SafeReleaseTextureResource(OutputPhillipsFourierTexture);
-	SafeReleaseTextureResource(OutputPhillipsFourierTextureUAV);
-	SafeReleaseTextureResource(OutputPhillipsFourierTextureSRV);
+	for (FTexture2DRHIRef& Texture : OutputPhillipsFourierTextures)
+	{
+		SafeReleaseTextureResource(Texture);
+	}
+
+	for (FUnorderedAccessViewRHIRef& TextureUAV : OutputPhillipsFourierTextureUAVs)
+	{
+		SafeReleaseTextureResource(TextureUAV);
+	}
+
+	for (FShaderResourceViewRHIRef& TextureSRV : OutputPhillipsFourierTextureSRVs)
+	{
+		SafeReleaseTextureResource(TextureSRV);
+	}
+
+	FMemory::Memzero(bSpectrumGenerated);
 }
 
 void FPhillipsFourierPass::ConfigurePass(const FPhillipsFourierPassConfig& InConfig)
@@ -130,13 +157,32 @@ void FPhillipsFourierPass::ConfigurePass(const FPhillipsFourierPassConfig& InCon
 	uint32 TextureWidth = InConfig.TextureWidth;
 	uint32 TextureHeight = InConfig.TextureHeight;
 	
-	OutputPhillipsFourierTexture = RHICreateTexture2D(TextureWidth, TextureHeight, PF_FloatRGBA, 1, 1, TexCreate_ShaderResource | TexCreate_UAV, CreateInfo);
-	OutputPhillipsFourierTextureUAV = RHICreateUnorderedAccessView(OutputPhillipsFourierTexture);
-	OutputPhillipsFourierTextureSRV = RHICreateShaderResourceView(OutputPhillipsFourierTexture, 0);
+	for (int32 Index = 0; Index < OCEAN_SPECTRUM_COUNT; ++Index)
+	{
+		// Only the real parts of h0(k) and h0(-k) are ever read
+		OutputPhillipsFourierTextures[Index] = RHICreateTexture2D(TextureWidth, TextureHeight, PF_G16R16F, 1, 1, TexCreate_ShaderResource | TexCreate_UAV, CreateInfo);
+		OutputPhillipsFourierTextureUAVs[Index] = RHICreateUnorderedAccessView(OutputPhillipsFourierTextures[Index]);
+		OutputPhillipsFourierTextureSRVs[Index] = RHICreateShaderResourceView(OutputPhillipsFourierTextures[Index], 0);
+	}
+}
+
+void FPhillipsFourierPass::Prepare(const FPhillipsFourierPassConfig& InConfig)
+{
+	if (Config != InConfig)
+	{
+		ConfigurePass(InConfig);
+	}
 }
 
-void FPhillipsFourierPass::Render(const FPhillipsFourierPassConfig& InConfig, const FPhillipsFourierPassParam& Param, FRHITexture* DebugTextureRef)
+void FPhillipsFourierPass::Render(
+	FRHICommandListImmediate& RHICmdList,
+	const FPhillipsFourierPassConfig& InConfig,
+	const FPhillipsFourierPassParam& OutgoingParam,
+	const FPhillipsFourierPassParam& IncomingParam,
+	FRHITexture* DebugTextureRef)
 {
+	check(IsInRenderingThread());
+
 	if (Config != InConfig)
 	{
 		ConfigurePass(InConfig);
@@ -144,38 +190,65 @@ void FPhillipsFourierPass::Render(const FPhillipsFourierPassConfig& InConfig, co
 
 	if (IsValidPass())
 	{
-		ENQUEUE_RENDER_COMMAND(PhillipsFourierPassCommand)
-		(
-			[Param, DebugTextureRef, this](FRHICommandListImmediate& RHICmdList)
-			{
-				check(IsInRenderingThread());
+		// A new incoming spectrum goes into the slot the outgoing one doesn't use, so it is generated once when the
+		// transition starts and only read afterwards
+		OutgoingSpectrumIndex = FindSpectrum(OutgoingParam);
+		if (OutgoingSpectrumIndex == INDEX_NONE)
+		{
+			OutgoingSpectrumIndex = FindSpectrum(IncomingParam) == 0 ? 1 : 0;
+			GenerateSpectrum(RHICmdList, OutgoingSpectrumIndex, OutgoingParam);
+		}
+
+		IncomingSpectrumIndex = FindSpectrum(IncomingParam);
+		if (IncomingSpectrumIndex == INDEX_NONE)
+		{
+			IncomingSpectrumIndex = 1 - OutgoingSpectrumIndex;
+			GenerateSpectrum(RHICmdList, IncomingSpectrumIndex, IncomingParam);
+		}
+
+		// Debug drawing
+		if (DebugTextureRef)
+		{
+			RHICmdList.CopyToResolveTarget(OutputPhillipsFourierTextures[IncomingSpectrumIndex], DebugTextureRef, FResolveParams());
+		}
+	}
+}
+
+int32 FPhillipsFourierPass::FindSpectrum(const FPhillipsFourierPassParam& Param) const
+{
+	for (int32 Index = 0; Index < OCEAN_SPECTRUM_COUNT; ++Index)
+	{
+		if (bSpectrumGenerated[Index] && SpectrumParams[Index] == Param)
+		{
+			return Index;
+		}
+	}
 
-				TShaderMapRef<FPhillipsFourierComputeShader> PhillipsFourierComputeShader(GetGlobalShaderMap(ERHIFeatureLevel::SM5));
-				RHICmdList.SetComputeShader(PhillipsFourierComputeShader->GetComputeShader());
+	return INDEX_NONE;
+}
 
-				// Bind shader textures
-				PhillipsFourierComputeShader->BindShaderTextures(RHICmdList, OutputPhillipsFourierTextureUAV);
+void FPhillipsFourierPass::GenerateSpectrum(FRHICommandListImmediate& RHICmdList, int32 SpectrumIndex, const FPhillipsFourierPassParam& Param)
+{
+	TShaderMapRef<FPhillipsFourierComputeShader> PhillipsFourierComputeShader(GetGlobalShaderMap(ERHIFeatureLevel::SM5));
+	RHICmdList.SetComputeShader(PhillipsFourierComputeShader->GetComputeShader());
 
-				// Bind shader uniform
-				FPhillipsFourierComputeShader::FParameters UniformParam;
-				UniformParam.WaveAmplitude = Param.WaveAmplitude;
-				UniformParam.WindSpeed = Param.WindSpeed;
-				PhillipsFourierComputeShader->SetShaderParameters(RHICmdList, UniformParam);
+	// Bind shader textures
+	PhillipsFourierComputeShader->BindShaderTextures(RHICmdList, OutputPhillipsFourierTextureUAVs[SpectrumIndex]);
 
-				// Dispatch shader
-				const int ThreadGroupCountX = StaticCast<int>(Config.TextureWidth / 32);
-				const int ThreadGroupCountY = StaticCast<int>(Config.TextureHeight / 32);
-				DispatchComputeShader(RHICmdList, *PhillipsFourierComputeShader, ThreadGroupCountX, ThreadGroupCountY, 1);
+	// Bind shader uniform
+	FPhillipsFourierComputeShader::FParameters UniformParam;
+	UniformParam.WaveAmplitude = Param.WaveAmplitude;
+	UniformParam.WindSpeed = Param.WindSpeed;
+	PhillipsFourierComputeShader->SetShaderParameters(RHICmdList, UniformParam);
 
-				// Unbind shader textures
-				PhillipsFourierComputeShader->UnbindShaderTextures(RHICmdList);
+	// Dispatch shader
+	const int ThreadGroupCountX = StaticCast<int>(Config.TextureWidth / 32);
+	const int ThreadGroupCountY = StaticCast<int>(Config.TextureHeight / 32);
+	DispatchComputeShader(RHICmdList, *PhillipsFourierComputeShader, ThreadGroupCountX, ThreadGroupCountY, 1);
 
-				// Debug drawing
-				if (DebugTextureRef)
-				{
-					RHICmdList.CopyToResolveTarget(OutputPhillipsFourierTexture, DebugTextureRef, FResolveParams());
-				}
-			}
-		);
-	}
-}
+	// Unbind shader textures
+	PhillipsFourierComputeShader->UnbindShaderTextures(RHICmdList);
+
+	SpectrumParams[SpectrumIndex] = Param;
+	bSpectrumGenerated[SpectrumIndex] = true;
+}
\ No newline at end of file
@@ -16,6 +16,10 @@ struct FPhillipsFourierPassParam
 	FVector2D WindSpeed;
 };
 
+// Number of spectra kept at once, the outgoing and the incoming sea state of a transition
+#define OCEAN_SPECTRUM_COUNT 2
+
+// Keeps the h0 spectra of the outgoing and incoming sea state, each one is only generated when its parameters change
 class FPhillipsFourierPass final : public FOceanRenderPass
 {
 public:
@@ -26,20 +30,54 @@ public:
 	virtual bool IsValidPass() const override;
 	virtual void ReleaseRenderResource() override;
 
-	void Render(const FPhillipsFourierPassConfig& InConfig, const FPhillipsFourierPassParam& Param, FRHITexture* DebugTextureRef);
+	// Generates whichever of the two spectra isn't held by a slot yet, both are the same slot when no transition runs
+	void Render(
+		FRHICommandListImmediate& RHICmdList,
+		const FPhillipsFourierPassConfig& InConfig,
+		const FPhillipsFourierPassParam& OutgoingParam,
+		const FPhillipsFourierPassParam& IncomingParam,
+		FRHITexture* DebugTextureRef);
+
+	// Creates the pass resources ahead of the first render
+	void Prepare(const FPhillipsFourierPassConfig& InConfig);
+
+	FORCEINLINE FShaderResourceViewRHIRef GetOutgoingPhillipsFourierTextureSRV() const
+	{
+		return OutputPhillipsFourierTextureSRVs[OutgoingSpectrumIndex];
+	}
+
+	FORCEINLINE FShaderResourceViewRHIRef GetIncomingPhillipsFourierTextureSRV() const
+	{
+		return OutputPhillipsFourierTextureSRVs[IncomingSpectrumIndex];
+	}
+
+	FORCEINLINE FTexture2DRHIRef GetOutgoingPhillipsFourierTexture() const
+	{
+		return OutputPhillipsFourierTextures[OutgoingSpectrumIndex];
+	}
 
-	FORCEINLINE FShaderResourceViewRHIRef GetPhillipsFourierTextureSRV() const
+	FORCEINLINE FTexture2DRHIRef GetIncomingPhillipsFourierTexture() const
 	{
-		return OutputPhillipsFourierTextureSRV;
+		return OutputPhillipsFourierTextures[IncomingSpectrumIndex];
 	}
 
 private:
 
-	FTexture2DRHIRef           OutputPhillipsFourierTexture;
-	FUnorderedAccessViewRHIRef OutputPhillipsFourierTextureUAV;
-	FShaderResourceViewRHIRef  OutputPhillipsFourierTextureSRV;
+	FTexture2DRHIRef           OutputPhillipsFourierTextures[OCEAN_SPECTRUM_COUNT];
+	FUnorderedAccessViewRHIRef OutputPhillipsFourierTextureUAVs[OCEAN_SPECTRUM_COUNT];
+	FShaderResourceViewRHIRef  OutputPhillipsFourierTextureSRVs[OCEAN_SPECTRUM_COUNT];
+
+	// Parameters each slot was generated with
+	FPhillipsFourierPassParam SpectrumParams[OCEAN_SPECTRUM_COUNT];
+	bool                      bSpectrumGenerated[OCEAN_SPECTRUM_COUNT];
+
+	int32 OutgoingSpectrumIndex;
+	int32 IncomingSpectrumIndex;
 
 	FPhillipsFourierPassConfig Config;
 
 	void ConfigurePass(const FPhillipsFourierPassConfig& InConfig);
+
+	int32 FindSpectrum(const FPhillipsFourierPassParam& Param) const;
+	void GenerateSpectrum(FRHICommandListImmediate& RHICmdList, int32 SpectrumIndex, const FPhillipsFourierPassParam& Param);
 };
\ No newline at end of file
@@ -0,0 +1,186 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "Pass/StreamPlaybackPass.h"
+#include "RenderCore/Public/GlobalShader.h"
+#include "RenderCore/Public/ShaderParameterUtils.h"
+#include "RenderCore/Public/ShaderParameterMacros.h"
+
+#include "Public/GlobalShader.h"
+#include "Public/PipelineStateCache.h"
+#include "Public/RHIStaticStates.h"
+#include "Public/ShaderParameterUtils.h"
+#include "RHI/Public/RHICommandList.h"
+
+BEGIN_GLOBAL_SHADER_PARAMETER_STRUCT(FStreamPlaybackComputeShaderParameters, )
+	SHADER_PARAMETER(float, FrameBlend)
+END_GLOBAL_SHADER_PARAMETER_STRUCT()
+IMPLEMENT_GLOBAL_SHADER_PARAMETER_STRUCT(FStreamPlaybackComputeShaderParameters, "StreamPlaybackUniform");
+
+class FStreamPlaybackComputeShader : public FGlobalShader
+{
+	DECLARE_SHADER_TYPE(FStreamPlaybackComputeShader, Global);
+	using FParameters = FStreamPlaybackComputeShaderParameters;
+
+public:
+
+	FStreamPlaybackComputeShader() {}
+	FStreamPlaybackComputeShader(const ShaderMetaType::CompiledShaderInitializerType& Initializer) :
+		FGlobalShader(Initializer)
+	{
+		InputDisplacementFrameA.Bind(Initializer.ParameterMap, TEXT("InputDisplacementFrameA"));
+		InputDisplacementFrameB.Bind(Initializer.ParameterMap, TEXT("InputDisplacementFrameB"));
+		InputNormalFrameA.Bind(Initializer.ParameterMap, TEXT("InputNormalFrameA"));
+		InputNormalFrameB.Bind(Initializer.ParameterMap, TEXT("InputNormalFrameB"));
+		OutputDisplacementTexture.Bind(Initializer.ParameterMap, TEXT("OutputDisplacementTexture"));
+		OutputNormalTexture.Bind(Initializer.ParameterMap, TEXT("OutputNormalTexture"));
+	}
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+
+	virtual bool Serialize(FArchive& Ar) override
+	{
+		bool bShaderHasOutdatedParameters = FGlobalShader::Serialize(Ar);
+
+		Ar << InputDisplacementFrameA;
+		Ar << InputDisplacementFrameB;
+		Ar << InputNormalFrameA;
+		Ar << InputNormalFrameB;
+		Ar << OutputDisplacementTexture;
+		Ar << OutputNormalTexture;
+
+		return bShaderHasOutdatedParameters;
+	}
+
+	void BindShaderTextures(
+		FRHICommandList& RHICmdList,
+		const FStreamPlaybackPassParam& Param,
+		FUnorderedAccessViewRHIRef DisplacementOutputTextureUAV,
+		FUnorderedAccessViewRHIRef NormalOutputTextureUAV)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetTextureParameter(RHICmdList, ComputeShaderRHI, InputDisplacementFrameA, Param.DisplacementFrameA);
+		SetTextureParameter(RHICmdList, ComputeShaderRHI, InputDisplacementFrameB, Param.DisplacementFrameB);
+		SetTextureParameter(RHICmdList, ComputeShaderRHI, InputNormalFrameA, Param.NormalFrameA);
+		SetTextureParameter(RHICmdList, ComputeShaderRHI, InputNormalFrameB, Param.NormalFrameB);
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputDisplacementTexture, DisplacementOutputTextureUAV);
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputNormalTexture, NormalOutputTextureUAV);
+	}
+
+	void UnbindShaderTextures(FRHICommandList& RHICmdList)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputDisplacementTexture, FUnorderedAccessViewRHIRef());
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputNormalTexture, FUnorderedAccessViewRHIRef());
+	}
+
+	void SetShaderParameters(FRHICommandList& RHICmdList, const FParameters& Parameters)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetUniformBufferParameterImmediate(RHICmdList, ComputeShaderRHI, GetUniformBufferParameter<FParameters>(), Parameters);
+	}
+
+private:
+
+	FShaderResourceParameter InputDisplacementFrameA;
+	FShaderResourceParameter InputDisplacementFrameB;
+	FShaderResourceParameter InputNormalFrameA;
+	FShaderResourceParameter InputNormalFrameB;
+	FShaderResourceParameter OutputDisplacementTexture;
+	FShaderResourceParameter OutputNormalTexture;
+};
+
+IMPLEMENT_SHADER_TYPE(, FStreamPlaybackComputeShader, TEXT("/Plugin/FFTOcean/StreamPlaybackComputeShader.usf"), TEXT("ComputeStreamPlayback"), SF_Compute)
+
+inline bool operator==(const FStreamPlaybackPassConfig& A, const FStreamPlaybackPassConfig& B)
+{
+	return FMemory::Memcmp(&A, &B, sizeof(FStreamPlaybackPassConfig)) == 0;
+}
+
+inline bool operator!=(const FStreamPlaybackPassConfig& A, const FStreamPlaybackPassConfig& B)
+{
+	return !(A == B);
+}
+
+FStreamPlaybackPass::FStreamPlaybackPass()
+{
+	FMemory::Memzero(Config);
+}
+
+FStreamPlaybackPass::~FStreamPlaybackPass()
+{
+	ReleaseRenderResource();
+}
+
+bool FStreamPlaybackPass::IsValidPass() const
+{
+	bool bValid = !!OutputDisplacementTexture;
+	bValid &= !!OutputDisplacementTextureUAV;
+	bValid &= !!OutputNormalTexture;
+	bValid &= !!OutputNormalTextureUAV;
+
+	return bValid;
+}
+
+void FStreamPlaybackPass::ReleaseRenderResource()
+{
+	SafeReleaseTextureResource(OutputDisplacementTexture);
+	SafeReleaseTextureResource(OutputDisplacementTextureUAV);
+	SafeReleaseTextureResource(OutputNormalTexture);
+	SafeReleaseTextureResource(OutputNormalTextureUAV);
+}
+
+void FStreamPlaybackPass::Render(FRHICommandListImmediate& RHICmdList, const FStreamPlaybackPassConfig& InConfig, const FStreamPlaybackPassParam& Param)
+{
+	check(IsInRenderingThread());
+
+	if (Config != InConfig)
+	{
+		ConfigurePass(InConfig);
+	}
+
+	if (IsValidPass() && Param.DisplacementFrameA && Param.DisplacementFrameB && Param.NormalFrameA && Param.NormalFrameB)
+	{
+		TShaderMapRef<FStreamPlaybackComputeShader> StreamPlaybackComputeShader(GetGlobalShaderMap(ERHIFeatureLevel::SM5));
+		RHICmdList.SetComputeShader(StreamPlaybackComputeShader->GetComputeShader());
+
+		// Bind shader textures
+		StreamPlaybackComputeShader->BindShaderTextures(RHICmdList, Param, OutputDisplacementTextureUAV, OutputNormalTextureUAV);
+
+		// Bind shader uniform
+		FStreamPlaybackComputeShader::FParameters UniformParam;
+		UniformParam.FrameBlend = Param.FrameBlend;
+		StreamPlaybackComputeShader->SetShaderParameters(RHICmdList, UniformParam);
+
+		// Dispatch shader
+		const int ThreadGroupCountX = StaticCast<int>(Config.TextureWidth / 32);
+		const int ThreadGroupCountY = StaticCast<int>(Config.TextureHeight / 32);
+		DispatchComputeShader(RHICmdList, *StreamPlaybackComputeShader, ThreadGroupCountX, ThreadGroupCountY, 1);
+
+		// Unbind shader textures
+		StreamPlaybackComputeShader->UnbindShaderTextures(RHICmdList);
+	}
+}
+
+void FStreamPlaybackPass::ConfigurePass(const FStreamPlaybackPassConfig& InConfig)
+{
+	// Always release current resource before creating new render resources
+	ReleaseRenderResource();
+
+	Config = InConfig;
+
+	FRHIResourceCreateInfo CreateInfo;
+	uint32 TextureWidth = InConfig.TextureWidth;
+	uint32 TextureHeight = InConfig.TextureHeight;
+
+	// Same layout as the simulated surface, so the mip chain pass can take over from here
+	uint32 MipCount = FFTOcean::GetMipCount(TextureWidth, TextureHeight);
+
+	OutputDisplacementTexture = RHICreateTexture2D(TextureWidth, TextureHeight, PF_FloatRGBA, MipCount, 1, TexCreate_ShaderResource | TexCreate_UAV, CreateInfo);
+	OutputDisplacementTextureUAV = RHICreateUnorderedAccessView(OutputDisplacementTexture);
+
+	OutputNormalTexture = RHICreateTexture2D(TextureWidth, TextureHeight, PF_FloatRGBA, MipCount, 1, TexCreate_ShaderResource | TexCreate_UAV, CreateInfo);
+	OutputNormalTextureUAV = RHICreateUnorderedAccessView(OutputNormalTexture);
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Pass/PassUtil.h"
+
+struct FStreamPlaybackPassConfig
+{
+	uint32 TextureWidth;
+	uint32 TextureHeight;
+};
+
+struct FStreamPlaybackPassParam
+{
+	// Two consecutive streamed frames
+	FRHITexture* DisplacementFrameA;
+	FRHITexture* DisplacementFrameB;
+	FRHITexture* NormalFrameA;
+	FRHITexture* NormalFrameB;
+
+	float FrameBlend;
+};
+
+// Blends the two streamed frames around the playback time, the streamed counterpart of the flipbook playback pass
+class FStreamPlaybackPass final : public FOceanRenderPass
+{
+public:
+
+	FStreamPlaybackPass();
+	~FStreamPlaybackPass();
+
+	virtual bool IsValidPass() const override;
+	virtual void ReleaseRenderResource() override;
+
+	void Render(FRHICommandListImmediate& RHICmdList, const FStreamPlaybackPassConfig& InConfig, const FStreamPlaybackPassParam& Param);
+
+	FORCEINLINE FTexture2DRHIRef GetDisplacementTexture() const
+	{
+		return OutputDisplacementTexture;
+	}
+
+	FORCEINLINE FTexture2DRHIRef GetNormalTexture() const
+	{
+		return OutputNormalTexture;
+	}
+
+private:
+
+	FStreamPlaybackPassConfig Config;
+
+	FTexture2DRHIRef           OutputDisplacementTexture;
+	FUnorderedAccessViewRHIRef OutputDisplacementTextureUAV;
+	FTexture2DRHIRef           OutputNormalTexture;
+	FUnorderedAccessViewRHIRef OutputNormalTextureUAV;
+
+	void ConfigurePass(const FStreamPlaybackPassConfig& InConfig);
+};
\ No newline at end of file
@@ -21,9 +21,16 @@
 
 #include "Math/UnrealMathUtility.h"
 
+BEGIN_GLOBAL_SHADER_PARAMETER_STRUCT(FSurfaceDisplacementComputeShaderParameters, )
+	SHADER_PARAMETER(uint32, bAnalyticNormals)
+	SHADER_PARAMETER(float,  NormalStrength)
+END_GLOBAL_SHADER_PARAMETER_STRUCT()
+IMPLEMENT_GLOBAL_SHADER_PARAMETER_STRUCT(FSurfaceDisplacementComputeShaderParameters, "SurfaceDisplacementUniform");
+
 class FSurfaceDisplacementComputeShader : public FGlobalShader
 {
 	DECLARE_SHADER_TYPE(FSurfaceDisplacementComputeShader, Global);
+	using FParameters = FSurfaceDisplacementComputeShaderParameters;
 
 public:
 
@@ -32,9 +39,11 @@ public:
 		FGlobalShader(Initializer)
 	{
 		OutputDisplacementTexture.Bind(Initializer.ParameterMap, TEXT("OutputDisplacementTexture"));
-		InputDisplacementTextureX.Bind(Initializer.ParameterMap, TEXT("InputDisplacementTextureX"));
-		InputDisplacementTextureY.Bind(Initializer.ParameterMap, TEXT("InputDisplacementTextureY"));
+		InputDisplacementTextureXY.Bind(Initializer.ParameterMap, TEXT("InputDisplacementTextureXY"));
 		InputDisplacementTextureZ.Bind(Initializer.ParameterMap, TEXT("InputDisplacementTextureZ"));
+		InputJacobianTexture.Bind(Initializer.ParameterMap, TEXT("InputJacobianTexture"));
+		InputSlopeTexture.Bind(Initializer.ParameterMap, TEXT("InputSlopeTexture"));
+		OutputNormalTexture.Bind(Initializer.ParameterMap, TEXT("OutputNormalTexture"));
 	}
 
 	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
@@ -52,9 +61,11 @@ public:
 		bool bShaderHasOutdatedParameters = FGlobalShader::Serialize(Ar);
 
 		Ar << OutputDisplacementTexture;
-		Ar << InputDisplacementTextureX;
-		Ar << InputDisplacementTextureY;
+		Ar << InputDisplacementTextureXY;
 		Ar << InputDisplacementTextureZ;
+		Ar << InputJacobianTexture;
+		Ar << InputSlopeTexture;
+		Ar << OutputNormalTexture;
 
 		return bShaderHasOutdatedParameters;
 	}
@@ -62,32 +73,46 @@ public:
 	void BindShaderTextures(
 		FRHICommandList& RHICmdList,
 		FUnorderedAccessViewRHIRef OutputTextureUAV,
-		FShaderResourceViewRHIRef XInputTextureSRV,
-		FShaderResourceViewRHIRef YInputTextureSRV,
-		FShaderResourceViewRHIRef ZInputTextureSRV)
+		FShaderResourceViewRHIRef XYInputTextureSRV,
+		FShaderResourceViewRHIRef ZInputTextureSRV,
+		FShaderResourceViewRHIRef JacobianInputTextureSRV,
+		FShaderResourceViewRHIRef SlopeInputTextureSRV,
+		FUnorderedAccessViewRHIRef NormalOutputTextureUAV)
 	{
 		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
 		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputDisplacementTexture, OutputTextureUAV);
-		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputDisplacementTextureX, XInputTextureSRV);
-		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputDisplacementTextureY, YInputTextureSRV);
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputDisplacementTextureXY, XYInputTextureSRV);
 		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputDisplacementTextureZ, ZInputTextureSRV);
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputJacobianTexture, JacobianInputTextureSRV);
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputSlopeTexture, SlopeInputTextureSRV);
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputNormalTexture, NormalOutputTextureUAV);
 	}
 
 	void UnbindShaderTextures(FRHICommandList& RHICmdList)
 	{
 		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
 		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputDisplacementTexture, FUnorderedAccessViewRHIRef());
-		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputDisplacementTextureX, FShaderResourceViewRHIRef());
-		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputDisplacementTextureY, FShaderResourceViewRHIRef());
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputDisplacementTextureXY, FShaderResourceViewRHIRef());
 		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputDisplacementTextureZ, FShaderResourceViewRHIRef());
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputJacobianTexture, FShaderResourceViewRHIRef());
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputSlopeTexture, FShaderResourceViewRHIRef());
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputNormalTexture, FUnorderedAccessViewRHIRef());
+	}
+
+	void SetShaderParameters(FRHICommandList& RHICmdList, const FParameters& Parameters)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetUniformBufferParameterImmediate(RHICmdList, ComputeShaderRHI, GetUniformBufferParameter<FParameters>(), Parameters);
 	}
 
 private:
 
 	FShaderResourceParameter OutputDisplacementTexture;
-	FShaderResourceParameter InputDisplacementTextureX;
-	FShaderResourceParameter InputDisplacementTextureY;
+	FShaderResourceParameter InputDisplacementTextureXY;
 	FShaderResourceParameter InputDisplacementTextureZ;
+	FShaderResourceParameter InputJacobianTexture;
+	FShaderResourceParameter InputSlopeTexture;
+	FShaderResourceParameter OutputNormalTexture;
 };
 
 IMPLEMENT_SHADER_TYPE(, FSurfaceDisplacementComputeShader,  TEXT("/Plugin/FFTOcean/SurfaceDisplacementComputeShader.usf"), TEXT("ComputeSurfaceDisplacement"), SF_Compute)
@@ -128,8 +153,18 @@ void FSurfaceDisplacementPass::ReleaseRenderResource()
 	SafeReleaseTextureResource(OutputSurfaceDisplacementTextureUAV);
 }
 
-void FSurfaceDisplacementPass::Render(const FSurfaceDisplacementPassConfig& InConfig, const FSurfaceDisplacementPassParam& Param, FRHITexture* DebugTextureRef)
+void FSurfaceDisplacementPass::Prepare(const FSurfaceDisplacementPassConfig& InConfig)
+{
+	if (Config != InConfig)
+	{
+		ConfigurePass(InConfig);
+	}
+}
+
+void FSurfaceDisplacementPass::Render(FRHICommandListImmediate& RHICmdList, const FSurfaceDisplacementPassConfig& InConfig, const FSurfaceDisplacementPassParam& Param, FRHITexture* DebugTextureRef)
 {
+	check(IsInRenderingThread());
+
 	if (Config != InConfig)
 	{
 		ConfigurePass(InConfig);
@@ -137,38 +172,38 @@ void FSurfaceDisplacementPass::Render(const FSurfaceDisplacementPassConfig& InCo
 
 	if (IsValidPass())
 	{
-		ENQUEUE_RENDER_COMMAND(SurfaceDisplacementPassCommand)
-		(
-			[InConfig, Param, DebugTextureRef, this](FRHICommandListImmediate& RHICmdList)
-			{
-				check(IsInRenderingThread());
-
-				TShaderMapRef<FSurfaceDisplacementComputeShader> SurfaceDisplacementComputeShader(GetGlobalShaderMap(ERHIFeatureLevel::SM5));
-				RHICmdList.SetComputeShader(SurfaceDisplacementComputeShader->GetComputeShader());
-
-				// Bind shader textures
-				SurfaceDisplacementComputeShader->BindShaderTextures(
-					RHICmdList,
-					OutputSurfaceDisplacementTextureUAV,
-					Param.InverseTransformTextureSRVs[0],
-					Param.InverseTransformTextureSRVs[1],
-					Param.InverseTransformTextureSRVs[2]);
-
-				// Dispatch shader
-				const int ThreadGroupCountX = StaticCast<int>(Config.TextureWidth / 32);
-				const int ThreadGroupCountY = StaticCast<int>(Config.TextureHeight / 32);
-				DispatchComputeShader(RHICmdList, *SurfaceDisplacementComputeShader, ThreadGroupCountX, ThreadGroupCountY, 1);
-
-				// Unbind shader textures
-				SurfaceDisplacementComputeShader->UnbindShaderTextures(RHICmdList);
-
-				// Debug drawing
-				if (DebugTextureRef)
-				{
-					RHICmdList.CopyToResolveTarget(OutputSurfaceDisplacementTexture, DebugTextureRef, FResolveParams());
-				}
-			}
-		);
+		TShaderMapRef<FSurfaceDisplacementComputeShader> SurfaceDisplacementComputeShader(GetGlobalShaderMap(ERHIFeatureLevel::SM5));
+		RHICmdList.SetComputeShader(SurfaceDisplacementComputeShader->GetComputeShader());
+
+		// Bind shader textures
+		SurfaceDisplacementComputeShader->BindShaderTextures(
+			RHICmdList,
+			OutputSurfaceDisplacementTextureUAV,
+			Param.InverseTransformTextureSRVs[0],
+			Param.InverseTransformTextureSRVs[1],
+			Param.InverseTransformTextureSRVs[OCEAN_JACOBIAN_COMPONENT_INDEX],
+			Param.bAnalyticNormals ? Param.InverseTransformTextureSRVs[OCEAN_SLOPE_COMPONENT_INDEX] : FShaderResourceViewRHIRef(),
+			Param.bAnalyticNormals ? Param.NormalTextureUAV : FUnorderedAccessViewRHIRef());
+
+		// Bind shader uniform
+		FSurfaceDisplacementComputeShader::FParameters UniformParam;
+		UniformParam.bAnalyticNormals = Param.bAnalyticNormals ? 1 : 0;
+		UniformParam.NormalStrength = Param.NormalStrength;
+		SurfaceDisplacementComputeShader->SetShaderParameters(RHICmdList, UniformParam);
+
+		// Dispatch shader
+		const int ThreadGroupCountX = StaticCast<int>(Config.TextureWidth / 32);
+		const int ThreadGroupCountY = StaticCast<int>(Config.TextureHeight / 32);
+		DispatchComputeShader(RHICmdList, *SurfaceDisplacementComputeShader, ThreadGroupCountX, ThreadGroupCountY, 1);
+
+		// Unbind shader textures
+		SurfaceDisplacementComputeShader->UnbindShaderTextures(RHICmdList);
+
+		// Debug drawing
+		if (DebugTextureRef)
+		{
+			RHICmdList.CopyToResolveTarget(OutputSurfaceDisplacementTexture, DebugTextureRef, FResolveParams());
+		}
 	}
 }
 
@@ -183,7 +218,10 @@ void FSurfaceDisplacementPass::ConfigurePass(const FSurfaceDisplacementPassConfi
 	uint32 TextureWidth = InConfig.TextureWidth;
 	uint32 TextureHeight = InConfig.TextureHeight;
 
-	OutputSurfaceDisplacementTexture = RHICreateTexture2D(TextureWidth, TextureHeight, PF_FloatRGBA, 1, 1, TexCreate_ShaderResource | TexCreate_UAV, CreateInfo);
+	// Full mip chain, filled in by the mip chain pass once the surface has been rendered
+	uint32 MipCount = FFTOcean::GetMipCount(TextureWidth, TextureHeight);
+
+	OutputSurfaceDisplacementTexture = RHICreateTexture2D(TextureWidth, TextureHeight, PF_FloatRGBA, MipCount, 1, TexCreate_ShaderResource | TexCreate_UAV, CreateInfo);
 	OutputSurfaceDisplacementTextureUAV = RHICreateUnorderedAccessView(OutputSurfaceDisplacementTexture);
 	OutputSurfaceDisplacementTextureSRV = RHICreateShaderResourceView(OutputSurfaceDisplacementTexture, 0);
 }
@@ -12,7 +12,12 @@ struct FSurfaceDisplacementPassConfig
 
 struct FSurfaceDisplacementPassParam
 {
-	FShaderResourceViewRHIRef InverseTransformTextureSRVs[3];
+	FShaderResourceViewRHIRef  InverseTransformTextureSRVs[OCEAN_FOURIER_COMPONENT_COUNT];
+
+	// Analytic normals are built from the slope inverse transform and written straight to the normal texture
+	bool                       bAnalyticNormals;
+	float                      NormalStrength;
+	FUnorderedAccessViewRHIRef NormalTextureUAV;
 };
 
 class FSurfaceDisplacementPass final : public FOceanRenderPass
@@ -25,13 +30,26 @@ public:
 	virtual bool IsValidPass() const override;
 	virtual void ReleaseRenderResource() override;
 
-	void Render(const FSurfaceDisplacementPassConfig& InConfig, const FSurfaceDisplacementPassParam& Param, FRHITexture* DebugTextureRef);
+	void Render(FRHICommandListImmediate& RHICmdList, const FSurfaceDisplacementPassConfig& InConfig, const FSurfaceDisplacementPassParam& Param, FRHITexture* DebugTextureRef);
+
+	// Creates the pass resources ahead of the first render
+	void Prepare(const FSurfaceDisplacementPassConfig& InConfig);
+
+	FORCEINLINE FTexture2DRHIRef GetSurfaceDisplacementTexture() const
+	{
+		return OutputSurfaceDisplacementTexture;
+	}
 
 	FORCEINLINE FShaderResourceViewRHIRef GetSurfaceDisplacementTextureSRV() const
 	{
 		return OutputSurfaceDisplacementTextureSRV;
 	}
 
+	FORCEINLINE FUnorderedAccessViewRHIRef GetSurfaceDisplacementTextureUAV() const
+	{
+		return OutputSurfaceDisplacementTextureUAV;
+	}
+
 private:
 
 	FSurfaceDisplacementPassConfig Config;
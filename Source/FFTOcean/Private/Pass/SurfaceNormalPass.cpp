@@ -125,48 +125,50 @@ void FSurfaceNormalPass::ReleaseRenderResource()
 	SafeReleaseTextureResource(OutputSurfaceNormalTextureUAV);
 }
 
-void FSurfaceNormalPass::Render(const FSurfaceNormalPassConfig& InConfig, const FSurfaceNormalPassParam& Param, FRHITexture* DebugTextureRef)
+void FSurfaceNormalPass::Prepare(const FSurfaceNormalPassConfig& InConfig)
 {
 	if (Config != InConfig)
 	{
 		ConfigurePass(InConfig);
 	}
+}
+
+void FSurfaceNormalPass::Render(FRHICommandListImmediate& RHICmdList, const FSurfaceNormalPassConfig& InConfig, const FSurfaceNormalPassParam& Param, FRHITexture* DebugTextureRef)
+{
+	check(IsInRenderingThread());
+
+	if (Config != InConfig)
+	{
+		ConfigurePass(InConfig);
+	}
 
 	if (IsValidPass())
 	{
-		ENQUEUE_RENDER_COMMAND(SurfaceNormalPassCommand)
-		(
-			[InConfig, Param, DebugTextureRef, this](FRHICommandListImmediate& RHICmdList)
-			{
-				check(IsInRenderingThread());
-
-				// Set up compute shader
-				TShaderMapRef<FSurfaceNormalComputeShader> SurfaceNormalComputeShader(GetGlobalShaderMap(ERHIFeatureLevel::SM5));
-				RHICmdList.SetComputeShader(SurfaceNormalComputeShader->GetComputeShader());
-
-				// Bind shader textures
-				SurfaceNormalComputeShader->BindShaderTextures(RHICmdList, OutputSurfaceNormalTextureUAV, Param.DisplacementTextureSRV);
-
-				// Bind shader uniform
-				FSurfaceNormalComputeShader::FParameters UniformParam;
-				UniformParam.NormalStrength = Param.NormalStrength;
-				SurfaceNormalComputeShader->SetShaderParameters(RHICmdList, UniformParam);
-
-				// Dispatch shader
-				const int ThreadGroupCountX = StaticCast<int>(Config.TextureWidth / 32);
-				const int ThreadGroupCountY = StaticCast<int>(Config.TextureHeight / 32);
-				DispatchComputeShader(RHICmdList, *SurfaceNormalComputeShader, ThreadGroupCountX, ThreadGroupCountY, 1);
-
-				// Unbind shader textures
-				SurfaceNormalComputeShader->UnbindShaderTextures(RHICmdList);
-
-				// Debug drawing
-				if (DebugTextureRef)
-				{
-					RHICmdList.CopyToResolveTarget(OutputSurfaceNormalTexture, DebugTextureRef, FResolveParams());
-				}
-			}
-		);
+		// Set up compute shader
+		TShaderMapRef<FSurfaceNormalComputeShader> SurfaceNormalComputeShader(GetGlobalShaderMap(ERHIFeatureLevel::SM5));
+		RHICmdList.SetComputeShader(SurfaceNormalComputeShader->GetComputeShader());
+
+		// Bind shader textures
+		SurfaceNormalComputeShader->BindShaderTextures(RHICmdList, OutputSurfaceNormalTextureUAV, Param.DisplacementTextureSRV);
+
+		// Bind shader uniform
+		FSurfaceNormalComputeShader::FParameters UniformParam;
+		UniformParam.NormalStrength = Param.NormalStrength;
+		SurfaceNormalComputeShader->SetShaderParameters(RHICmdList, UniformParam);
+
+		// Dispatch shader
+		const int ThreadGroupCountX = StaticCast<int>(Config.TextureWidth / 32);
+		const int ThreadGroupCountY = StaticCast<int>(Config.TextureHeight / 32);
+		DispatchComputeShader(RHICmdList, *SurfaceNormalComputeShader, ThreadGroupCountX, ThreadGroupCountY, 1);
+
+		// Unbind shader textures
+		SurfaceNormalComputeShader->UnbindShaderTextures(RHICmdList);
+
+		// Debug drawing
+		if (DebugTextureRef)
+		{
+			RHICmdList.CopyToResolveTarget(OutputSurfaceNormalTexture, DebugTextureRef, FResolveParams());
+		}
 	}
 }
 
@@ -181,7 +183,10 @@ void FSurfaceNormalPass::ConfigurePass(const FSurfaceNormalPassConfig& InConfig)
 	uint32 TextureWidth = InConfig.TextureWidth;
 	uint32 TextureHeight = InConfig.TextureHeight;
 
-	OutputSurfaceNormalTexture = RHICreateTexture2D(TextureWidth, TextureHeight, PF_FloatRGBA, 1, 1, TexCreate_ShaderResource | TexCreate_UAV, CreateInfo);
+	// Full mip chain, filled in by the mip chain pass once the surface has been rendered
+	uint32 MipCount = FFTOcean::GetMipCount(TextureWidth, TextureHeight);
+
+	OutputSurfaceNormalTexture = RHICreateTexture2D(TextureWidth, TextureHeight, PF_FloatRGBA, MipCount, 1, TexCreate_ShaderResource | TexCreate_UAV, CreateInfo);
 	OutputSurfaceNormalTextureUAV = RHICreateUnorderedAccessView(OutputSurfaceNormalTexture);
 	OutputSurfaceNormalTextureSRV = RHICreateShaderResourceView(OutputSurfaceNormalTexture, 0);
 }
@@ -26,7 +26,25 @@ public:
 	virtual bool IsValidPass() const override;
 	virtual void ReleaseRenderResource() override;
 
-	void Render(const FSurfaceNormalPassConfig& InConfig, const FSurfaceNormalPassParam& Param, FRHITexture* DebugTextureRef);
+	void Render(FRHICommandListImmediate& RHICmdList, const FSurfaceNormalPassConfig& InConfig, const FSurfaceNormalPassParam& Param, FRHITexture* DebugTextureRef);
+
+	// Only creates the output texture, for when another pass writes the normals
+	void Prepare(const FSurfaceNormalPassConfig& InConfig);
+
+	FORCEINLINE FUnorderedAccessViewRHIRef GetSurfaceNormalTextureUAV() const
+	{
+		return OutputSurfaceNormalTextureUAV;
+	}
+
+	FORCEINLINE FTexture2DRHIRef GetSurfaceNormalTexture() const
+	{
+		return OutputSurfaceNormalTexture;
+	}
+
+	FORCEINLINE FShaderResourceViewRHIRef GetSurfaceNormalTextureSRV() const
+	{
+		return OutputSurfaceNormalTextureSRV;
+	}
 
 private:
 
@@ -0,0 +1,214 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "Pass/SurfaceReadbackPass.h"
+#include "OceanSnapshotPublisher.h"
+#include "RenderCore/Public/GlobalShader.h"
+#include "RenderCore/Public/ShaderParameterUtils.h"
+#include "RenderCore/Public/ShaderParameterMacros.h"
+
+#include "Public/GlobalShader.h"
+#include "Public/PipelineStateCache.h"
+#include "Public/RHIStaticStates.h"
+#include "Public/SceneUtils.h"
+#include "Public/SceneInterface.h"
+#include "Public/ShaderParameterUtils.h"
+#include "Public/Logging/MessageLog.h"
+#include "Public/Internationalization/Internationalization.h"
+#include "Public/StaticBoundShaderState.h"
+#include "RHI/Public/RHICommandList.h"
+
+#include "Classes/Engine/World.h"
+#include "Engine/Classes/Kismet/KismetRenderingLibrary.h"
+
+#include "Math/UnrealMathUtility.h"
+
+class FSurfaceReadbackComputeShader : public FGlobalShader
+{
+	DECLARE_SHADER_TYPE(FSurfaceReadbackComputeShader, Global);
+
+public:
+
+	FSurfaceReadbackComputeShader() {}
+	FSurfaceReadbackComputeShader(const ShaderMetaType::CompiledShaderInitializerType& Initializer) :
+		FGlobalShader(Initializer)
+	{
+		OutputDisplacementBuffer.Bind(Initializer.ParameterMap, TEXT("OutputDisplacementBuffer"));
+		InputDisplacementTexture.Bind(Initializer.ParameterMap, TEXT("InputDisplacementTexture"));
+	}
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+
+	virtual bool Serialize(FArchive& Ar) override
+	{
+		bool bShaderHasOutdatedParameters = FGlobalShader::Serialize(Ar);
+
+		Ar << OutputDisplacementBuffer;
+		Ar << InputDisplacementTexture;
+
+		return bShaderHasOutdatedParameters;
+	}
+
+	void BindShaderTextures(FRHICommandList& RHICmdList, FUnorderedAccessViewRHIRef OutputBufferUAV, FShaderResourceViewRHIRef InputTextureSRV)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputDisplacementBuffer, OutputBufferUAV);
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputDisplacementTexture, InputTextureSRV);
+	}
+
+	void UnbindShaderTextures(FRHICommandList& RHICmdList)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputDisplacementBuffer, FUnorderedAccessViewRHIRef());
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputDisplacementTexture, FShaderResourceViewRHIRef());
+	}
+
+private:
+
+	FShaderResourceParameter OutputDisplacementBuffer;
+	FShaderResourceParameter InputDisplacementTexture;
+};
+
+IMPLEMENT_SHADER_TYPE(, FSurfaceReadbackComputeShader, TEXT("/Plugin/FFTOcean/SurfaceReadbackComputeShader.usf"), TEXT("ComputeSurfaceReadback"), SF_Compute)
+
+inline bool operator==(const FSurfaceReadbackPassConfig& A, const FSurfaceReadbackPassConfig& B)
+{
+	return FMemory::Memcmp(&A, &B, sizeof(FSurfaceReadbackPassConfig)) == 0;
+}
+
+inline bool operator!=(const FSurfaceReadbackPassConfig& A, const FSurfaceReadbackPassConfig& B)
+{
+	return !(A == B);
+}
+
+FSurfaceReadbackPass::FSurfaceReadbackPass() :
+	ReadbackWriteIndex(0)
+{
+	FMemory::Memzero(Config);
+
+	for (int32 Index = 0; Index < ReadbackCount; ++Index)
+	{
+		Readbacks[Index].Reset(new FRHIGPUBufferReadback(TEXT("SurfaceReadback")));
+		bReadbackPending[Index] = false;
+		ReadbackTimestamps[Index] = 0;
+	}
+}
+
+FSurfaceReadbackPass::~FSurfaceReadbackPass()
+{
+	ReleaseRenderResource();
+}
+
+bool FSurfaceReadbackPass::IsValidPass() const
+{
+	bool bValid = !!DisplacementBuffer;
+	bValid &= !!DisplacementBufferUAV;
+
+	return bValid;
+}
+
+void FSurfaceReadbackPass::ReleaseRenderResource()
+{
+	SafeReleaseTextureResource(DisplacementBuffer);
+	SafeReleaseTextureResource(DisplacementBufferUAV);
+}
+
+void FSurfaceReadbackPass::ConfigurePass(const FSurfaceReadbackPassConfig& InConfig)
+{
+	// Always release current resource before creating new render resources
+	ReleaseRenderResource();
+
+	Config = InConfig;
+
+	// Copies of the previous size are useless now
+	for (int32 Index = 0; Index < ReadbackCount; ++Index)
+	{
+		bReadbackPending[Index] = false;
+	}
+
+	FRHIResourceCreateInfo CreateInfo;
+
+	DisplacementBuffer = RHICreateVertexBuffer(sizeof(FFloat16Color) * InConfig.TextureWidth * InConfig.TextureHeight, BUF_UnorderedAccess | BUF_ShaderResource, CreateInfo);
+	DisplacementBufferUAV = RHICreateUnorderedAccessView(DisplacementBuffer, PF_FloatRGBA);
+}
+
+void FSurfaceReadbackPass::Render(FRHICommandListImmediate& RHICmdList, const FSurfaceReadbackPassConfig& InConfig, const FSurfaceReadbackPassParam& Param)
+{
+	check(IsInRenderingThread());
+
+	if (Config != InConfig)
+	{
+		ConfigurePass(InConfig);
+	}
+
+	if (IsValidPass())
+	{
+		// Pick up whatever the GPU has finished first, so a free slot is available for this frame
+		ResolveReadbacks(Param.SnapshotPublisher);
+
+		if (bReadbackPending[ReadbackWriteIndex])
+		{
+			return;
+		}
+
+		// Set up compute shader
+		TShaderMapRef<FSurfaceReadbackComputeShader> SurfaceReadbackComputeShader(GetGlobalShaderMap(ERHIFeatureLevel::SM5));
+		RHICmdList.SetComputeShader(SurfaceReadbackComputeShader->GetComputeShader());
+
+		// Bind shader textures
+		SurfaceReadbackComputeShader->BindShaderTextures(RHICmdList, DisplacementBufferUAV, Param.DisplacementTextureSRV);
+
+		// Dispatch shader
+		const int ThreadGroupCountX = StaticCast<int>(Config.TextureWidth / 32);
+		const int ThreadGroupCountY = StaticCast<int>(Config.TextureHeight / 32);
+		DispatchComputeShader(RHICmdList, *SurfaceReadbackComputeShader, ThreadGroupCountX, ThreadGroupCountY, 1);
+
+		// Unbind shader textures
+		SurfaceReadbackComputeShader->UnbindShaderTextures(RHICmdList);
+
+		Readbacks[ReadbackWriteIndex]->EnqueueCopy(RHICmdList, DisplacementBuffer, sizeof(FFloat16Color) * Config.TextureWidth * Config.TextureHeight);
+		bReadbackPending[ReadbackWriteIndex] = true;
+		ReadbackTimestamps[ReadbackWriteIndex] = Param.Timestamp;
+		ReadbackWriteIndex = (ReadbackWriteIndex + 1) % ReadbackCount;
+	}
+}
+
+void FSurfaceReadbackPass::ResolveReadbacks(FOceanSnapshotPublisher* SnapshotPublisher)
+{
+	// Only the newest finished copy is worth converting, older ones are released unread
+	int32 NewestIndex = INDEX_NONE;
+
+	for (int32 Offset = 0; Offset < ReadbackCount; ++Offset)
+	{
+		const int32 Index = (ReadbackWriteIndex + Offset) % ReadbackCount;
+
+		if (bReadbackPending[Index] && Readbacks[Index]->IsReady())
+		{
+			if (NewestIndex != INDEX_NONE)
+			{
+				bReadbackPending[NewestIndex] = false;
+			}
+
+			NewestIndex = Index;
+		}
+	}
+
+	if (NewestIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	const int32 TexelCount = StaticCast<int32>(Config.TextureWidth * Config.TextureHeight);
+	const uint32 Size = sizeof(FFloat16Color) * TexelCount;
+	const FFloat16Color* Texels = StaticCast<const FFloat16Color*>(Readbacks[NewestIndex]->Lock(Size));
+
+	if (SnapshotPublisher)
+	{
+		SnapshotPublisher->Publish(FOceanSurfaceSnapshot::FromHalfTexels(Config.TextureWidth, Config.TextureHeight, ReadbackTimestamps[NewestIndex], MakeArrayView(Texels, TexelCount)));
+	}
+
+	Readbacks[NewestIndex]->Unlock();
+	bReadbackPending[NewestIndex] = false;
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Pass/PassUtil.h"
+#include "RHI/Public/RHIGPUReadback.h"
+
+class FOceanSnapshotPublisher;
+
+struct FSurfaceReadbackPassConfig
+{
+	uint32 TextureWidth;
+	uint32 TextureHeight;
+};
+
+struct FSurfaceReadbackPassParam
+{
+	FShaderResourceViewRHIRef DisplacementTextureSRV;
+
+	// Simulation time of the displacement, carried by the snapshot it ends up in
+	float Timestamp;
+
+	// Receives every snapshot once the GPU has finished copying it
+	FOceanSnapshotPublisher* SnapshotPublisher;
+};
+
+// Copies the displacement map back to the CPU a few frames late and publishes it as a surface snapshot
+class FSurfaceReadbackPass final : public FOceanRenderPass
+{
+public:
+
+	FSurfaceReadbackPass();
+	~FSurfaceReadbackPass();
+
+	virtual bool IsValidPass() const override;
+	virtual void ReleaseRenderResource() override;
+
+	void Render(FRHICommandListImmediate& RHICmdList, const FSurfaceReadbackPassConfig& InConfig, const FSurfaceReadbackPassParam& Param);
+
+private:
+
+	static constexpr int32 ReadbackCount = 3;
+
+	FSurfaceReadbackPassConfig Config;
+
+	FVertexBufferRHIRef        DisplacementBuffer;
+	FUnorderedAccessViewRHIRef DisplacementBufferUAV;
+
+	// Ring of readbacks so the render thread never waits for the GPU to finish a frame
+	TUniquePtr<FRHIGPUBufferReadback> Readbacks[ReadbackCount];
+	bool                              bReadbackPending[ReadbackCount];
+	float                             ReadbackTimestamps[ReadbackCount];
+	int32                             ReadbackWriteIndex;
+
+	void ConfigurePass(const FSurfaceReadbackPassConfig& InConfig);
+
+	void ResolveReadbacks(FOceanSnapshotPublisher* SnapshotPublisher);
+};
\ No newline at end of file
@@ -165,8 +165,15 @@ void FTwiddleFactorsPass::ConfigurePass(const FTwiddleFactorsPassConfig& InConfi
 	OutputTwiddleFactorsTextureSRV = RHICreateShaderResourceView(OutputTwiddleFactorsTexture, 0);
 }
 
-void FTwiddleFactorsPass::Render(const FTwiddleFactorsPassConfig& InConfig, const FTwiddleFactorsPassParam& Param, FRHITexture* DebugTextureRef)
+void FTwiddleFactorsPass::Prepare(FRHICommandListImmediate& RHICmdList, const FTwiddleFactorsPassConfig& InConfig)
 {
+	Render(RHICmdList, InConfig, FTwiddleFactorsPassParam(), nullptr);
+}
+
+void FTwiddleFactorsPass::Render(FRHICommandListImmediate& RHICmdList, const FTwiddleFactorsPassConfig& InConfig, const FTwiddleFactorsPassParam& Param, FRHITexture* DebugTextureRef)
+{
+	check(IsInRenderingThread());
+
 	// We only need to render twiddle factors pass once as long as the texture dimensions remain unchanged
 	if (Config != InConfig)
 	{
@@ -174,63 +181,55 @@ void FTwiddleFactorsPass::Render(const FTwiddleFactorsPassConfig& InConfig, cons
 	
 		if (IsValidPass())
 		{
-			ENQUEUE_RENDER_COMMAND(TwiddleFactorsPassCommand)
-			(
-				[Param, DebugTextureRef, this](FRHICommandListImmediate& RHICmdList)
-				{
-					check(IsInRenderingThread());
-
-					// Init indices buffer
-					const int N = Config.TextureHeight;
-					TResourceArray<uint32> IndicesArray;
-					IndicesArray.AddUninitialized(N);
-
-					const uint32 Bits = StaticCast<uint32>(FMath::Log2(N));
-
-					for (int32 Index = 0; Index < N; ++Index)
-					{
-						IndicesArray[Index] = ReverseBits(Index, Bits);
-					}
-
-					FRHIResourceCreateInfo CreateInfo(&IndicesArray);
-					FStructuredBufferRHIRef IndicesBufferRef = RHICreateStructuredBuffer(
-						sizeof(uint32),                           // Stride
-						sizeof(uint32) * N,                       // Size
-						BUF_UnorderedAccess | BUF_ShaderResource, // Usage
-						CreateInfo                                // Create info
-					);
-					FUnorderedAccessViewRHIRef IndicesBufferUAVRef = RHICreateUnorderedAccessView(IndicesBufferRef, true, false);
-
-					// Set up compute shader
-					TShaderMapRef<FTwiddleFactorsComputeShader> TwiddleFactorsComputeShader(GetGlobalShaderMap(ERHIFeatureLevel::SM5));
-					RHICmdList.SetComputeShader(TwiddleFactorsComputeShader->GetComputeShader());
-
-					// Bind shader textures
-					TwiddleFactorsComputeShader->BindShaderTextures(RHICmdList, OutputTwiddleFactorsTextureUAV, IndicesBufferUAVRef);
-
-					// Bind shader uniform
-					FTwiddleFactorsComputeShader::FParameters UniformParam;
-					TwiddleFactorsComputeShader->SetShaderParameters(RHICmdList, UniformParam);
-
-					// Dispatch shader
-					const int ThreadGroupCountX = StaticCast<int>(FMath::Log2(Config.TextureHeight));
-					const int ThreadGroupCountY = StaticCast<int>(Config.TextureHeight / 16);
-					DispatchComputeShader(RHICmdList, *TwiddleFactorsComputeShader, ThreadGroupCountX, ThreadGroupCountY, 1);
-
-					// Unbind shader textures
-					TwiddleFactorsComputeShader->UnbindShaderTextures(RHICmdList);
-
-					// Debug drawing
-					if (DebugTextureRef)
-					{
-						RHICmdList.CopyToResolveTarget(OutputTwiddleFactorsTexture, DebugTextureRef, FResolveParams());
-					}
-
-					// Release structured buffer
-					SafeReleaseTextureResource(IndicesBufferUAVRef);
-					SafeReleaseTextureResource(IndicesBufferRef);
-				}
+			// Init indices buffer
+			const int N = Config.TextureHeight;
+			TResourceArray<uint32> IndicesArray;
+			IndicesArray.AddUninitialized(N);
+
+			const uint32 Bits = StaticCast<uint32>(FMath::Log2(N));
+
+			for (int32 Index = 0; Index < N; ++Index)
+			{
+				IndicesArray[Index] = ReverseBits(Index, Bits);
+			}
+
+			FRHIResourceCreateInfo CreateInfo(&IndicesArray);
+			FStructuredBufferRHIRef IndicesBufferRef = RHICreateStructuredBuffer(
+				sizeof(uint32),                           // Stride
+				sizeof(uint32) * N,                       // Size
+				BUF_UnorderedAccess | BUF_ShaderResource, // Usage
+				CreateInfo                                // Create info
 			);
+			FUnorderedAccessViewRHIRef IndicesBufferUAVRef = RHICreateUnorderedAccessView(IndicesBufferRef, true, false);
+
+			// Set up compute shader
+			TShaderMapRef<FTwiddleFactorsComputeShader> TwiddleFactorsComputeShader(GetGlobalShaderMap(ERHIFeatureLevel::SM5));
+			RHICmdList.SetComputeShader(TwiddleFactorsComputeShader->GetComputeShader());
+
+			// Bind shader textures
+			TwiddleFactorsComputeShader->BindShaderTextures(RHICmdList, OutputTwiddleFactorsTextureUAV, IndicesBufferUAVRef);
+
+			// Bind shader uniform
+			FTwiddleFactorsComputeShader::FParameters UniformParam;
+			TwiddleFactorsComputeShader->SetShaderParameters(RHICmdList, UniformParam);
+
+			// Dispatch shader
+			const int ThreadGroupCountX = StaticCast<int>(FMath::Log2(Config.TextureHeight));
+			const int ThreadGroupCountY = StaticCast<int>(Config.TextureHeight / 16);
+			DispatchComputeShader(RHICmdList, *TwiddleFactorsComputeShader, ThreadGroupCountX, ThreadGroupCountY, 1);
+
+			// Unbind shader textures
+			TwiddleFactorsComputeShader->UnbindShaderTextures(RHICmdList);
+
+			// Debug drawing
+			if (DebugTextureRef)
+			{
+				RHICmdList.CopyToResolveTarget(OutputTwiddleFactorsTexture, DebugTextureRef, FResolveParams());
+			}
+
+			// Release structured buffer
+			SafeReleaseTextureResource(IndicesBufferUAVRef);
+			SafeReleaseTextureResource(IndicesBufferRef);
 		}
 	}
 }
@@ -24,7 +24,10 @@ public:
 	virtual bool IsValidPass() const override;
 	virtual void ReleaseRenderResource() override;
 
-	void Render(const FTwiddleFactorsPassConfig& InConfig, const FTwiddleFactorsPassParam& Param, FRHITexture* DebugTextureRef);
+	void Render(FRHICommandListImmediate& RHICmdList, const FTwiddleFactorsPassConfig& InConfig, const FTwiddleFactorsPassParam& Param, FRHITexture* DebugTextureRef);
+
+	// Creates the texture and builds the table ahead of the first render
+	void Prepare(FRHICommandListImmediate& RHICmdList, const FTwiddleFactorsPassConfig& InConfig);
 
 	FORCEINLINE FShaderResourceViewRHIRef GetTwiddleFactorsTextureSRV() const
 	{
@@ -0,0 +1,299 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#include "Pass/WaveStatisticsPass.h"
+#include "RenderCore/Public/GlobalShader.h"
+#include "RenderCore/Public/ShaderParameterUtils.h"
+#include "RenderCore/Public/ShaderParameterMacros.h"
+
+#include "Public/GlobalShader.h"
+#include "Public/PipelineStateCache.h"
+#include "Public/RHIStaticStates.h"
+#include "Public/SceneUtils.h"
+#include "Public/SceneInterface.h"
+#include "Public/ShaderParameterUtils.h"
+#include "Public/Logging/MessageLog.h"
+#include "Public/Internationalization/Internationalization.h"
+#include "Public/StaticBoundShaderState.h"
+#include "RHI/Public/RHICommandList.h"
+
+#include "Classes/Engine/World.h"
+#include "Engine/Classes/Kismet/KismetRenderingLibrary.h"
+
+#include "Math/UnrealMathUtility.h"
+
+BEGIN_GLOBAL_SHADER_PARAMETER_STRUCT(FWaveStatisticsComputeShaderParameters, )
+	SHADER_PARAMETER(uint32, PartialCount)
+	SHADER_PARAMETER(float,  TexelCount)
+END_GLOBAL_SHADER_PARAMETER_STRUCT()
+IMPLEMENT_GLOBAL_SHADER_PARAMETER_STRUCT(FWaveStatisticsComputeShaderParameters, "WaveStatisticsUniform");
+
+class FWaveStatisticsPartialsComputeShader : public FGlobalShader
+{
+	DECLARE_SHADER_TYPE(FWaveStatisticsPartialsComputeShader, Global);
+
+public:
+
+	FWaveStatisticsPartialsComputeShader() {}
+	FWaveStatisticsPartialsComputeShader(const ShaderMetaType::CompiledShaderInitializerType& Initializer) :
+		FGlobalShader(Initializer)
+	{
+		OutputPartialsBuffer.Bind(Initializer.ParameterMap, TEXT("OutputPartialsBuffer"));
+		InputDisplacementTexture.Bind(Initializer.ParameterMap, TEXT("InputDisplacementTexture"));
+	}
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+
+	virtual bool Serialize(FArchive& Ar) override
+	{
+		bool bShaderHasOutdatedParameters = FGlobalShader::Serialize(Ar);
+
+		Ar << OutputPartialsBuffer;
+		Ar << InputDisplacementTexture;
+
+		return bShaderHasOutdatedParameters;
+	}
+
+	void BindShaderTextures(FRHICommandList& RHICmdList, FUnorderedAccessViewRHIRef OutputBufferUAV, FShaderResourceViewRHIRef InputTextureSRV)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputPartialsBuffer, OutputBufferUAV);
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputDisplacementTexture, InputTextureSRV);
+	}
+
+	void UnbindShaderTextures(FRHICommandList& RHICmdList)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputPartialsBuffer, FUnorderedAccessViewRHIRef());
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputDisplacementTexture, FShaderResourceViewRHIRef());
+	}
+
+private:
+
+	FShaderResourceParameter OutputPartialsBuffer;
+	FShaderResourceParameter InputDisplacementTexture;
+};
+
+class FWaveStatisticsFinalComputeShader : public FGlobalShader
+{
+	DECLARE_SHADER_TYPE(FWaveStatisticsFinalComputeShader, Global);
+	using FParameters = FWaveStatisticsComputeShaderParameters;
+
+public:
+
+	FWaveStatisticsFinalComputeShader() {}
+	FWaveStatisticsFinalComputeShader(const ShaderMetaType::CompiledShaderInitializerType& Initializer) :
+		FGlobalShader(Initializer)
+	{
+		OutputStatisticsBuffer.Bind(Initializer.ParameterMap, TEXT("OutputStatisticsBuffer"));
+		InputPartialsBuffer.Bind(Initializer.ParameterMap, TEXT("InputPartialsBuffer"));
+	}
+
+	static bool ShouldCompilePermutation(const FGlobalShaderPermutationParameters& Parameters)
+	{
+		return IsFeatureLevelSupported(Parameters.Platform, ERHIFeatureLevel::SM5);
+	}
+
+	virtual bool Serialize(FArchive& Ar) override
+	{
+		bool bShaderHasOutdatedParameters = FGlobalShader::Serialize(Ar);
+
+		Ar << OutputStatisticsBuffer;
+		Ar << InputPartialsBuffer;
+
+		return bShaderHasOutdatedParameters;
+	}
+
+	void BindShaderTextures(FRHICommandList& RHICmdList, FUnorderedAccessViewRHIRef OutputBufferUAV, FShaderResourceViewRHIRef InputBufferSRV)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputStatisticsBuffer, OutputBufferUAV);
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputPartialsBuffer, InputBufferSRV);
+	}
+
+	void UnbindShaderTextures(FRHICommandList& RHICmdList)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetUAVParameter(RHICmdList, ComputeShaderRHI, OutputStatisticsBuffer, FUnorderedAccessViewRHIRef());
+		SetSRVParameter(RHICmdList, ComputeShaderRHI, InputPartialsBuffer, FShaderResourceViewRHIRef());
+	}
+
+	void SetShaderParameters(FRHICommandList& RHICmdList, const FParameters& Parameters)
+	{
+		FRHIComputeShader* ComputeShaderRHI = GetComputeShader();
+		SetUniformBufferParameterImmediate(RHICmdList, ComputeShaderRHI, GetUniformBufferParameter<FParameters>(), Parameters);
+	}
+
+private:
+
+	FShaderResourceParameter OutputStatisticsBuffer;
+	FShaderResourceParameter InputPartialsBuffer;
+};
+
+IMPLEMENT_SHADER_TYPE(, FWaveStatisticsPartialsComputeShader, TEXT("/Plugin/FFTOcean/WaveStatisticsComputeShader.usf"), TEXT("ComputeWaveStatisticsPartials"), SF_Compute)
+IMPLEMENT_SHADER_TYPE(, FWaveStatisticsFinalComputeShader, TEXT("/Plugin/FFTOcean/WaveStatisticsComputeShader.usf"), TEXT("ComputeWaveStatisticsFinal"), SF_Compute)
+
+inline bool operator==(const FWaveStatisticsPassConfig& A, const FWaveStatisticsPassConfig& B)
+{
+	return FMemory::Memcmp(&A, &B, sizeof(FWaveStatisticsPassConfig)) == 0;
+}
+
+inline bool operator!=(const FWaveStatisticsPassConfig& A, const FWaveStatisticsPassConfig& B)
+{
+	return !(A == B);
+}
+
+namespace
+{
+	// Every 32x32 tile writes two float4 partials: max |D| with an unused w, then the height sum and squared height sum
+	constexpr uint32 StatisticsTileSize = 32;
+	constexpr uint32 PartialStride = sizeof(FVector4) * 2;
+	constexpr uint32 StatisticsSize = sizeof(FVector4) * 2;
+}
+
+FWaveStatisticsPass::FWaveStatisticsPass() :
+	ReadbackWriteIndex(0)
+{
+	FMemory::Memzero(Config);
+	FMemory::Memzero(Result);
+
+	for (int32 Index = 0; Index < ReadbackCount; ++Index)
+	{
+		Readbacks[Index].Reset(new FRHIGPUBufferReadback(TEXT("WaveStatisticsReadback")));
+		bReadbackPending[Index] = false;
+	}
+}
+
+FWaveStatisticsPass::~FWaveStatisticsPass()
+{
+	ReleaseRenderResource();
+}
+
+bool FWaveStatisticsPass::IsValidPass() const
+{
+	bool bValid = !!PartialsBuffer;
+	bValid &= !!PartialsBufferUAV;
+	bValid &= !!PartialsBufferSRV;
+	bValid &= !!StatisticsBuffer;
+	bValid &= !!StatisticsBufferUAV;
+
+	return bValid;
+}
+
+void FWaveStatisticsPass::ReleaseRenderResource()
+{
+	SafeReleaseTextureResource(PartialsBuffer);
+	SafeReleaseTextureResource(PartialsBufferUAV);
+	SafeReleaseTextureResource(PartialsBufferSRV);
+	SafeReleaseTextureResource(StatisticsBuffer);
+	SafeReleaseTextureResource(StatisticsBufferUAV);
+}
+
+FWaveStatisticsPassResult FWaveStatisticsPass::GetResult() const
+{
+	FScopeLock Lock(&ResultLock);
+	return Result;
+}
+
+void FWaveStatisticsPass::ConfigurePass(const FWaveStatisticsPassConfig& InConfig)
+{
+	// Always release current resource before creating new render resources
+	ReleaseRenderResource();
+
+	Config = InConfig;
+
+	const uint32 PartialCount = (InConfig.TextureWidth / StatisticsTileSize) * (InConfig.TextureHeight / StatisticsTileSize);
+
+	FRHIResourceCreateInfo CreateInfo;
+
+	PartialsBuffer = RHICreateVertexBuffer(PartialStride * PartialCount, BUF_UnorderedAccess | BUF_ShaderResource, CreateInfo);
+	PartialsBufferUAV = RHICreateUnorderedAccessView(PartialsBuffer, PF_A32B32G32R32F);
+	PartialsBufferSRV = RHICreateShaderResourceView(PartialsBuffer, sizeof(FVector4), PF_A32B32G32R32F);
+
+	StatisticsBuffer = RHICreateVertexBuffer(StatisticsSize, BUF_UnorderedAccess | BUF_ShaderResource, CreateInfo);
+	StatisticsBufferUAV = RHICreateUnorderedAccessView(StatisticsBuffer, PF_A32B32G32R32F);
+}
+
+void FWaveStatisticsPass::Prepare(const FWaveStatisticsPassConfig& InConfig)
+{
+	if (Config != InConfig)
+	{
+		ConfigurePass(InConfig);
+	}
+}
+
+void FWaveStatisticsPass::Render(FRHICommandListImmediate& RHICmdList, const FWaveStatisticsPassConfig& InConfig, const FWaveStatisticsPassParam& Param)
+{
+	check(IsInRenderingThread());
+
+	if (Config != InConfig)
+	{
+		ConfigurePass(InConfig);
+	}
+
+	if (IsValidPass())
+	{
+		const uint32 ThreadGroupCountX = Config.TextureWidth / StatisticsTileSize;
+		const uint32 ThreadGroupCountY = Config.TextureHeight / StatisticsTileSize;
+
+		// Reduce every tile to a partial
+		TShaderMapRef<FWaveStatisticsPartialsComputeShader> PartialsComputeShader(GetGlobalShaderMap(ERHIFeatureLevel::SM5));
+		RHICmdList.SetComputeShader(PartialsComputeShader->GetComputeShader());
+		PartialsComputeShader->BindShaderTextures(RHICmdList, PartialsBufferUAV, Param.DisplacementTextureSRV);
+		DispatchComputeShader(RHICmdList, *PartialsComputeShader, ThreadGroupCountX, ThreadGroupCountY, 1);
+		PartialsComputeShader->UnbindShaderTextures(RHICmdList);
+
+		// Fold the partials into the final statistics
+		TShaderMapRef<FWaveStatisticsFinalComputeShader> FinalComputeShader(GetGlobalShaderMap(ERHIFeatureLevel::SM5));
+		RHICmdList.SetComputeShader(FinalComputeShader->GetComputeShader());
+		FinalComputeShader->BindShaderTextures(RHICmdList, StatisticsBufferUAV, PartialsBufferSRV);
+
+		FWaveStatisticsFinalComputeShader::FParameters UniformParam;
+		UniformParam.PartialCount = ThreadGroupCountX * ThreadGroupCountY;
+		UniformParam.TexelCount = StaticCast<float>(Config.TextureWidth * Config.TextureHeight);
+		FinalComputeShader->SetShaderParameters(RHICmdList, UniformParam);
+
+		DispatchComputeShader(RHICmdList, *FinalComputeShader, 1, 1, 1);
+		FinalComputeShader->UnbindShaderTextures(RHICmdList);
+
+		// Pick up whatever the GPU has finished, then queue this frame's copy if a slot is free
+		ResolveReadbacks();
+
+		if (!bReadbackPending[ReadbackWriteIndex])
+		{
+			Readbacks[ReadbackWriteIndex]->EnqueueCopy(RHICmdList, StatisticsBuffer, StatisticsSize);
+			bReadbackPending[ReadbackWriteIndex] = true;
+			ReadbackWriteIndex = (ReadbackWriteIndex + 1) % ReadbackCount;
+		}
+	}
+}
+
+void FWaveStatisticsPass::ResolveReadbacks()
+{
+	// Walk from the oldest request so the newest ready result wins
+	for (int32 Offset = 0; Offset < ReadbackCount; ++Offset)
+	{
+		const int32 Index = (ReadbackWriteIndex + Offset) % ReadbackCount;
+
+		if (!bReadbackPending[Index] || !Readbacks[Index]->IsReady())
+		{
+			continue;
+		}
+
+		const FVector4* Statistics = StaticCast<const FVector4*>(Readbacks[Index]->Lock(StatisticsSize));
+
+		FWaveStatisticsPassResult NewResult;
+		NewResult.bValid = true;
+		NewResult.MaxDisplacement = FVector(Statistics[0]);
+		NewResult.MeanHeight = Statistics[0].W;
+		NewResult.SignificantWaveHeight = Statistics[1].X;
+
+		Readbacks[Index]->Unlock();
+		bReadbackPending[Index] = false;
+
+		FScopeLock Lock(&ResultLock);
+		Result = NewResult;
+	}
+}
@@ -0,0 +1,69 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "Pass/PassUtil.h"
+#include "RHI/Public/RHIGPUReadback.h"
+
+struct FWaveStatisticsPassConfig
+{
+	uint32 TextureWidth;
+	uint32 TextureHeight;
+};
+
+struct FWaveStatisticsPassParam
+{
+	FShaderResourceViewRHIRef DisplacementTextureSRV;
+};
+
+struct FWaveStatisticsPassResult
+{
+	bool    bValid;
+	FVector MaxDisplacement;
+	float   MeanHeight;
+	float   SignificantWaveHeight;
+};
+
+class FWaveStatisticsPass final : public FOceanRenderPass
+{
+public:
+
+	FWaveStatisticsPass();
+	~FWaveStatisticsPass();
+
+	virtual bool IsValidPass() const override;
+	virtual void ReleaseRenderResource() override;
+
+	void Render(FRHICommandListImmediate& RHICmdList, const FWaveStatisticsPassConfig& InConfig, const FWaveStatisticsPassParam& Param);
+
+	// Creates the pass resources ahead of the first render
+	void Prepare(const FWaveStatisticsPassConfig& InConfig);
+
+	// Latest statistics read back from the GPU. Lags the simulation by a few frames, safe to call from any thread.
+	FWaveStatisticsPassResult GetResult() const;
+
+private:
+
+	static constexpr int32 ReadbackCount = 3;
+
+	FWaveStatisticsPassConfig Config;
+
+	FVertexBufferRHIRef        PartialsBuffer;
+	FUnorderedAccessViewRHIRef PartialsBufferUAV;
+	FShaderResourceViewRHIRef  PartialsBufferSRV;
+
+	FVertexBufferRHIRef        StatisticsBuffer;
+	FUnorderedAccessViewRHIRef StatisticsBufferUAV;
+
+	// Ring of readbacks so the render thread never waits for the GPU to finish a frame
+	TUniquePtr<FRHIGPUBufferReadback> Readbacks[ReadbackCount];
+	bool                              bReadbackPending[ReadbackCount];
+	int32                             ReadbackWriteIndex;
+
+	mutable FCriticalSection  ResultLock;
+	FWaveStatisticsPassResult Result;
+
+	void ConfigurePass(const FWaveStatisticsPassConfig& InConfig);
+
+	void ResolveReadbacks();
+};
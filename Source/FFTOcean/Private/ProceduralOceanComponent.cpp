@@ -3,12 +3,104 @@
 
 #include "ProceduralOceanComponent.h"
 #include "Kismet/GameplayStatics.h"
+#include "OceanBounds.h"
+#include "OceanCpuSimulation.h"
+#include "Async/Async.h"
 #include "Async/ParallelFor.h"
 #include "Pass/PassUtil.h"
 
+namespace
+{
+	// Sections are limited to 256x256 vertices so that their indices fit in 16 bits
+	constexpr int32 MaxSectionVertexCount = 256;
+	constexpr int32 MaxSectionCellCount = MaxSectionVertexCount - 1;
+
+	// Vertices displaced per SIMD group
+	constexpr int32 DisplacementLaneCount = 4;
+
+	struct FSectionLayout
+	{
+		int32 FirstX;
+		int32 FirstY;
+		int32 VertexCountX;
+		int32 VertexCountY;
+	};
+
+	// Neighbouring sections share their border vertices
+	FSectionLayout GetSectionLayout(int32 CellCountX, int32 CellCountY, int32 SectionX, int32 SectionY)
+	{
+		FSectionLayout Layout;
+		Layout.FirstX = SectionX * MaxSectionCellCount;
+		Layout.FirstY = SectionY * MaxSectionCellCount;
+		Layout.VertexCountX = FMath::Min(MaxSectionCellCount, CellCountX - Layout.FirstX) + 1;
+		Layout.VertexCountY = FMath::Min(MaxSectionCellCount, CellCountY - Layout.FirstY) + 1;
+
+		return Layout;
+	}
+
+	FCriticalSection SectionTrianglesLock;
+	TMap<FIntPoint, TSharedRef<const TArray<int32>>> SectionTrianglesCache;
+
+	// Triangle indices only depend on the section dimensions, so they are shared by every section and every component of the same size
+	TSharedRef<const TArray<int32>> GetSectionTriangles(int32 SectionVertexCountX, int32 SectionVertexCountY)
+	{
+		FScopeLock Lock(&SectionTrianglesLock);
+
+		const FIntPoint Key(SectionVertexCountX, SectionVertexCountY);
+
+		if (const TSharedRef<const TArray<int32>>* CachedTriangles = SectionTrianglesCache.Find(Key))
+		{
+			return *CachedTriangles;
+		}
+
+		const int32 CellCountX = SectionVertexCountX - 1;
+		const int32 CellCountY = SectionVertexCountY - 1;
+
+		TSharedRef<TArray<int32>> Triangles = MakeShared<TArray<int32>>();
+		Triangles->AddUninitialized(CellCountX * CellCountY * 6);
+
+		int32* TriangleData = Triangles->GetData();
+
+		ParallelFor(CellCountY, [=](int32 Y)
+		{
+			int32 Idx = Y * CellCountX * 6;
+
+			for (int32 X = 0; X < CellCountX; ++X)
+			{
+				int32 A = Y * SectionVertexCountX + X;
+				int32 B = A + SectionVertexCountX;
+				int32 C = A + SectionVertexCountX + 1;
+				int32 D = A + 1;
+
+				TriangleData[Idx++] = A;
+				TriangleData[Idx++] = B;
+				TriangleData[Idx++] = C;
+
+				TriangleData[Idx++] = A;
+				TriangleData[Idx++] = C;
+				TriangleData[Idx++] = D;
+			}
+		});
+
+		SectionTrianglesCache.Add(Key, Triangles);
+
+		return Triangles;
+	}
+}
+
 UProceduralOceanComponent::UProceduralOceanComponent(const FObjectInitializer& ObjectInitializer) :
 	Super(ObjectInitializer),
-	OceanRenderer(new FFFTOceanRenderer)
+	BuiltVertexCountX(0),
+	BuiltVertexCountY(0),
+	BuiltCellWidthX(0),
+	BuiltCellWidthY(0),
+	bBuiltCpuDisplacement(false),
+	bBuiltCollision(false),
+	ReadyCpuBufferIndex(INDEX_NONE),
+	UploadingCpuBufferIndex(INDEX_NONE),
+	bCpuGeometryRebuilt(false),
+	CpuDisplacementTime(-1),
+	LastCollisionUpdateTime(0)
 {
 	VertexCountX = 60;
 	VertexCountY = 60;
@@ -18,81 +110,484 @@ UProceduralOceanComponent::UProceduralOceanComponent(const FObjectInitializer& O
 
 	PrimaryComponentTick.bCanEverTick = true;
 	PrimaryComponentTick.bStartWithTickEnabled = true;
+	PrimaryComponentTick.bRunOnAnyThread = true;
 
 	bTickInEditor = true;
 	bAutoActivate = true;
 
+	// CPU displaced collision is cooked again every CollisionUpdateInterval, which must not stall the game thread
+	bUseAsyncCooking = true;
+
+	// Estimated from the spectrum on register, until the GPU wave statistics take over
+	MaxDisplacement = FVector::ZeroVector;
+	DisplacementPadding = FFTOcean::GetDisplacementPadding(MaxDisplacement);
+
 	RenderConfig.RenderTextureWidth = 512;
 	RenderConfig.RenderTextureHeight = 512;
+	RenderConfig.GerstnerWaveCount = 16;
+}
+
+void UProceduralOceanComponent::SetMaxDisplacement(const FVector& InMaxDisplacement)
+{
+	MaxDisplacement = InMaxDisplacement.GetAbs();
+
+	if (FFTOcean::IsDisplacementPaddingOutdated(DisplacementPadding, MaxDisplacement))
+	{
+		DisplacementPadding = FFTOcean::GetDisplacementPadding(MaxDisplacement);
+		UpdateBounds();
+		MarkRenderTransformDirty();
+	}
+}
+
+void UProceduralOceanComponent::BakeFlipbook()
+{
+	FOceanSimulationDriver::BakeFlipbook(this, RenderConfig, FlipbookBakeSettings);
+}
+
+void UProceduralOceanComponent::TransitionSeaState(float WaveAmplitude, float WindVelocity, float WindDirection, float TransitionTime)
+{
+	FOceanSimulationDriver::TransitionSeaState(RenderConfig, WaveAmplitude, WindVelocity, WindDirection, TransitionTime);
+}
+
+void UProceduralOceanComponent::AddRadialImpulse(FVector2D Center, float Radius, float Amplitude)
+{
+	SimulationDriver.AddRadialImpulse(Center, Radius, Amplitude);
+}
+
+void UProceduralOceanComponent::AddWake(FVector2D Start, FVector2D End, float Width, float Amplitude)
+{
+	SimulationDriver.AddWake(Start, End, Width, Amplitude);
+}
+
+FOceanWaveStatistics UProceduralOceanComponent::GetWaveStatistics() const
+{
+	return SimulationDriver.GetWaveStatistics();
+}
+
+FOceanSnapshotRef UProceduralOceanComponent::GetSurfaceSnapshot() const
+{
+	return SimulationDriver.GetSurfaceSnapshot();
+}
+
+FBoxSphereBounds UProceduralOceanComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+	// MaxDisplacement may have been edited directly, so never pad less than it asks for
+	const FVector Padding = DisplacementPadding.ComponentMax(MaxDisplacement.GetAbs());
+	return FFTOcean::ExpandBoundsByDisplacement(Super::CalcBounds(LocalToWorld), Padding, LocalToWorld);
+}
+
+int32 UProceduralOceanComponent::GetNumMaterials() const
+{
+	return 1;
+}
+
+UMaterialInterface* UProceduralOceanComponent::GetMaterial(int32 ElementIndex) const
+{
+	return Super::GetMaterial(0);
 }
 
 void UProceduralOceanComponent::InitOceanGeometry()
 {
-	const int32 VertexCount = VertexCountX * VertexCountY;
-	const int32 TriangleCount = (VertexCountX - 1) * (VertexCountY - 1) * 6;
+	const int32 CellCountX = VertexCountX - 1;
+	const int32 CellCountY = VertexCountY - 1;
+	const int32 SectionCountX = FMath::DivideAndRoundUp(CellCountX, MaxSectionCellCount);
+	const int32 SectionCountY = FMath::DivideAndRoundUp(CellCountY, MaxSectionCellCount);
 
-	TArray<FVector> Vertices;
-	TArray<FVector> Normals;
-	TArray<FVector2D> UVs;
-	TArray<int32> Triangles;
 	TArray<FColor> VertexColors;
 	TArray<FProcMeshTangent> Tangents;
 
-	Vertices.AddUninitialized(VertexCount);
-	Normals.AddUninitialized(VertexCount);
-	UVs.AddUninitialized(VertexCount);
-	Triangles.AddUninitialized(TriangleCount);
+	const bool bCreateCollision = CpuDisplacement.bEnabled && CpuDisplacement.bCreateCollision;
+
+	ClearAllMeshSections();
 
-	ParallelFor(VertexCount, [&](int32 Index)
+	for (int32 SectionY = 0; SectionY < SectionCountY; ++SectionY)
 	{
-		int32 IndexX = Index % VertexCountX;
-		int32 IndexY = Index / VertexCountX;
-		float LocX = IndexX * CellWidthX;
-		float LocY = IndexY * CellWidthY;
-		float LocZ = 0.0f;
-		float U = StaticCast<float>(IndexX) / (VertexCountX - 1);
-		float V = StaticCast<float>(IndexY) / (VertexCountY - 1);
+		for (int32 SectionX = 0; SectionX < SectionCountX; ++SectionX)
+		{
+			const FSectionLayout Layout = GetSectionLayout(CellCountX, CellCountY, SectionX, SectionY);
+			const int32 FirstX = Layout.FirstX;
+			const int32 FirstY = Layout.FirstY;
+			const int32 SectionVertexCountX = Layout.VertexCountX;
+			const int32 SectionVertexCountY = Layout.VertexCountY;
+			const int32 SectionVertexCount = SectionVertexCountX * SectionVertexCountY;
 
-		Vertices[Index] = FVector(LocX, LocY, LocZ);
-		Normals[Index] = FVector::UpVector;
-		UVs[Index] = FVector2D(U, V);
-	});
+			SectionVertices.SetNumUninitialized(SectionVertexCount, false);
+			SectionNormals.SetNumUninitialized(SectionVertexCount, false);
+			SectionUVs.SetNumUninitialized(SectionVertexCount, false);
 
-	int32 Idx = 0;
+			ParallelFor(SectionVertexCount, [&](int32 Index)
+			{
+				int32 IndexX = FirstX + Index % SectionVertexCountX;
+				int32 IndexY = FirstY + Index / SectionVertexCountX;
+				float LocX = IndexX * CellWidthX;
+				float LocY = IndexY * CellWidthY;
+				float LocZ = 0.0f;
+				float U = StaticCast<float>(IndexX) / CellCountX;
+				float V = StaticCast<float>(IndexY) / CellCountY;
 
-	for (int32 Y = 0; Y < VertexCountY - 1; ++Y)
-	{
-		for (int32 X = 0; X < VertexCountX - 1; ++X)
-		{
-			int A = Y * VertexCountX + X;
-			int B = A + VertexCountX;
-			int C = A + VertexCountX + 1;
-			int D = A + 1;
-
-			Triangles[Idx++] = A;
-			Triangles[Idx++] = B;
-			Triangles[Idx++] = C;
-
-			Triangles[Idx++] = A;
-			Triangles[Idx++] = C;
-			Triangles[Idx++] = D;
+				SectionVertices[Index] = FVector(LocX, LocY, LocZ);
+				SectionNormals[Index] = FVector::UpVector;
+				SectionUVs[Index] = FVector2D(U, V);
+			});
+
+			TSharedRef<const TArray<int32>> Triangles = GetSectionTriangles(SectionVertexCountX, SectionVertexCountY);
+
+			const int32 SectionIndex = SectionY * SectionCountX + SectionX;
+			CreateMeshSection(SectionIndex, SectionVertices, *Triangles, SectionNormals, SectionUVs, VertexColors, Tangents, bCreateCollision);
 		}
 	}
 
-	ClearMeshSection(0);
-	CreateMeshSection(0, Vertices, Triangles, Normals, UVs, VertexColors, Tangents, false);
+	BuiltVertexCountX = VertexCountX;
+	BuiltVertexCountY = VertexCountY;
+	BuiltCellWidthX = CellWidthX;
+	BuiltCellWidthY = CellWidthY;
+	bBuiltCpuDisplacement = CpuDisplacement.bEnabled;
+	bBuiltCollision = bCreateCollision;
+	SimulationDriver.SetForceSurfaceReadback(bBuiltCpuDisplacement);
+
+	// The new sections start flat, the next snapshot displaces them even if it was displaced before
+	bCpuGeometryRebuilt = true;
+}
+
+bool UProceduralOceanComponent::IsOceanGeometryOutdated() const
+{
+	bool bOutdated = GetNumSections() == 0;
+	bOutdated |= BuiltVertexCountX != VertexCountX;
+	bOutdated |= BuiltVertexCountY != VertexCountY;
+	bOutdated |= BuiltCellWidthX != CellWidthX;
+	bOutdated |= BuiltCellWidthY != CellWidthY;
+	bOutdated |= bBuiltCpuDisplacement != CpuDisplacement.bEnabled;
+	bOutdated |= bBuiltCollision != (CpuDisplacement.bEnabled && CpuDisplacement.bCreateCollision);
+
+	return bOutdated;
 }
 
 void UProceduralOceanComponent::OnRegister()
 {
 	Super::OnRegister();
-	InitOceanGeometry();
+
+	SimulationDriver.Register(this, RenderConfig, DebugConfig, SimulationPolicy, [this](const FVector& InMaxDisplacement)
+	{
+		SetMaxDisplacement(InMaxDisplacement);
+	},
+	[this]()
+	{
+		CopyCpuTickProperties();
+	});
+
+	if (MaxDisplacement.IsZero())
+	{
+		SetMaxDisplacement(FFTOcean::EstimateMaxDisplacement(RenderConfig));
+	}
+
+	if (IsOceanGeometryOutdated())
+	{
+		InitOceanGeometry();
+	}
+}
+
+#if WITH_EDITOR
+void UProceduralOceanComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	// Rendering property tweaks re-register the component, but only geometry property changes need new mesh sections
+	if (IsOceanGeometryOutdated())
+	{
+		InitOceanGeometry();
+	}
+}
+#endif
+
+void UProceduralOceanComponent::RegisterComponentTickFunctions(bool bRegister)
+{
+	Super::RegisterComponentTickFunctions(bRegister);
+
+	SimulationDriver.RegisterTickFunction(bRegister);
+}
+
+void UProceduralOceanComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	SimulationDriver.BeginPlay();
+}
+
+void UProceduralOceanComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	SimulationDriver.EndPlay();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UProceduralOceanComponent::WarmUp()
+{
+	SimulationDriver.WarmUp();
 }
 
 void UProceduralOceanComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
-	float Timestamp = UGameplayStatics::GetRealTimeSeconds(GetWorld()) * RenderConfig.TimeMultiply + RenderConfig.StartTime;
-	OceanRenderer->Render(Timestamp, RenderConfig, DebugConfig);
+	if (!SimulationDriver.Tick(DeltaTime))
+	{
+		return;
+	}
+
+	if (CpuTickProperties.bEnabled)
+	{
+		UpdateCpuDisplacement();
+	}
+}
+
+void UProceduralOceanComponent::CopyCpuTickProperties()
+{
+	CpuTickProperties.Settings = CpuDisplacement;
+	CpuTickProperties.bEnabled = bBuiltCpuDisplacement;
+	CpuTickProperties.VertexCountX = BuiltVertexCountX;
+	CpuTickProperties.VertexCountY = BuiltVertexCountY;
+	CpuTickProperties.CellWidthX = BuiltCellWidthX;
+	CpuTickProperties.CellWidthY = BuiltCellWidthY;
+
+	if (bCpuGeometryRebuilt)
+	{
+		CpuDisplacementTime = -1;
+		bCpuGeometryRebuilt = false;
+	}
+}
+
+void UProceduralOceanComponent::UpdateCpuDisplacement()
+{
+	const FOceanSnapshotRef Snapshot = SimulationDriver.GetSurfaceSnapshot();
+
+	// Throttled readbacks publish less often than the component ticks, a snapshot is only displaced once
+	if (!Snapshot.IsValid() || Snapshot->GetTime() == CpuDisplacementTime)
+	{
+		return;
+	}
+
+	int32 WriteIndex = INDEX_NONE;
+	{
+		FScopeLock Lock(&CpuBufferLock);
+
+		for (int32 Index = 0; Index < 2; ++Index)
+		{
+			if (Index != ReadyCpuBufferIndex && Index != UploadingCpuBufferIndex)
+			{
+				WriteIndex = Index;
+				break;
+			}
+		}
+	}
+
+	// One set waits for its upload while the other uploads, the next tick tries again
+	if (WriteIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	CpuDisplacementTime = Snapshot->GetTime();
+	DisplaceGrid(*Snapshot);
+
+	const int32 CellCountX = CpuTickProperties.VertexCountX - 1;
+	const int32 CellCountY = CpuTickProperties.VertexCountY - 1;
+	const int32 SectionCountX = FMath::DivideAndRoundUp(CellCountX, MaxSectionCellCount);
+	const int32 SectionCount = SectionCountX * FMath::DivideAndRoundUp(CellCountY, MaxSectionCellCount);
+
+	TArray<TArray<FVector>>& Vertices = CpuSectionVertices[WriteIndex];
+	TArray<TArray<FVector>>& Normals = CpuSectionNormals[WriteIndex];
+	Vertices.SetNum(SectionCount);
+	Normals.SetNum(SectionCount);
+
+	ParallelFor(SectionCount, [&](int32 SectionIndex)
+	{
+		const FSectionLayout Layout = GetSectionLayout(CellCountX, CellCountY, SectionIndex % SectionCountX, SectionIndex / SectionCountX);
+		const int32 SectionVertexCount = Layout.VertexCountX * Layout.VertexCountY;
+
+		// Sized once, later updates reuse the allocation
+		Vertices[SectionIndex].SetNumUninitialized(SectionVertexCount, false);
+		Normals[SectionIndex].SetNumUninitialized(SectionVertexCount, false);
+
+		for (int32 Y = 0; Y < Layout.VertexCountY; ++Y)
+		{
+			const int32 GridIndex = (Layout.FirstY + Y) * CpuTickProperties.VertexCountX + Layout.FirstX;
+			const int32 SectionRowIndex = Y * Layout.VertexCountX;
+
+			FMemory::Memcpy(&Vertices[SectionIndex][SectionRowIndex], &CpuGridVertices[GridIndex], Layout.VertexCountX * sizeof(FVector));
+			FMemory::Memcpy(&Normals[SectionIndex][SectionRowIndex], &CpuGridNormals[GridIndex], Layout.VertexCountX * sizeof(FVector));
+		}
+	});
+
+	bool bQueueUpload = false;
+	{
+		FScopeLock Lock(&CpuBufferLock);
+
+		// A set still waiting for its upload already has one queued, which picks this newer set instead
+		bQueueUpload = ReadyCpuBufferIndex == INDEX_NONE;
+		ReadyCpuBufferIndex = WriteIndex;
+	}
+
+	if (!bQueueUpload)
+	{
+		return;
+	}
+
+	// Mesh sections can only be updated on the game thread
+	if (IsInGameThread())
+	{
+		UploadCpuDisplacement();
+	}
+	else
+	{
+		TWeakObjectPtr<UProceduralOceanComponent> WeakThis(this);
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis]()
+		{
+			if (UProceduralOceanComponent* This = WeakThis.Get())
+			{
+				This->UploadCpuDisplacement();
+			}
+		});
+	}
+}
+
+void UProceduralOceanComponent::DisplaceGrid(const FOceanSurfaceSnapshot& Snapshot)
+{
+	const int32 VertexCount = CpuTickProperties.VertexCountX * CpuTickProperties.VertexCountY;
+
+	CpuGridVertices.SetNumUninitialized(VertexCount, false);
+	CpuGridNormals.SetNumUninitialized(VertexCount, false);
+
+	// Patch space length of one cell, the section UVs span UVTiling patches like the material lookup
+	const FVector2D CellPatchLength(
+		FFTOcean::PatchLength * CpuTickProperties.Settings.UVTiling / (CpuTickProperties.VertexCountX - 1),
+		FFTOcean::PatchLength * CpuTickProperties.Settings.UVTiling / (CpuTickProperties.VertexCountY - 1));
+
+	const VectorRegister ScaleX = VectorSetFloat1(CpuTickProperties.Settings.DisplacementScale.X);
+	const VectorRegister ScaleY = VectorSetFloat1(CpuTickProperties.Settings.DisplacementScale.Y);
+	const VectorRegister ScaleZ = VectorSetFloat1(CpuTickProperties.Settings.DisplacementScale.Z);
+
+	ParallelFor(CpuTickProperties.VertexCountY, [&](int32 Y)
+	{
+		MS_ALIGN(16) float LocationX[DisplacementLaneCount] GCC_ALIGN(16);
+		MS_ALIGN(16) float LocationY[DisplacementLaneCount] GCC_ALIGN(16);
+		MS_ALIGN(16) float Displacement[3][DisplacementLaneCount] GCC_ALIGN(16);
+
+		for (int32 FirstX = 0; FirstX < CpuTickProperties.VertexCountX; FirstX += DisplacementLaneCount)
+		{
+			const int32 LaneCount = FMath::Min(DisplacementLaneCount, CpuTickProperties.VertexCountX - FirstX);
+
+			// The last group of a row repeats its last vertex in the unused lanes
+			for (int32 Lane = 0; Lane < DisplacementLaneCount; ++Lane)
+			{
+				LocationX[Lane] = (FirstX + FMath::Min(Lane, LaneCount - 1)) * CellPatchLength.X;
+				LocationY[Lane] = Y * CellPatchLength.Y;
+			}
+
+			VectorRegister DisplacementX;
+			VectorRegister DisplacementY;
+			VectorRegister DisplacementZ;
+			Snapshot.SampleDisplacementLanes(LocationX, LocationY, DisplacementX, DisplacementY, DisplacementZ);
+
+			VectorStoreAligned(VectorMultiply(DisplacementX, ScaleX), Displacement[0]);
+			VectorStoreAligned(VectorMultiply(DisplacementY, ScaleY), Displacement[1]);
+			VectorStoreAligned(VectorMultiply(DisplacementZ, ScaleZ), Displacement[2]);
+
+			for (int32 Lane = 0; Lane < LaneCount; ++Lane)
+			{
+				const int32 X = FirstX + Lane;
+
+				CpuGridVertices[Y * CpuTickProperties.VertexCountX + X] = FVector(
+					X * CpuTickProperties.CellWidthX + Displacement[0][Lane],
+					Y * CpuTickProperties.CellWidthY + Displacement[1][Lane],
+					Displacement[2][Lane]);
+			}
+		}
+	});
+
+	// Central differences of the displaced vertices, one sided on the borders of the grid
+	ParallelFor(CpuTickProperties.VertexCountY, [&](int32 Y)
+	{
+		const FVector* Row = &CpuGridVertices[Y * CpuTickProperties.VertexCountX];
+		const FVector* PreviousRow = &CpuGridVertices[FMath::Max(Y - 1, 0) * CpuTickProperties.VertexCountX];
+		const FVector* NextRow = &CpuGridVertices[FMath::Min(Y + 1, CpuTickProperties.VertexCountY - 1) * CpuTickProperties.VertexCountX];
+
+		for (int32 X = 0; X < CpuTickProperties.VertexCountX; ++X)
+		{
+			const FVector TangentX = Row[FMath::Min(X + 1, CpuTickProperties.VertexCountX - 1)] - Row[FMath::Max(X - 1, 0)];
+			const FVector TangentY = NextRow[X] - PreviousRow[X];
+
+			CpuGridNormals[Y * CpuTickProperties.VertexCountX + X] = FVector::CrossProduct(TangentX, TangentY).GetSafeNormal();
+		}
+	});
 }
+
+void UProceduralOceanComponent::UploadCpuDisplacement()
+{
+	check(IsInGameThread());
+
+	int32 UploadIndex = INDEX_NONE;
+	{
+		FScopeLock Lock(&CpuBufferLock);
+
+		UploadIndex = ReadyCpuBufferIndex;
+		UploadingCpuBufferIndex = UploadIndex;
+		ReadyCpuBufferIndex = INDEX_NONE;
+	}
+
+	if (UploadIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	const TArray<TArray<FVector>>& Vertices = CpuSectionVertices[UploadIndex];
+	const TArray<TArray<FVector>>& Normals = CpuSectionNormals[UploadIndex];
+
+	// Empty arrays keep the UVs, colors and tangents of the sections
+	const TArray<FVector2D> UVs;
+	const TArray<FColor> VertexColors;
+	const TArray<FProcMeshTangent> Tangents;
+
+	// The geometry may have been rebuilt since the set was filled
+	if (Vertices.Num() == GetNumSections())
+	{
+		auto CanUpdateSection = [this, &Vertices](int32 SectionIndex)
+		{
+			const FProcMeshSection* Section = GetProcMeshSection(SectionIndex);
+			return Section && Section->ProcVertexBuffer.Num() == Vertices[SectionIndex].Num();
+		};
+
+		const double Time = FPlatformTime::Seconds();
+		int32 CookingSectionIndex = INDEX_NONE;
+
+		// UpdateMeshSection cooks the whole collision again for every section that has some, so the sections are
+		// updated as render only ones, except the last one once the interval has passed. Its update cooks the collision
+		// of every section along with the convex meshes of the component.
+		if (bBuiltCollision && Time - LastCollisionUpdateTime >= CpuDisplacement.CollisionUpdateInterval)
+		{
+			for (int32 SectionIndex = Vertices.Num() - 1; SectionIndex >= 0 && CookingSectionIndex == INDEX_NONE; --SectionIndex)
+			{
+				CookingSectionIndex = CanUpdateSection(SectionIndex) ? SectionIndex : INDEX_NONE;
+			}
+
+			LastCollisionUpdateTime = Time;
+		}
+
+		for (int32 SectionIndex = 0; SectionIndex < Vertices.Num(); ++SectionIndex)
+		{
+			if (CanUpdateSection(SectionIndex))
+			{
+				FProcMeshSection* Section = GetProcMeshSection(SectionIndex);
+
+				Section->bEnableCollision = SectionIndex == CookingSectionIndex;
+				UpdateMeshSection(SectionIndex, Vertices[SectionIndex], Normals[SectionIndex], UVs, VertexColors, Tangents);
+				Section->bEnableCollision = bBuiltCollision;
+			}
+		}
+	}
+
+	{
+		FScopeLock Lock(&CpuBufferLock);
+		UploadingCpuBufferIndex = INDEX_NONE;
+	}
+}
\ No newline at end of file
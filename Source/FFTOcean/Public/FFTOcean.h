@@ -4,6 +4,12 @@
 
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
+#include "Stats/Stats.h"
+
+FFTOCEAN_API DECLARE_LOG_CATEGORY_EXTERN(LogFFTOcean, Log, All);
+
+// Render thread cost of the oceans, see "stat FFTOcean"
+DECLARE_STATS_GROUP(TEXT("FFTOcean"), STATGROUP_FFTOcean, STATCAT_Advanced);
 
 class FFFTOceanModule : public IModuleInterface
 {
@@ -12,4 +18,8 @@ public:
 	/** IModuleInterface implementation */
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
+
+private:
+
+	FDelegateHandle WorldPostActorTickHandle;
 };
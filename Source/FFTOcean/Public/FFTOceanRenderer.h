@@ -3,15 +3,15 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "Pass/PhillipsFourierPass.h"
-#include "Pass/FourierComponentPass.h"
-#include "Pass/TwiddleFactorsPass.h"
-#include "Pass/InverseTransformPass.h"
-#include "Pass/SurfaceDisplacementPass.h"
-#include "Pass/SurfaceNormalPass.h"
+#include "Async/Future.h"
+#include "OceanDisturbance.h"
+#include "OceanSnapshotPublisher.h"
 
 #include "FFTOceanRenderer.generated.h"
 
+// Most waves the Gerstner mode keeps from the spectrum, twice as many are evaluated during sea state transitions
+#define OCEAN_MAX_GERSTNER_WAVE_COUNT 32
+
 USTRUCT(BlueprintType)
 struct FOceanRenderConfig
 {
@@ -41,11 +41,43 @@ struct FOceanRenderConfig
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0))
 	float NormalStrength;
 
+	// Build normals from slope spectra transformed along with the displacement, instead of a Sobel filter on the height
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bAnalyticNormals;
+
+	// Quantize the wave frequencies so the surface loops after this many seconds, zero keeps the exact dispersion
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0))
+	float LoopPeriod;
+
+	// Simulation seconds a change of WaveAmplitude, WindVelocity or WindDirection takes to blend in, zero applies it at once
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0))
+	float SeaStateTransitionTime;
+
+	// Copy the displacement map back every frame and publish it as surface snapshots for CPU queries.
+	// Snapshots lag the rendered surface by a few frames.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bReadbackSurface;
+
+	// Sum GerstnerWaveCount analytic waves, the most energetic of the spectrum, instead of running the transform.
+	// Much cheaper and blurrier, meant for distant oceans and low end hardware.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bGerstnerWaves;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 1, ClampMax = 32))
+	int32 GerstnerWaveCount;
+
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
 	class UTextureRenderTarget2D* DisplacementMap;
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
 	class UTextureRenderTarget2D* NormalMap;
+
+	// One period of baked frames, played back over LoopPeriod instead of running the simulation when both are set
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	class UTexture2DArray* DisplacementFlipbook;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	class UTexture2DArray* NormalFlipbook;
 };
 
 
@@ -79,6 +111,58 @@ struct FOceanDebugConfig
 	class UTextureRenderTarget2D* TransformDebugTextureZ;
 };
 
+USTRUCT(BlueprintType)
+struct FOceanWaveStatistics
+{
+	GENERATED_BODY()
+
+	// False until the first statistics have been read back from the GPU
+	UPROPERTY(BlueprintReadOnly)
+	bool bValid;
+
+	// Largest absolute displacement along each axis
+	UPROPERTY(BlueprintReadOnly)
+	FVector MaxDisplacement;
+
+	UPROPERTY(BlueprintReadOnly)
+	float MeanHeight;
+
+	// Four times the standard deviation of the surface height
+	UPROPERTY(BlueprintReadOnly)
+	float SignificantWaveHeight;
+
+	FOceanWaveStatistics() :
+		bValid(false),
+		MaxDisplacement(FVector::ZeroVector),
+		MeanHeight(0),
+		SignificantWaveHeight(0)
+	{
+	}
+};
+
+// Parameters of the wave spectrum, changing any of them regenerates it
+struct FOceanSeaState
+{
+	float     WaveAmplitude;
+	FVector2D WindSpeed;
+};
+
+// Everything the Gerstner waves picked from a spectrum depend on
+struct FOceanGerstnerWaveSetKey
+{
+	FOceanSeaState SeaState;
+	int32          Size;
+	float          LoopPeriod;
+	int32          WaveCount;
+};
+
+class FOceanRenderProxy;
+struct FOceanRenderPacket;
+struct FOceanGerstnerWaveSet;
+
+typedef TSharedPtr<const FOceanGerstnerWaveSet, ESPMode::ThreadSafe> FOceanGerstnerWaveSetPtr;
+
+// Game thread handle of an ocean; it only sends per-frame packets to the render proxy that owns the GPU resources
 class FFFTOceanRenderer final
 {
 public:
@@ -86,14 +170,78 @@ public:
 	FFFTOceanRenderer();
 	~FFFTOceanRenderer();
 
-	void Render(float Timestamp, const FOceanRenderConfig& Config, const FOceanDebugConfig& DebugConfig);
+	// Safe to call from any thread, as long as calls for one renderer are not concurrent.
+	// bFarField renders the Gerstner waves whatever the config says, for oceans far from every view.
+	void Render(float Timestamp, const FOceanRenderConfig& Config, const FOceanDebugConfig& DebugConfig, bool bFarField = false);
+
+	// Builds the GPU resources, twiddle table and spectra for the config ahead of its first Render, or picks its
+	// Gerstner waves, so the first visible frame only runs the time dependent passes. Same threading rules as Render.
+	void WarmUp(const FOceanRenderConfig& Config, bool bFarField = false);
+
+	FOceanWaveStatistics GetWaveStatistics() const;
+
+	// GPU milliseconds the last measured frame of the transform took, zero until one was read back. Lags a few frames.
+	float GetGpuTime() const;
+
+	// Size the transform currently renders at. After a resolution change the previous size keeps rendering until the
+	// new passes are ready, zero before the first transform.
+	FIntPoint GetActiveTextureSize() const;
+
+	// Renders the oceans queued by r.FFTOcean.Batching since the last flush. The module flushes once every world has
+	// ticked its actors; code that renders outside of a world tick and needs the result calls it itself. Also releases
+	// the passes oceans replaced a few frames ago.
+	static void FlushBatchedOceans();
+
+	// Safe to call from any thread at any time, the disturbance is splatted onto the next rendered frame only.
+	// Only the transform renders disturbances, Gerstner wave, far field and flipbook frames drop them. At most
+	// OCEAN_MAX_DISTURBANCE_COUNT wait for the next frame, while updates are throttled the oldest make room first.
+	void AddDisturbance(const FOceanDisturbance& Disturbance);
+
+	// Latest surface snapshot read back from the GPU, invalid unless bReadbackSurface is set. Safe to call from any thread.
+	FOceanSnapshotRef GetSurfaceSnapshot() const;
+
+	// For a CPU simulation to publish snapshots instead, only while bReadbackSurface is off
+	FORCEINLINE const TSharedRef<FOceanSnapshotPublisher, ESPMode::ThreadSafe>& GetSnapshotPublisher() const
+	{
+		return SnapshotPublisher;
+	}
 
 private:
 
-	TUniquePtr<FPhillipsFourierPass>     PhillipsFourierPass;
-	TUniquePtr<FFourierComponentPass>    FourierComponentPass;
-	TUniquePtr<FTwiddleFactorsPass>      TwiddleFactorsPass;
-	TUniquePtr<FInverseTransformPass>    InverseTransformPass;
-	TUniquePtr<FSurfaceDisplacementPass> SurfaceDisplacementPass;
-	TUniquePtr<FSurfaceNormalPass>       SurfaceNormalPass;
-};
+	// Shared with the render commands in flight, the proxy itself is only ever released on the render thread
+	TSharedPtr<FOceanRenderProxy, ESPMode::ThreadSafe> RenderProxy;
+
+	TSharedRef<FOceanSnapshotPublisher, ESPMode::ThreadSafe> SnapshotPublisher;
+
+	// Sea state transition, timed by the timestamps passed to Render
+	bool           bHasSeaState;
+	FOceanSeaState OutgoingSeaState;
+	FOceanSeaState IncomingSeaState;
+	float          SeaStateTransitionStartTime;
+	float          SeaStateBlend;
+
+	// Ring of the latest disturbances, filled from any thread and emptied into the packet by Render
+	FCriticalSection           PendingDisturbanceLock;
+	TArray<FOceanDisturbance>  PendingDisturbances;
+	int32                      OldestPendingDisturbance;
+	bool                       bWarnedDroppedDisturbances;
+
+	struct FGerstnerWaveBuild
+	{
+		FOceanGerstnerWaveSetKey         Key;
+		TFuture<FOceanGerstnerWaveSetPtr> Result;
+	};
+
+	// Gerstner waves of both sea states. Scoring the whole spectrum is too slow for the tick, so a new sea state or
+	// spectrum size is built on the thread pool while the previous waves keep rendering; only the first set is waited for.
+	FOceanGerstnerWaveSetPtr   OutgoingGerstnerWaves;
+	FOceanGerstnerWaveSetPtr   IncomingGerstnerWaves;
+	TArray<FGerstnerWaveBuild> GerstnerWaveBuilds;
+
+	void InitPacket(FOceanRenderPacket& Packet, float Timestamp, const FOceanRenderConfig& Config) const;
+	void UpdateSeaStateTransition(float Timestamp, const FOceanSeaState& TargetSeaState, float TransitionTime);
+	void UpdateGerstnerWaves(const FOceanRenderConfig& Config, bool bTransition);
+
+	// The finished set for the key, starting its build if needed. Null while the build runs, unless bWait is set.
+	FOceanGerstnerWaveSetPtr RequestGerstnerWaveSet(const FOceanGerstnerWaveSetKey& Key, bool bWait);
+};
\ No newline at end of file
@@ -0,0 +1,26 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+
+#include "OceanBakeCommandlet.generated.h"
+
+// Precomputes an ocean sequence at a fixed timestep into a baked stream, see OceanBakeFormat.h.
+// The simulation runs on the CPU, so it works with -nullrhi on build machines.
+//
+// UE4Editor-Cmd.exe Project -run=OceanBake -Output=Sea.obake -WaveAmplitude=1 -WindVelocity=1000
+//     [-Size=256] [-Frames=300] [-FrameRate=30] [-StartTime=0] [-WindDirection=0] [-NormalStrength=1]
+//     [-LoopPeriod=0] [-AnalyticNormals] [-Quantize] [-Compress]
+UCLASS()
+class FFTOCEAN_API UOceanBakeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UOceanBakeCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
\ No newline at end of file
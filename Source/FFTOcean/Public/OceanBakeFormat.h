@@ -0,0 +1,163 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+
+// Baked ocean stream layout:
+//   FOceanBakeHeader
+//   FOceanBakeChunkEntry[FrameCount * OCEAN_BAKE_CHUNKS_PER_FRAME], the frame index table
+//   Chunk payloads
+// Every frame stores a displacement chunk followed by a normal chunk. A chunk decodes on its own, so any frame
+// can be read with one seek per chunk.
+#define OCEAN_BAKE_MAGIC            0x4B41424F // "OBAK"
+#define OCEAN_BAKE_VERSION          1
+#define OCEAN_BAKE_CHUNKS_PER_FRAME 2
+
+enum class EOceanBakeChunk : uint8
+{
+	Displacement = 0,
+	Normal = 1
+};
+
+enum class EOceanBakeEncoding : uint8
+{
+	// FFloat16Color texels
+	Half = 0,
+
+	// 16 bit unsigned texels, remapped per chunk and channel from the range stored in front of them
+	Quantized = 1
+};
+
+struct FOceanBakeHeader
+{
+	uint32 Magic;
+	uint32 Version;
+	uint32 Width;
+	uint32 Height;
+	uint32 FrameCount;
+	float  StartTime;
+	float  TimeStep;
+	float  LoopPeriod;
+	uint8  Encoding;
+	uint8  bCompressed;
+
+	FOceanBakeHeader() :
+		Magic(OCEAN_BAKE_MAGIC),
+		Version(OCEAN_BAKE_VERSION),
+		Width(0),
+		Height(0),
+		FrameCount(0),
+		StartTime(0),
+		TimeStep(0),
+		LoopPeriod(0),
+		Encoding(StaticCast<uint8>(EOceanBakeEncoding::Half)),
+		bCompressed(0)
+	{
+	}
+
+	FORCEINLINE EOceanBakeEncoding GetEncoding() const
+	{
+		return StaticCast<EOceanBakeEncoding>(Encoding);
+	}
+
+	FORCEINLINE int32 GetTexelCount() const
+	{
+		return StaticCast<int32>(Width * Height);
+	}
+
+	bool IsValid() const;
+
+	friend FFTOCEAN_API FArchive& operator<<(FArchive& Ar, FOceanBakeHeader& Header);
+};
+
+struct FOceanBakeChunkEntry
+{
+	uint64 Offset;
+
+	// Bytes in the file, equal to RawSize unless the chunk is compressed
+	uint32 StoredSize;
+	uint32 RawSize;
+
+	FOceanBakeChunkEntry() :
+		Offset(0),
+		StoredSize(0),
+		RawSize(0)
+	{
+	}
+
+	friend FFTOCEAN_API FArchive& operator<<(FArchive& Ar, FOceanBakeChunkEntry& Entry);
+};
+
+namespace FFTOcean
+{
+	FFTOCEAN_API int64 GetOceanBakeIndexTableOffset();
+	FFTOCEAN_API int64 GetOceanBakeIndexTableSize(const FOceanBakeHeader& Header);
+
+	FORCEINLINE int32 GetOceanBakeChunkIndex(int32 Frame, EOceanBakeChunk Chunk)
+	{
+		return Frame * OCEAN_BAKE_CHUNKS_PER_FRAME + StaticCast<int32>(Chunk);
+	}
+
+	// Encodes and optionally compresses the texels of one chunk, OutRawSize receives the size before compression
+	FFTOCEAN_API void EncodeOceanBakeChunk(const FOceanBakeHeader& Header, const TArray<FVector4>& Texels, TArray<uint8>& OutChunk, uint32& OutRawSize);
+
+	// Decodes a chunk as read from the file into half float texels, ready to upload to a PF_FloatRGBA texture.
+	// Compressed chunks are inflated into DecompressedData first; both arrays keep their allocation across calls.
+	FFTOCEAN_API bool DecodeOceanBakeChunk(const FOceanBakeHeader& Header, const FOceanBakeChunkEntry& Entry, const uint8* StoredData, TArray<uint8>& DecompressedData, TArray<FFloat16Color>& OutTexels);
+}
+
+// Writes a baked stream frame by frame, the index table is filled in once the last frame is written
+class FFTOCEAN_API FOceanBakeWriter final
+{
+public:
+
+	FOceanBakeWriter();
+	~FOceanBakeWriter();
+
+	bool Open(const FString& Filename, const FOceanBakeHeader& InHeader);
+	bool WriteFrame(const TArray<FVector4>& Displacement, const TArray<FVector4>& Normal);
+	bool Close();
+
+private:
+
+	FOceanBakeHeader             Header;
+	TUniquePtr<FArchive>         Archive;
+	TArray<FOceanBakeChunkEntry> ChunkEntries;
+
+	bool WriteChunk(const TArray<FVector4>& Texels);
+};
+
+// Synchronous reader, every frame is decoded independently of the others
+class FFTOCEAN_API FOceanBakeReader final
+{
+public:
+
+	bool Open(const FString& Filename);
+
+	// Closes the file, the header and frame index table stay available
+	void Close();
+
+	bool ReadFrame(int32 Frame, TArray<FFloat16Color>& OutDisplacement, TArray<FFloat16Color>& OutNormal);
+
+	FORCEINLINE const FOceanBakeHeader& GetHeader() const
+	{
+		return Header;
+	}
+
+	FORCEINLINE const FOceanBakeChunkEntry& GetChunkEntry(int32 Frame, EOceanBakeChunk Chunk) const
+	{
+		return ChunkEntries[FFTOcean::GetOceanBakeChunkIndex(Frame, Chunk)];
+	}
+
+private:
+
+	FOceanBakeHeader             Header;
+	TUniquePtr<IFileHandle>      FileHandle;
+	TArray<FOceanBakeChunkEntry> ChunkEntries;
+	TArray<uint8>                StoredData;
+	TArray<uint8>                DecompressedData;
+
+	bool ReadChunk(int32 Frame, EOceanBakeChunk Chunk, TArray<FFloat16Color>& OutTexels);
+};
\ No newline at end of file
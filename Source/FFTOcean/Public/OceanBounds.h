@@ -0,0 +1,41 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace FFTOcean
+{
+	// Headroom added on top of the max displacement so small wave changes don't invalidate bounds every frame
+	constexpr float DisplacementPaddingHeadroom = 1.25f;
+
+	// Padding is only shrunk once it is this many times larger than the padding the displacement needs
+	constexpr float DisplacementPaddingShrinkRatio = 2.0f;
+
+	inline FVector GetDisplacementPadding(const FVector& MaxDisplacement)
+	{
+		return MaxDisplacement.GetAbs() * DisplacementPaddingHeadroom;
+	}
+
+	inline bool IsDisplacementPaddingOutdated(const FVector& Padding, const FVector& MaxDisplacement)
+	{
+		const FVector Required = MaxDisplacement.GetAbs();
+
+		bool bOutdated = false;
+
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			bOutdated |= Required[Axis] > Padding[Axis];
+			bOutdated |= Required[Axis] * DisplacementPaddingHeadroom * DisplacementPaddingShrinkRatio < Padding[Axis];
+		}
+
+		return bOutdated;
+	}
+
+	// Vertices are displaced by the ocean surface on the GPU, so any bounds built from the flat geometry must be padded.
+	// The displacement is in local space and scaled along with the geometry, by at most its largest axis scale.
+	inline FBoxSphereBounds ExpandBoundsByDisplacement(const FBoxSphereBounds& Bounds, const FVector& Displacement, const FTransform& LocalToWorld)
+	{
+		return FBoxSphereBounds(Bounds.GetBox().ExpandBy(Displacement.GetAbs() * LocalToWorld.GetMaximumAxisScale()));
+	}
+}
@@ -0,0 +1,113 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FFTOceanRenderer.h"
+
+namespace FFTOcean
+{
+	// Mirrors of the shader constants in Common.ush
+	constexpr float PatchLength = 1000.0f;
+	constexpr float Gravity = 981.0f;
+}
+
+struct FOceanCpuSimulationConfig
+{
+	// Square and a power of two, like the GPU transform
+	int32     Size;
+	float     WaveAmplitude;
+	FVector2D WindSpeed;
+	float     NormalStrength;
+	bool      bAnalyticNormals;
+	float     LoopPeriod;
+
+	FOceanCpuSimulationConfig() :
+		Size(256),
+		WaveAmplitude(0),
+		WindSpeed(FVector2D::ZeroVector),
+		NormalStrength(1),
+		bAnalyticNormals(false),
+		LoopPeriod(0)
+	{
+	}
+
+	// Takes the simulation settings of a render config, its texture width is used as the size
+	static FFTOCEAN_API FOceanCpuSimulationConfig FromRenderConfig(const FOceanRenderConfig& Config);
+};
+
+namespace FFTOcean
+{
+	// Wave vector of spectrum texel (X, Y), not centered, like the shaders evolve the spectrum with.
+	// Slopes center it first, see FOceanCpuSimulation::ComputeFourierComponents.
+	FORCEINLINE FVector2D GetWaveVector(int32 X, int32 Y)
+	{
+		return FVector2D(X, Y) * (2 * PI / PatchLength);
+	}
+
+	// Real parts of h0(k) and h0(-k) at spectrum texel (X, Y), the only parts the Fourier component shader reads
+	FFTOCEAN_API FVector2D GetPhillipsAmplitudes(const FOceanCpuSimulationConfig& Config, int32 X, int32 Y);
+
+	// Angular frequency of a wave vector, snapped to the loop frequency like the Fourier component shader
+	FFTOCEAN_API float GetWaveOmega(const FVector2D& K, float LoopPeriod);
+
+	// Displacement the surface of Config stays within for all but rare crests, from the variance of its spectrum.
+	// Bounds start from it until the GPU wave statistics come in.
+	FFTOCEAN_API FVector EstimateMaxDisplacement(const FOceanRenderConfig& Config);
+}
+
+// CPU implementation of the ocean pass chain, for places without an RHI such as commandlets.
+// It follows the shaders step by step, so its maps match the GPU maps up to float precision.
+class FFTOCEAN_API FOceanCpuSimulation final
+{
+public:
+
+	explicit FOceanCpuSimulation(const FOceanCpuSimulationConfig& InConfig);
+
+	// Fills the displacement and normal maps for the given time, both laid out like the render targets
+	void Simulate(float Time);
+
+	FORCEINLINE const FOceanCpuSimulationConfig& GetConfig() const
+	{
+		return Config;
+	}
+
+	// XYZ displacement and the Jacobian of the horizontal displacement in W
+	FORCEINLINE const TArray<FVector4>& GetDisplacementMap() const
+	{
+		return DisplacementMap;
+	}
+
+	FORCEINLINE const TArray<FVector4>& GetNormalMap() const
+	{
+		return NormalMap;
+	}
+
+private:
+
+	FOceanCpuSimulationConfig Config;
+	int32                     StageCount;
+
+	// The Fourier component shader only reads the real parts of h0(k) and h0(-k)
+	TArray<FVector2D> PhillipsFourier;
+
+	TArray<int32>     BitReversedIndices;
+	TArray<FVector2D> TwiddleFactors;
+
+	// Hermitian spectra, X and Y displacement share one transform like the slopes do
+	TArray<FVector2D> SpectrumXY;
+	TArray<FVector2D> SpectrumZ;
+	TArray<FVector2D> SpectrumJacobian;
+	TArray<FVector2D> SpectrumSlope;
+
+	TArray<FVector4> DisplacementMap;
+	TArray<FVector4> NormalMap;
+
+	void ComputePhillipsFourier();
+	void ComputeFourierComponents(float Time);
+	void ComputeSurfaceSpectrum(int32 X, int32 Y, float Time, FVector2D& OutX, FVector2D& OutY, FVector2D& OutZ) const;
+	void InverseTransform(TArray<FVector2D>& Spectrum) const;
+	void InverseTransformLine(FVector2D* Line, int32 Stride) const;
+	void ComputeSurfaceDisplacement();
+	void ComputeSurfaceNormal();
+};
\ No newline at end of file
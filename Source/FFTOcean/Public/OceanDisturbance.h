@@ -0,0 +1,68 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "OceanDisturbance.generated.h"
+
+// Disturbances splatted in one frame, any further ones are dropped until the next frame
+#define OCEAN_MAX_DISTURBANCE_COUNT 4096
+
+// A local bump of the surface swept along a segment, added on top of the simulated waves for a single frame.
+// Locations are in ocean patch space: the patch repeats every FFTOcean::PatchLength units, like the displacement map.
+USTRUCT(BlueprintType)
+struct FOceanDisturbance
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector2D Start;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector2D End;
+
+	// Distance from the segment the disturbance falls off to zero over
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0))
+	float Radius;
+
+	// Height added at End, negative values push the surface down
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Amplitude;
+
+	// Amplitude scale at Start, the amplitude is blended linearly along the segment
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0, ClampMax = 1))
+	float StartAmplitudeScale;
+
+	FOceanDisturbance() :
+		Start(FVector2D::ZeroVector),
+		End(FVector2D::ZeroVector),
+		Radius(0),
+		Amplitude(0),
+		StartAmplitudeScale(1)
+	{
+	}
+
+	// Splash or explosion centered on Center
+	static FOceanDisturbance MakeRadialImpulse(const FVector2D& Center, float Radius, float Amplitude)
+	{
+		FOceanDisturbance Disturbance;
+		Disturbance.Start = Center;
+		Disturbance.End = Center;
+		Disturbance.Radius = Radius;
+		Disturbance.Amplitude = Amplitude;
+		return Disturbance;
+	}
+
+	// Trail from Start to End, fading out towards Start where the wake is oldest
+	static FOceanDisturbance MakeWake(const FVector2D& Start, const FVector2D& End, float Width, float Amplitude)
+	{
+		FOceanDisturbance Disturbance;
+		Disturbance.Start = Start;
+		Disturbance.End = End;
+		Disturbance.Radius = Width * 0.5f;
+		Disturbance.Amplitude = Amplitude;
+		Disturbance.StartAmplitudeScale = 0;
+		return Disturbance;
+	}
+};
\ No newline at end of file
@@ -0,0 +1,44 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FFTOceanRenderer.h"
+
+#include "OceanFlipbook.generated.h"
+
+USTRUCT(BlueprintType)
+struct FOceanFlipbookBakeSettings
+{
+	GENERATED_BODY()
+
+	// Frames baked over one LoopPeriod, playback blends between neighbouring frames
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 2, ClampMax = 256))
+	int32 FrameCount;
+
+	// Content folder the flipbooks are saved to, e.g. /Game/Ocean
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FString PackagePath;
+
+	// Suffixed with _Displacement and _Normal
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FString AssetName;
+
+	FOceanFlipbookBakeSettings() :
+		FrameCount(32),
+		PackagePath(TEXT("/Game/Ocean")),
+		AssetName(TEXT("OceanFlipbook"))
+	{
+	}
+};
+
+namespace FFTOcean
+{
+	// Renders one loop period of a looping ocean and saves every frame of the displacement and normal maps into
+	// texture array assets. Editor only, blocks until the GPU has finished every frame.
+	FFTOCEAN_API bool BakeOceanFlipbook(
+		const FOceanRenderConfig& Config,
+		const FOceanFlipbookBakeSettings& Settings,
+		class UTexture2DArray*& OutDisplacementFlipbook,
+		class UTexture2DArray*& OutNormalFlipbook);
+}
\ No newline at end of file
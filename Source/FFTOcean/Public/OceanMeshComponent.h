@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Components/StaticMeshComponent.h"
+#include "OceanSimulationDriver.h"
 #include "OceanMeshComponent.generated.h"
 
 /**
@@ -16,19 +17,72 @@ class FFTOCEAN_API UOceanMeshComponent : public UStaticMeshComponent
 
 public:
 
+	// Largest absolute displacement the surface applies to the mesh vertices, used to pad the component bounds.
+	// Kept up to date from the GPU wave statistics once they are available.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Ocean Geometry")
+	FVector MaxDisplacement;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ocean Rendering")
 	FOceanRenderConfig RenderConfig;
 
+	// When the simulation runs, slows down or stops entirely
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ocean Rendering")
+	FOceanSimulationPolicy SimulationPolicy;
+
 	UPROPERTY(EditInstanceOnly, BlueprintReadWrite, Category = "Ocean Rendering Debug")
 	FOceanDebugConfig DebugConfig;
 
+	UPROPERTY(EditAnywhere, Category = "Ocean Flipbook")
+	FOceanFlipbookBakeSettings FlipbookBakeSettings;
+
 public:
 
 	UOceanMeshComponent(const FObjectInitializer& ObjectInitializer);
 
+	UFUNCTION(BlueprintCallable)
+	void SetMaxDisplacement(const FVector& InMaxDisplacement);
+
+	// Bakes one LoopPeriod of the current ocean into flipbook assets, then plays them back instead of simulating
+	UFUNCTION(CallInEditor, Category = "Ocean Flipbook")
+	void BakeFlipbook();
+
+	// Blends the waves into a new sea state over TransitionTime seconds of simulation time
+	UFUNCTION(BlueprintCallable)
+	void TransitionSeaState(float WaveAmplitude, float WindVelocity, float WindDirection, float TransitionTime);
+
+	// Splash or explosion for the next simulated frame, Center is in ocean patch space. Safe to call from any thread.
+	UFUNCTION(BlueprintCallable)
+	void AddRadialImpulse(FVector2D Center, float Radius, float Amplitude);
+
+	// Wake trail for the next simulated frame, fading out towards Start. Safe to call from any thread.
+	UFUNCTION(BlueprintCallable)
+	void AddWake(FVector2D Start, FVector2D End, float Width, float Amplitude);
+
+	// Sea state of the last frame the GPU has finished, without sampling any texture
+	UFUNCTION(BlueprintCallable)
+	FOceanWaveStatistics GetWaveStatistics() const;
+
+	// Builds everything the simulation needs ahead of its first frame, for loading screens or oceans added by a
+	// streamed level. Game thread only, while the component is not ticking.
+	UFUNCTION(BlueprintCallable)
+	void WarmUp();
+
+	// Latest CPU copy of the surface, set RenderConfig.bReadbackSurface to have one. Safe to call from any thread.
+	FOceanSnapshotRef GetSurfaceSnapshot() const;
+
+	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+
+	virtual void OnRegister() override;
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
 protected:
 
-	TUniquePtr<FFFTOceanRenderer> OceanRenderer;
+	virtual void RegisterComponentTickFunctions(bool bRegister) override;
+
+	FOceanSimulationDriver SimulationDriver;
+
+	// Bounds padding, only grown or shrunk when MaxDisplacement moves out of its hysteresis range
+	FVector DisplacementPadding;
 };
@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/EngineTypes.h"
+#include "OceanPlaybackComponent.generated.h"
+
+/**
+ * Plays back an ocean baked by the OceanBake commandlet into the displacement and normal maps, without simulating.
+ */
+UCLASS(hidecategories = (Object), editinlinenew, meta = (BlueprintSpawnableComponent), ClassGroup = Rendering, DisplayName = "OceanPlaybackComponent")
+class FFTOCEAN_API UOceanPlaybackComponent : public UStaticMeshComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	// Largest absolute displacement of the baked surface, used to pad the component bounds
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Ocean Geometry")
+	FVector MaxDisplacement;
+
+	// Baked stream, relative to the project directory
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Ocean Playback", meta = (FilePathFilter = "obake"))
+	FFilePath BakeFile;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ocean Playback", meta = (ClampMin = 0))
+	float PlaybackRate;
+
+	// Wrap around to the first frame instead of holding the last one
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ocean Playback")
+	bool bLoop;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Ocean Playback")
+	class UTextureRenderTarget2D* DisplacementMap;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Ocean Playback")
+	class UTextureRenderTarget2D* NormalMap;
+
+public:
+
+	UOceanPlaybackComponent(const FObjectInitializer& ObjectInitializer);
+
+	// Seconds into the baked sequence, the same time always shows the same surface
+	UFUNCTION(BlueprintCallable)
+	void SetPlaybackTime(float InPlaybackTime);
+
+	UFUNCTION(BlueprintCallable)
+	float GetPlaybackTime() const;
+
+	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+
+	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+protected:
+
+	float PlaybackTime;
+
+	TUniquePtr<class FOceanBakeStream> BakeStream;
+
+	// Shared with the render commands in flight, only ever released on the render thread
+	TSharedPtr<class FOceanPlaybackProxy, ESPMode::ThreadSafe> PlaybackProxy;
+
+	void OpenBakeStream();
+	void CloseBakeStream();
+};
\ No newline at end of file
@@ -0,0 +1,96 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FOceanSurfaceSnapshot;
+
+struct FOceanRay
+{
+	FVector Origin;
+
+	// Doesn't need to be normalized, distances are measured along the normalized direction
+	FVector Direction;
+	float   MaxDistance;
+};
+
+struct FOceanRaycastHit
+{
+	bool    bHit;
+	float   Distance;
+	FVector Location;
+
+	FOceanRaycastHit() :
+		bHit(false),
+		Distance(0),
+		Location(FVector::ZeroVector)
+	{
+	}
+};
+
+// Min/max height mip pyramid over one snapshot of the displaced surface, for CPU ray casts.
+// Rays are in patch space with Z up, the patch repeats forever along X and Y.
+class FFTOCEAN_API FOceanHeightPyramid final
+{
+public:
+
+	explicit FOceanHeightPyramid(const FOceanSurfaceSnapshot& Snapshot);
+
+	// A ray starting under the surface hits it at distance zero
+	bool RaycastOcean(const FVector& Origin, const FVector& Direction, float MaxDistance, FOceanRaycastHit& OutHit) const;
+
+	// Traces every ray in parallel, OutHits must be as long as Rays
+	void RaycastOcean(TArrayView<const FOceanRay> Rays, TArrayView<FOceanRaycastHit> OutHits) const;
+
+	// Simulation time of the snapshot the pyramid was built from
+	FORCEINLINE float GetTime() const
+	{
+		return Time;
+	}
+
+private:
+
+	struct FHeightRange
+	{
+		float Min;
+		float Max;
+	};
+
+	struct FLevel
+	{
+		int32                Width;
+		int32                Height;
+		// Patch space size of one cell
+		FVector2D            CellLength;
+		TArray<FHeightRange> Ranges;
+	};
+
+	float     Time;
+	int32     Width;
+	int32     Height;
+	FVector2D TexelLength;
+
+	// Surface heights resampled at the texel locations, with the horizontal displacement already inverted
+	TArray<float> Heights;
+
+	// Level 0 bounds the bilinear patch between four neighbouring texels, each further level halves the cell count
+	TArray<FLevel> Levels;
+
+	FORCEINLINE float GetTexelHeight(int32 X, int32 Y) const
+	{
+		return Heights[(Y & (Height - 1)) * Width + (X & (Width - 1))];
+	}
+
+	FORCEINLINE const FHeightRange& GetRange(const FLevel& Level, int32 X, int32 Y) const
+	{
+		return Level.Ranges[(Y & (Level.Height - 1)) * Level.Width + (X & (Level.Width - 1))];
+	}
+
+	void BuildLevels();
+
+	float SampleHeight(const FVector2D& Location) const;
+
+	// Bilinear intersection of the ray with one level 0 cell between two ray distances
+	bool IntersectCell(int32 CellX, int32 CellY, const FVector& Origin, const FVector& Direction, float EnterDistance, float ExitDistance, float& OutDistance) const;
+};
\ No newline at end of file
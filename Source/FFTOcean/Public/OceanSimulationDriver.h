@@ -0,0 +1,111 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "FFTOceanRenderer.h"
+#include "OceanSimulationPolicy.h"
+#include "OceanFlipbook.h"
+
+// Game thread half of an ocean component tick, a prerequisite of the component tick which may run on any thread
+struct FOceanGameThreadTickFunction : public FTickFunction
+{
+	class FOceanSimulationDriver* Driver;
+
+	FOceanGameThreadTickFunction() :
+		Driver(nullptr)
+	{
+	}
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+// Simulation of an ocean component: its renderer, throttle and resolution budget, plus the warm up, sea state,
+// disturbance and readback calls every ocean component exposes. Each component owns one and forwards to it.
+class FFTOCEAN_API FOceanSimulationDriver final
+{
+public:
+
+	// Applies a measured maximum displacement to the bounds of the component, game thread only
+	typedef TFunction<void(const FVector&)> FMaxDisplacementSetter;
+
+	// Copies further properties of the component its own tick reads, on the game thread along with the driver copies
+	typedef TFunction<void()> FTickPropertiesCopier;
+
+	FOceanSimulationDriver();
+	~FOceanSimulationDriver();
+
+	// From OnRegister, with the properties of the component the simulation follows. Picks the thread the component
+	// ticks on and forgets previous decisions, so the next tick simulates.
+	void Register(
+		class UPrimitiveComponent* InComponent,
+		const FOceanRenderConfig& InRenderConfig,
+		const FOceanDebugConfig& InDebugConfig,
+		const FOceanSimulationPolicy& InSimulationPolicy,
+		FMaxDisplacementSetter InSetMaxDisplacement,
+		FTickPropertiesCopier InCopyTickProperties = FTickPropertiesCopier());
+
+	// From RegisterComponentTickFunctions, after Register
+	void RegisterTickFunction(bool bRegister);
+
+	// From BeginPlay, warms the simulation up unless the policy says otherwise
+	void BeginPlay();
+
+	// From EndPlay, gives the render targets resized for the GPU budget back their authored size
+	void EndPlay();
+
+	// Game thread only, while the component is not ticking
+	void WarmUp();
+
+	// From TickComponent, returns true when the simulation ran. Only reads the copies the game thread tick made.
+	bool Tick(float DeltaTime);
+
+	// Reads the surface back whatever the config says, for components that displace their vertices on the CPU
+	FORCEINLINE void SetForceSurfaceReadback(bool bForce)
+	{
+		bForceSurfaceReadback = bForce;
+	}
+
+	void AddRadialImpulse(FVector2D Center, float Radius, float Amplitude);
+	void AddWake(FVector2D Start, FVector2D End, float Width, float Amplitude);
+
+	FOceanWaveStatistics GetWaveStatistics() const;
+	FOceanSnapshotRef GetSurfaceSnapshot() const;
+
+	static void TransitionSeaState(FOceanRenderConfig& Config, float WaveAmplitude, float WindVelocity, float WindDirection, float TransitionTime);
+
+	// Bakes the flipbooks and switches Config of Owner over to them
+	static void BakeFlipbook(UObject* Owner, FOceanRenderConfig& Config, const FOceanFlipbookBakeSettings& Settings);
+
+private:
+
+	friend struct FOceanGameThreadTickFunction;
+
+	class UPrimitiveComponent*    Component;
+	const FOceanRenderConfig*     RenderConfig;
+	const FOceanDebugConfig*      DebugConfig;
+	const FOceanSimulationPolicy* SimulationPolicy;
+	FMaxDisplacementSetter        SetMaxDisplacement;
+	FTickPropertiesCopier         CopyComponentTickProperties;
+
+	// Copies of the component properties for the tick, taken on the game thread ahead of it so that Blueprint writes
+	// to the properties never race an any thread tick. The render config is the one the GPU budget resized.
+	FOceanRenderConfig     TickRenderConfig;
+	FOceanDebugConfig      TickDebugConfig;
+	FOceanSimulationPolicy TickSimulationPolicy;
+
+	FOceanGameThreadTickFunction GameThreadTickFunction;
+
+	TUniquePtr<FFFTOceanRenderer> OceanRenderer;
+
+	FOceanSimulationThrottle   SimulationThrottle;
+	FOceanResolutionController ResolutionController;
+
+	bool bForceSurfaceReadback;
+
+	// Copies the properties for the next tick and moves the bounds to the latest wave statistics
+	void TickGameThread();
+	void CopyTickProperties();
+};
\ No newline at end of file
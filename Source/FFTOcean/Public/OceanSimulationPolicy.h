@@ -0,0 +1,139 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+#include "OceanSimulationPolicy.generated.h"
+
+USTRUCT(BlueprintType)
+struct FOceanSimulationPolicy
+{
+	GENERATED_BODY()
+
+	// Skip the simulation while the ocean has not been on screen for RenderedTimeTolerance seconds
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bSkipWhenNotRendered;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0))
+	float RenderedTimeTolerance;
+
+	// Closest view distance to the ocean bounds below which the simulation runs every tick
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0))
+	float FullRateDistance;
+
+	// View distance from which the simulation runs at MinUpdateRate, the rate is blended in between
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0))
+	float MinRateDistance;
+
+	// Simulations per second at MinRateDistance and beyond
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0.1))
+	float MinUpdateRate;
+
+	// Stop the simulation clock while the game is paused, instead of following real time
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bFreezeWhenPaused;
+
+	// Simulate a single frame in editor worlds when no viewport is realtime
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bRenderOnceInNonRealtimeViewports;
+
+	// View distance beyond which the ocean renders its Gerstner waves instead of the transform, zero never switches
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0))
+	float GerstnerDistance;
+
+	// Build the GPU resources and spectra on BeginPlay instead of on the first simulated frame
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bWarmUpOnBeginPlay;
+
+	FOceanSimulationPolicy() :
+		bSkipWhenNotRendered(true),
+		RenderedTimeTolerance(0.5f),
+		FullRateDistance(20000),
+		MinRateDistance(200000),
+		MinUpdateRate(10),
+		bFreezeWhenPaused(true),
+		bRenderOnceInNonRealtimeViewports(true),
+		GerstnerDistance(0),
+		bWarmUpOnBeginPlay(true)
+	{
+	}
+};
+
+// Decides on every tick whether a component runs its simulation, and keeps the clock the simulation is sampled at
+class FFTOCEAN_API FOceanSimulationThrottle
+{
+public:
+
+	FOceanSimulationThrottle();
+
+	// Forget previous decisions, so the next tick always simulates
+	void Reset();
+
+	// Advances the simulation clock and returns true when the component should simulate this tick
+	bool Advance(const class UPrimitiveComponent* Component, const FOceanSimulationPolicy& Policy, float DeltaTime);
+
+	FORCEINLINE float GetSimulationTime() const
+	{
+		return SimulationTime;
+	}
+
+	// Whether the last simulated tick should render the Gerstner waves, from the view distance or the scalability settings
+	bool IsFarField() const;
+
+private:
+
+	float SimulationTime;
+	float TimeSinceSimulation;
+	bool  bHasSimulated;
+	bool  bFarField;
+
+	void UpdateFarField(const FOceanSimulationPolicy& Policy, float ViewDistance);
+
+	static float GetClosestViewDistance(const class UPrimitiveComponent* Component);
+	static float GetUpdateInterval(const FOceanSimulationPolicy& Policy, float ViewDistance);
+};
+
+// Steps the transform resolution of a component between power of two sizes to keep its GPU time within r.FFTOcean.GPUBudgetMs
+class FFTOCEAN_API FOceanResolutionController
+{
+public:
+
+	FOceanResolutionController();
+	~FOceanResolutionController();
+
+	// Forget the measurements, the next tick starts again from the configured resolution
+	void Reset();
+
+	// Overrides the resolution of Config and sizes its render targets to match, only in game worlds with a budget set.
+	// Width, height and the target sizes all scale from their authored values by the same power of two.
+	// Far field, Gerstner and flipbook oceans keep the last resolution, they do not run the transform being measured.
+	// Gerstner and flipbook oceans also keep their render targets at the authored size.
+	// Render targets another controller already resizes are left alone, along with the resolution. Game thread only.
+	void Apply(const class UWorld* World, struct FOceanRenderConfig& Config, const class FFFTOceanRenderer& Renderer, bool bFarField);
+
+	// Gives the render targets back the size they had before the first resize, from EndPlay. Game thread only.
+	void RestoreTargets();
+
+private:
+
+	struct FResizedTarget
+	{
+		TWeakObjectPtr<class UTextureRenderTarget2D> Target;
+		FIntPoint                                    AuthoredSize;
+	};
+
+	int32 Size;
+	float SmoothedGpuTime;
+	float LastSwitchTime;
+
+	// Render targets claimed by this controller, no other controller resizes them until they are restored
+	TArray<FResizedTarget> ResizedTargets;
+
+	int32 ChooseSize(float BudgetMs, int32 MinSize, int32 MaxSize) const;
+
+	bool ClaimTargets(const struct FOceanRenderConfig& Config);
+	// Scales the authored size of each claimed render target by 2^SizeShift
+	void ResizeTargets(int32 SizeShift);
+};
\ No newline at end of file
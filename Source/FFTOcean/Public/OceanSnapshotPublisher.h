@@ -0,0 +1,83 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Atomic.h"
+#include "OceanSurfaceSnapshot.h"
+
+// One buffer published, one for the producer to fill, one for readers still holding an older snapshot
+#define OCEAN_SNAPSHOT_BUFFER_COUNT 3
+
+class FOceanSnapshotPublisher;
+
+// Reader reference to a published snapshot. The snapshot can't change or go away while any reference to it is alive.
+class FFTOCEAN_API FOceanSnapshotRef final
+{
+public:
+
+	FOceanSnapshotRef();
+	FOceanSnapshotRef(const FOceanSnapshotRef& Other);
+	FOceanSnapshotRef(FOceanSnapshotRef&& Other);
+	~FOceanSnapshotRef();
+
+	FOceanSnapshotRef& operator=(const FOceanSnapshotRef& Other);
+	FOceanSnapshotRef& operator=(FOceanSnapshotRef&& Other);
+
+	FORCEINLINE bool IsValid() const
+	{
+		return BufferIndex != INDEX_NONE;
+	}
+
+	const FOceanSurfaceSnapshot& Get() const;
+
+	FORCEINLINE const FOceanSurfaceSnapshot* operator->() const
+	{
+		return &Get();
+	}
+
+	void Reset();
+
+private:
+
+	friend class FOceanSnapshotPublisher;
+
+	FOceanSnapshotRef(const TSharedRef<const FOceanSnapshotPublisher, ESPMode::ThreadSafe>& InPublisher, int32 InBufferIndex);
+
+	TSharedPtr<const FOceanSnapshotPublisher, ESPMode::ThreadSafe> Publisher;
+	int32                                                          BufferIndex;
+};
+
+// Hands surface snapshots from one producer, a GPU readback or a CPU simulation, to readers on any thread.
+// Neither side ever takes a lock: the producer fills a buffer no reader holds and publishes it with an atomic store,
+// readers pin the published buffer with an atomic reader count. Must be created with MakeShared.
+class FFTOCEAN_API FOceanSnapshotPublisher final : public TSharedFromThis<FOceanSnapshotPublisher, ESPMode::ThreadSafe>
+{
+public:
+
+	FOceanSnapshotPublisher();
+
+	// Only one thread may publish at a time. Returns false and drops the snapshot when readers hold every spare buffer.
+	bool Publish(FOceanSurfaceSnapshot&& Snapshot);
+
+	// Latest published snapshot, invalid until the first one is published. Safe to call from any thread.
+	FOceanSnapshotRef Acquire() const;
+
+private:
+
+	friend class FOceanSnapshotRef;
+
+	struct FBuffer
+	{
+		TOptional<FOceanSurfaceSnapshot> Snapshot;
+		mutable TAtomic<int32>           ReaderCount;
+
+		FBuffer() :
+			ReaderCount(0)
+		{
+		}
+	};
+
+	FBuffer        Buffers[OCEAN_SNAPSHOT_BUFFER_COUNT];
+	TAtomic<int32> PublishedIndex;
+};
\ No newline at end of file
@@ -0,0 +1,71 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "OceanCpuSimulation.h"
+
+// How far a truncated sum of waves may be from the full spectrum, in height units
+struct FOceanSparseWaveError
+{
+	// Worst case absolute height error, the sum of the dropped wave amplitudes
+	float MaxHeightError;
+
+	// Root mean square height error over the patch and over time
+	float RmsHeightError;
+
+	// Share of the spectrum energy carried by the kept waves, in [0, 1]
+	float EnergyFraction;
+};
+
+// One kept spectrum component. Its height is A * cos(k.x + wt) + B * cos(k.x - wt), already scaled like the inverse transform.
+struct FOceanSparseWave
+{
+	// Centered wave vector, equal to the shader one on the texel grid and smooth in between
+	FVector2D WaveVector;
+
+	// Horizontal displacement direction, the shader takes it from the wave vector before centering
+	FVector2D Direction;
+
+	float Omega;
+	float A;
+	float B;
+};
+
+namespace FFTOcean
+{
+	// Weights of a wave at one time, its displacement along each axis is OutCos * cos(k.x) + OutSin * sin(k.x)
+	FFTOCEAN_API void GetSparseWaveWeights(const FOceanSparseWave& Wave, float Time, FVector& OutCos, FVector& OutSin);
+}
+
+// Evaluates the K most energetic waves of the same spectrum the GPU transforms, at any point and any time.
+// Closed form in time, so past and future timestamps are exact, which makes it fit for servers and lag compensation.
+class FFTOCEAN_API FOceanSparseWaveEvaluator final
+{
+public:
+
+	FOceanSparseWaveEvaluator(const FOceanCpuSimulationConfig& InConfig, int32 WaveCount);
+
+	FORCEINLINE const FOceanSparseWaveError& GetTruncationError() const
+	{
+		return TruncationError;
+	}
+
+	// Kept waves, most energetic first
+	FORCEINLINE const TArray<FOceanSparseWave>& GetWaves() const
+	{
+		return Waves;
+	}
+
+	// Displacement at patch space locations, four locations at a time in SIMD registers
+	void EvaluateDisplacements(float Time, TArrayView<const FVector2D> Locations, TArrayView<FVector> OutDisplacements) const;
+
+	// Height of the displaced surface at patch space locations, with the horizontal displacement inverted
+	void EvaluateHeights(float Time, TArrayView<const FVector2D> Locations, TArrayView<float> OutHeights) const;
+
+private:
+
+	FOceanCpuSimulationConfig Config;
+	TArray<FOceanSparseWave>  Waves;
+	FOceanSparseWaveError     TruncationError;
+};
\ No newline at end of file
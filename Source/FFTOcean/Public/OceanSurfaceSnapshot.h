@@ -0,0 +1,84 @@
+// Copyright 1998-2019 Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FOceanCpuSimulation;
+
+// Warm start state of QueryWaterHeights, keep one per set of points queried every frame.
+// The surface moves little between frames, so the last solution is a close first guess.
+struct FOceanHeightQueryHandle
+{
+	// Undisplaced location minus queried location of every point, reset whenever the point count changes
+	TArray<FVector2D> SourceOffsets;
+};
+
+// CPU copy of one frame of the displacement map, for queries that can't sample the GPU textures.
+// Texels are laid out like the render target: row major, texel (X, Y) displaces the patch location (X, Y) * texel length.
+class FFTOCEAN_API FOceanSurfaceSnapshot final
+{
+public:
+
+	FOceanSurfaceSnapshot(int32 InWidth, int32 InHeight, float InTime, TArray<FVector>&& InDisplacement);
+
+	static FOceanSurfaceSnapshot FromCpuSimulation(const FOceanCpuSimulation& Simulation, float Time);
+
+	// Texels as read back from a PF_FloatRGBA displacement map
+	static FOceanSurfaceSnapshot FromHalfTexels(int32 Width, int32 Height, float Time, TArrayView<const FFloat16Color> Texels);
+
+	FORCEINLINE int32 GetWidth() const
+	{
+		return Width;
+	}
+
+	FORCEINLINE int32 GetHeight() const
+	{
+		return Height;
+	}
+
+	// Simulation time the displacement was computed for
+	FORCEINLINE float GetTime() const
+	{
+		return Time;
+	}
+
+	FORCEINLINE const FVector2D& GetTexelLength() const
+	{
+		return TexelLength;
+	}
+
+	FORCEINLINE const TArray<FVector>& GetDisplacement() const
+	{
+		return Displacement;
+	}
+
+	FORCEINLINE const FVector& GetTexelDisplacement(int32 X, int32 Y) const
+	{
+		return Displacement[(Y & (Height - 1)) * Width + (X & (Width - 1))];
+	}
+
+	// Bilinear displacement at a patch space location, wrapping around the patch
+	FVector SampleDisplacement(const FVector2D& Location) const;
+
+	// Height of the displaced surface at a patch space location. The waves move the surface sideways, so this
+	// searches for the undisplaced location whose displacement lands on Location instead of reading Z there.
+	float SampleHeight(const FVector2D& Location) const;
+
+	// SampleHeight for many points, four at a time in SIMD registers. Iterations stop once every point of a group
+	// has converged, which usually takes one or two with a warm started handle.
+	void QueryWaterHeights(TArrayView<const FVector2D> Locations, TArrayView<float> OutHeights, FOceanHeightQueryHandle* Handle = nullptr) const;
+
+	// SampleDisplacement at four patch space locations, one per SIMD lane. Both arrays hold four 16 byte aligned floats.
+	void SampleDisplacementLanes(const float* LocationX, const float* LocationY, VectorRegister& OutX, VectorRegister& OutY, VectorRegister& OutZ) const;
+
+private:
+
+	int32           Width;
+	int32           Height;
+	float           Time;
+	FVector2D       TexelLength;
+	TArray<FVector> Displacement;
+
+	void QueryWaterHeightBatch(TArrayView<const FVector2D> Locations, TArrayView<float> OutHeights, FVector2D* SourceOffsets) const;
+};
\ No newline at end of file
@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "OceanSimulationDriver.h"
+#include "OceanTileComponent.generated.h"
+
+/**
+ * Draws the ocean as a grid of hierarchical instanced tiles. Every tile is culled on its own against bounds padded by
+ * the maximum surface displacement, so tiles behind the camera or occluded by terrain are dropped.
+ */
+UCLASS(hidecategories = (Object), editinlinenew, meta = (BlueprintSpawnableComponent), ClassGroup = Rendering, DisplayName = "OceanTileComponent")
+class FFTOCEAN_API UOceanTileComponent : public UHierarchicalInstancedStaticMeshComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 1, ClampMax = 256), Category = "Ocean Geometry")
+	int32 TileCountX;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 1, ClampMax = 256), Category = "Ocean Geometry")
+	int32 TileCountY;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0), Category = "Ocean Geometry")
+	float TileSizeX;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0), Category = "Ocean Geometry")
+	float TileSizeY;
+
+	// Largest absolute displacement the surface applies to tile vertices, used to pad the bounds of every tile.
+	// Kept up to date from the GPU wave statistics once they are available.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Ocean Geometry")
+	FVector MaxDisplacement;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ocean Rendering")
+	FOceanRenderConfig RenderConfig;
+
+	// When the simulation runs, slows down or stops entirely
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ocean Rendering")
+	FOceanSimulationPolicy SimulationPolicy;
+
+	UPROPERTY(EditInstanceOnly, BlueprintReadWrite, Category = "Ocean Rendering Debug")
+	FOceanDebugConfig DebugConfig;
+
+	UPROPERTY(EditAnywhere, Category = "Ocean Flipbook")
+	FOceanFlipbookBakeSettings FlipbookBakeSettings;
+
+public:
+
+	UOceanTileComponent(const FObjectInitializer& ObjectInitializer);
+
+	UFUNCTION(BlueprintCallable)
+	void InitOceanTiles();
+
+	UFUNCTION(BlueprintCallable)
+	void SetMaxDisplacement(const FVector& InMaxDisplacement);
+
+	// Bakes one LoopPeriod of the current ocean into flipbook assets, then plays them back instead of simulating
+	UFUNCTION(CallInEditor, Category = "Ocean Flipbook")
+	void BakeFlipbook();
+
+	// Blends the waves into a new sea state over TransitionTime seconds of simulation time
+	UFUNCTION(BlueprintCallable)
+	void TransitionSeaState(float WaveAmplitude, float WindVelocity, float WindDirection, float TransitionTime);
+
+	// Splash or explosion for the next simulated frame, Center is in ocean patch space. Safe to call from any thread.
+	UFUNCTION(BlueprintCallable)
+	void AddRadialImpulse(FVector2D Center, float Radius, float Amplitude);
+
+	// Wake trail for the next simulated frame, fading out towards Start. Safe to call from any thread.
+	UFUNCTION(BlueprintCallable)
+	void AddWake(FVector2D Start, FVector2D End, float Width, float Amplitude);
+
+	// Sea state of the last frame the GPU has finished, without sampling any texture
+	UFUNCTION(BlueprintCallable)
+	FOceanWaveStatistics GetWaveStatistics() const;
+
+	// Builds everything the simulation needs ahead of its first frame, for loading screens or oceans added by a
+	// streamed level. Game thread only, while the component is not ticking.
+	UFUNCTION(BlueprintCallable)
+	void WarmUp();
+
+	// Latest CPU copy of the surface, set RenderConfig.bReadbackSurface to have one. Safe to call from any thread.
+	FOceanSnapshotRef GetSurfaceSnapshot() const;
+
+	virtual void OnRegister() override;
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+protected:
+
+	virtual void RegisterComponentTickFunctions(bool bRegister) override;
+
+	FOceanSimulationDriver SimulationDriver;
+
+private:
+
+	// Tile layout and bounds padding the current cluster tree was built with
+	int32   BuiltTileCountX;
+	int32   BuiltTileCountY;
+	float   BuiltTileSizeX;
+	float   BuiltTileSizeY;
+	FVector BuiltDisplacementPadding;
+
+	bool IsOceanTilesOutdated() const;
+	bool IsDisplacementPaddingOutdated() const;
+
+	void BuildTileTree();
+};
@@ -4,9 +4,44 @@
 
 #include "CoreMinimal.h"
 #include "ProceduralMeshComponent.h"
-#include "FFTOceanRenderer.h"
+#include "OceanSimulationDriver.h"
 #include "ProceduralOceanComponent.generated.h"
 
+USTRUCT(BlueprintType)
+struct FOceanCpuDisplacementSettings
+{
+	GENERATED_BODY()
+
+	// Displace the mesh vertices on the CPU from surface snapshots, for materials that don't sample DisplacementMap.
+	// Forces RenderConfig.bReadbackSurface, so the mesh lags the GPU surface by the few frames of the readback.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bEnabled;
+
+	// Patches across the mesh UVs and scale of the sampled displacement, both matching the material lookup
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0))
+	float UVTiling;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector DisplacementScale;
+
+	// Cook the displaced sections as collision, asynchronously and once for all sections
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bCreateCollision;
+
+	// Seconds between two collision cooks, the rendered sections follow every snapshot in between
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0))
+	float CollisionUpdateInterval;
+
+	FOceanCpuDisplacementSettings() :
+		bEnabled(false),
+		UVTiling(1),
+		DisplacementScale(FVector::OneVector),
+		bCreateCollision(false),
+		CollisionUpdateInterval(0.2f)
+	{
+	}
+};
+
 /**
  *
  */
@@ -17,10 +52,10 @@ class FFTOCEAN_API UProceduralOceanComponent : public UProceduralMeshComponent
 
 public:
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 2, ClampMax = 256), Category = "Ocean Geometry")
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 2, ClampMax = 4096), Category = "Ocean Geometry")
 	int32 VertexCountX;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 2, ClampMax = 256), Category = "Ocean Geometry")
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 2, ClampMax = 4096), Category = "Ocean Geometry")
 	int32 VertexCountY;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0), Category = "Ocean Geometry")
@@ -29,12 +64,28 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0), Category = "Ocean Geometry")
 	float CellWidthY;
 
+	// Largest absolute displacement the surface applies to the mesh vertices, used to pad the component bounds.
+	// Kept up to date from the GPU wave statistics once they are available.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Ocean Geometry")
+	FVector MaxDisplacement;
+
+	// Changes of bEnabled and bCreateCollision take effect once the geometry is rebuilt
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ocean Geometry")
+	FOceanCpuDisplacementSettings CpuDisplacement;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ocean Rendering")
 	FOceanRenderConfig RenderConfig;
 
+	// When the simulation runs, slows down or stops entirely
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ocean Rendering")
+	FOceanSimulationPolicy SimulationPolicy;
+
 	UPROPERTY(EditInstanceOnly, BlueprintReadWrite, Category = "Ocean Rendering Debug")
 	FOceanDebugConfig DebugConfig;
 
+	UPROPERTY(EditAnywhere, Category = "Ocean Flipbook")
+	FOceanFlipbookBakeSettings FlipbookBakeSettings;
+
 
 public:
 
@@ -43,10 +94,119 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void InitOceanGeometry();
 
+	UFUNCTION(BlueprintCallable)
+	void SetMaxDisplacement(const FVector& InMaxDisplacement);
+
+	// Bakes one LoopPeriod of the current ocean into flipbook assets, then plays them back instead of simulating
+	UFUNCTION(CallInEditor, Category = "Ocean Flipbook")
+	void BakeFlipbook();
+
+	// Blends the waves into a new sea state over TransitionTime seconds of simulation time
+	UFUNCTION(BlueprintCallable)
+	void TransitionSeaState(float WaveAmplitude, float WindVelocity, float WindDirection, float TransitionTime);
+
+	// Splash or explosion for the next simulated frame, Center is in ocean patch space. Safe to call from any thread.
+	UFUNCTION(BlueprintCallable)
+	void AddRadialImpulse(FVector2D Center, float Radius, float Amplitude);
+
+	// Wake trail for the next simulated frame, fading out towards Start. Safe to call from any thread.
+	UFUNCTION(BlueprintCallable)
+	void AddWake(FVector2D Start, FVector2D End, float Width, float Amplitude);
+
+	// Sea state of the last frame the GPU has finished, without sampling any texture
+	UFUNCTION(BlueprintCallable)
+	FOceanWaveStatistics GetWaveStatistics() const;
+
+	// Builds everything the simulation needs ahead of its first frame, for loading screens or oceans added by a
+	// streamed level. Game thread only, while the component is not ticking.
+	UFUNCTION(BlueprintCallable)
+	void WarmUp();
+
+	// Latest CPU copy of the surface, set RenderConfig.bReadbackSurface to have one. Safe to call from any thread.
+	FOceanSnapshotRef GetSurfaceSnapshot() const;
+
+	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+
+	// Every section of the grid renders with the single material slot of the ocean
+	virtual int32 GetNumMaterials() const override;
+	virtual UMaterialInterface* GetMaterial(int32 ElementIndex) const override;
+
 	virtual void OnRegister() override;
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
 protected:
 
-	TUniquePtr<FFFTOceanRenderer> OceanRenderer;
+	virtual void RegisterComponentTickFunctions(bool bRegister) override;
+
+	FOceanSimulationDriver SimulationDriver;
+
+	// Bounds padding, only grown or shrunk when MaxDisplacement moves out of its hysteresis range
+	FVector DisplacementPadding;
+
+private:
+
+	// Geometry properties the current mesh sections were built with
+	int32 BuiltVertexCountX;
+	int32 BuiltVertexCountY;
+	float BuiltCellWidthX;
+	float BuiltCellWidthY;
+	bool  bBuiltCpuDisplacement;
+	bool  bBuiltCollision;
+
+	// Scratch buffers reused across rebuilds to avoid reallocating on every property tweak
+	TArray<FVector>   SectionVertices;
+	TArray<FVector>   SectionNormals;
+	TArray<FVector2D> SectionUVs;
+
+	bool IsOceanGeometryOutdated() const;
+
+	// Mesh section vertices and normals of the CPU displacement, the tick fills one set while the game thread uploads
+	// the other. A set is ready once filled, a newer ready set replaces it before its upload starts.
+	TArray<TArray<FVector>> CpuSectionVertices[2];
+	TArray<TArray<FVector>> CpuSectionNormals[2];
+	int32                   ReadyCpuBufferIndex;
+	int32                   UploadingCpuBufferIndex;
+	FCriticalSection        CpuBufferLock;
+
+	// Geometry and settings of the CPU displacement for the tick, copied on the game thread ahead of it
+	struct FCpuDisplacementTickProperties
+	{
+		FOceanCpuDisplacementSettings Settings;
+		bool                          bEnabled;
+		int32                         VertexCountX;
+		int32                         VertexCountY;
+		float                         CellWidthX;
+		float                         CellWidthY;
+
+		FCpuDisplacementTickProperties() :
+			bEnabled(false),
+			VertexCountX(0),
+			VertexCountY(0),
+			CellWidthX(0),
+			CellWidthY(0)
+		{
+		}
+	};
+
+	FCpuDisplacementTickProperties CpuTickProperties;
+	bool                           bCpuGeometryRebuilt;
+
+	// Whole grid scratch of the tick, normals need the neighbours across section borders
+	TArray<FVector> CpuGridVertices;
+	TArray<FVector> CpuGridNormals;
+	float           CpuDisplacementTime;
+
+	// Platform time of the last collision cook of the displaced sections, game thread only
+	double LastCollisionUpdateTime;
+
+	void CopyCpuTickProperties();
+	void UpdateCpuDisplacement();
+	void DisplaceGrid(const class FOceanSurfaceSnapshot& Snapshot);
+	void UploadCpuDisplacement();
 };